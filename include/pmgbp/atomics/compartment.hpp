@@ -0,0 +1,604 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_MODEL_COMPARTMENT_HPP
+#define PMGBP_PDEVS_MODEL_COMPARTMENT_HPP
+
+#include <cstddef>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <array>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility> // pair
+#include <stdexcept>
+#include <algorithm> // min
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <pmgbp/lib/Logger.hpp>
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
+#include <pmgbp/lib/TupleOperators.hpp>
+
+#include <pmgbp/structures/types.hpp>
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/atomics/enzyme.hpp>
+#include <pmgbp/atomics/enzyme_set.hpp>
+#include <pmgbp/atomics/space.hpp>
+
+namespace pmgbp {
+namespace models {
+
+using namespace std;
+using namespace cadmium;
+
+/**
+ * @brief Ports of a compartment kernel.
+ * @details The kernel routes its messages at runtime, thus it has a single port for each
+ * message type whatever the size of the model. The messages are Routed to a compartment,
+ * by its position in the spaces section, and the reactants to one of its enzyme sets. A
+ * kernel ignores the messages routed to other compartments, as the coupled models send all
+ * the outputs of a kernel to every kernel linked to it.
+ */
+struct compartment_ports {
+
+    struct in_reactant: public cadmium::in_port<pmgbp::types::Routed<pmgbp::types::Reactant>>{};
+    struct in_product: public cadmium::in_port<pmgbp::types::Routed<pmgbp::types::Product>>{};
+    struct in_information: public cadmium::in_port<pmgbp::types::Routed<pmgbp::types::Information>>{};
+
+    struct out_reactant: public cadmium::out_port<pmgbp::types::Routed<pmgbp::types::Reactant>>{};
+    struct out_product: public cadmium::out_port<pmgbp::types::Routed<pmgbp::types::Product>>{};
+    struct out_information: public cadmium::out_port<pmgbp::types::Routed<pmgbp::types::Information>>{};
+
+    using input_ports=std::tuple<in_reactant, in_product, in_information>;
+    using output_ports=std::tuple<out_reactant, out_product, out_information>;
+};
+
+/**
+ * @brief Ports of the space of a compartment kernel, its reactants leave through the single
+ * out_routed port and the kernel routes them by their routing table port.
+ */
+struct compartment_space_ports {
+
+    struct in_0_product: public cadmium::in_port<pmgbp::types::Product>{};
+    struct in_0_information: public cadmium::in_port<pmgbp::types::Information>{};
+    struct out_routed: public cadmium::out_port<pmgbp::types::Routed<pmgbp::types::Reactant>>{};
+
+    using reactant_type=pmgbp::types::Reactant;
+    using product_type=pmgbp::types::Product;
+    using information_type=pmgbp::types::Information;
+
+    using input_ports=std::tuple<in_0_product, in_0_information>;
+    using output_ports=std::tuple<out_routed>;
+};
+
+/**
+ * @brief A space and all the enzyme sets of its compartment fused in a single atomic model.
+ * @details The sub models are the space (index 0) and the enzyme sets (index i + 1). The
+ * messages between them are delivered directly to the receiver state in the same transition,
+ * without going through the coupled models, and only the messages for other compartments
+ * leave the kernel. The sub models are scheduled by their next internal time and receive
+ * the same transitions they receive in the coupled model, thus the trajectories are the same.
+ * When a sub model receives messages from other compartments and from its own compartment
+ * at the same time, the messages from other compartments are first in the bag.
+ */
+template<class TIME>
+class compartment {
+public:
+
+    using space_model=space<compartment_space_ports, TIME>;
+    using enzyme_set_model=enzyme_set<TIME>;
+
+    using input_ports=typename compartment_ports::input_ports;
+    using output_ports=typename compartment_ports::output_ports;
+
+    using output_bags=typename make_message_bags<output_ports>::type;
+    using input_bags=typename make_message_bags<input_ports>::type;
+
+    static constexpr std::size_t SPACE = 0;
+    static constexpr int TO_SPACE = -1; // enzyme set output for the compartment space
+    static constexpr int DROPPED = -2; // enzyme set output not connected to any space
+
+    struct state_type {
+        std::string id;
+        int index = -1; // position of the compartment in the spaces section
+        TIME current_time;
+        space_model space;
+        std::vector<enzyme_set_model> enzyme_sets;
+        std::vector<TIME> last_times; // time of the last transition of each sub model
+        std::vector<TIME> next_times; // time of the next internal transition of each sub model
+        std::set<std::pair<TIME, std::size_t>> schedule; // (next time, sub model index) of the active sub models
+        std::vector<std::pair<int, int>> space_routes; // space port -> compartment and enzyme set position, compartment -1 if not connected
+        std::vector<std::array<int, 3>> enzyme_set_routes; // enzyme set port -> compartment index, TO_SPACE or DROPPED
+        ChangeTracker<std::size_t> changed; // sub models with a transition in the last step, the deltas only log those
+    };
+
+    state_type state;
+
+    /********** Constructors **************/
+
+    compartment() = default;
+
+    /**
+     * @brief Parser constructor
+     * @details Constructs the space of the compartment cid and all the enzyme sets located in
+     * it, using the parameters of the xml file in the path xml_file.
+     *
+     * @param xml_file path where the xml file containing all the parameters is located.
+     * @param cid compartment id.
+     */
+    explicit compartment(const char* xml_file, const char* cid) : compartment(xml_file, cid, pmgbp::structs::layout::model_layout(ParameterStore::get(xml_file))) {}
+
+    compartment(const char* xml_file, const char* cid, const pmgbp::structs::layout::model_layout& layout) {
+        this->state.id = cid;
+        this->logger.setModuleName("Compartment_" + this->state.id);
+        PMGBP_LOG_INFO(this->logger, "Loading from XML");
+
+        std::vector<pmgbp::structs::layout::model_layout::enzyme_set_key> enzyme_sets = layout.compartment_enzyme_sets(cid);
+
+        this->state.index = layout.compartment_index(cid);
+        this->state.current_time = TIME::zero();
+        this->state.space = space_model(xml_file, cid);
+
+        for (const auto& link : layout.space_links) {
+            if (std::get<0>(link) != this->state.id) continue;
+
+            const std::string& destination = std::get<2>(link).first;
+            int compartment = layout.compartment_index(destination);
+            if (compartment < 0 || std::get<1>(link) < 0) continue;
+
+            std::vector<pmgbp::structs::layout::model_layout::enzyme_set_key> destination_sets = layout.compartment_enzyme_sets(destination);
+            int position = std::find(destination_sets.begin(), destination_sets.end(), std::get<2>(link)) - destination_sets.begin();
+
+            std::size_t port = std::get<1>(link);
+            if (port >= this->state.space_routes.size()) {
+                this->state.space_routes.resize(port + 1, {-1, -1});
+            }
+            this->state.space_routes[port] = {compartment, position};
+        }
+
+        this->state.enzyme_sets.reserve(enzyme_sets.size());
+        for (const auto& enzyme_set : enzyme_sets) {
+            this->state.enzyme_sets.emplace_back(xml_file, cid, enzyme_set.second.c_str(), layout.enzyme_sets.at(enzyme_set));
+
+            std::array<int, 3> routes;
+            routes.fill(DROPPED);
+            auto links = layout.enzyme_set_links.find(enzyme_set);
+            if (links != layout.enzyme_set_links.end()) {
+                for (const auto& link : links->second) {
+                    if (link.first < 0 || link.first >= int(routes.size())) {
+                        throw std::invalid_argument("The enzyme set " + enzyme_set.first + "_" + enzyme_set.second
+                                                    + " uses the output port " + std::to_string(link.first)
+                                                    + ", enzymes have only 3 output ports");
+                    }
+                    int compartment = layout.compartment_index(link.second);
+                    if (link.second == this->state.id) {
+                        routes[link.first] = TO_SPACE;
+                    } else if (compartment >= 0) {
+                        routes[link.first] = compartment;
+                    }
+                }
+            }
+            this->state.enzyme_set_routes.push_back(routes);
+        }
+
+        this->state.last_times.assign(this->state.enzyme_sets.size() + 1, TIME::zero());
+        this->state.next_times.assign(this->state.enzyme_sets.size() + 1, TIME::infinity());
+        for (std::size_t index = 0; index <= this->state.enzyme_sets.size(); ++index) {
+            this->reschedule(index);
+        }
+    }
+
+    /********** P-DEVS functions **************/
+
+    void internal_transition() {
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
+
+        this->state.changed.begin();
+        this->state.current_time = this->state.schedule.begin()->first;
+
+        std::vector<std::size_t> imminents = this->imminents();
+        local_inputs inputs;
+        for (std::size_t index : imminents) {
+            this->route_output(index, &inputs, nullptr);
+        }
+        this->transition(imminents, inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
+    }
+
+    void external_transition(TIME e, input_bags mbs) {
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
+
+        this->state.changed.begin();
+        this->state.current_time += e;
+
+        local_inputs inputs;
+        this->route_input(mbs, inputs);
+        this->transition({}, inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
+    }
+
+    void confluence_transition(TIME e, input_bags mbs) {
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
+
+        this->state.changed.begin();
+        this->state.current_time += e;
+
+        std::vector<std::size_t> imminents = this->imminents();
+        local_inputs inputs;
+        this->route_input(mbs, inputs);
+        for (std::size_t index : imminents) {
+            this->route_output(index, &inputs, nullptr);
+        }
+        this->transition(imminents, inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
+    }
+
+    output_bags output() const {
+        PMGBP_LOG_INFO(this->logger, "Begin output");
+
+        output_bags bags;
+        for (std::size_t index : this->imminents()) {
+            this->route_output(index, nullptr, &bags);
+        }
+
+        PMGBP_LOG_INFO(this->logger, "End output");
+        return bags;
+    }
+
+    TIME time_advance() const {
+        if (this->state.schedule.empty()) {
+            return TIME::infinity();
+        }
+        return this->state.schedule.begin()->first - this->state.current_time;
+    }
+
+    /**
+     * @brief Writes or reads the dynamic state of the space and the enzyme sets of the
+     * compartment, it is read over a compartment built from the same parameters.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->state.current_time;
+        this->state.space.serialize(archive);
+        pmgbp::serialization::expect_size(archive, this->state.enzyme_sets.size());
+        for (enzyme_set_model& enzyme_set : this->state.enzyme_sets) {
+            enzyme_set.serialize(archive);
+        }
+        archive & this->state.last_times & this->state.next_times & this->state.schedule & this->state.changed;
+    }
+
+    /**
+     * @brief Amount of sub models, the space has the index 0 and the enzyme set i the index i + 1.
+     */
+    std::size_t sub_models() const {
+        return this->state.enzyme_sets.size() + 1;
+    }
+
+    /**
+     * @brief Writes or reads the dynamic state of the sub model index with its last and next
+     * times, reading it reschedules the sub model. All the sub models and serialize_clock
+     * together hold the same state as serialize.
+     */
+    template<class ARCHIVE>
+    void serialize_sub_model(std::size_t index, ARCHIVE& archive) {
+        if (ARCHIVE::loading) {
+            this->state.schedule.erase({this->state.next_times[index], index});
+        }
+        if (index == SPACE) {
+            this->state.space.serialize(archive);
+        } else {
+            this->state.enzyme_sets[index - 1].serialize(archive);
+        }
+        archive & this->state.last_times[index] & this->state.next_times[index];
+        if (ARCHIVE::loading && !(this->state.next_times[index] == TIME::infinity())) {
+            this->state.schedule.insert({this->state.next_times[index], index});
+        }
+    }
+
+    /**
+     * @brief Writes or reads the part of the state that is not in the sub models, the time
+     * of the compartment and its changed sub models.
+     */
+    template<class ARCHIVE>
+    void serialize_clock(ARCHIVE& archive) {
+        archive & this->state.current_time & this->state.changed;
+    }
+
+    /**
+     * @brief Appends to indexes the sub models with a transition at the current time, the
+     * only ones the last transition can have changed.
+     */
+    void stepped(std::vector<std::size_t>& indexes) const {
+        for (std::size_t index = 0; index < this->state.last_times.size(); ++index) {
+            if (this->state.last_times[index] == this->state.current_time) {
+                indexes.push_back(index);
+            }
+        }
+    }
+
+    /**
+     * @brief Minimum time between a message arriving to the compartment and any message the
+     * compartment sends to other compartments because of it.
+     * @details The messages leave the compartment from the enzymes, after their rate or
+     * reject rate, and from the space, TIME_TO_SEND_FOR_REACTION after each selection.
+     */
+    TIME lookahead() const {
+        TIME result = TIME_TO_SEND_FOR_REACTION;
+        for (const enzyme_set_model& enzyme_set : this->state.enzyme_sets) {
+            for (const auto& enzyme : enzyme_set.state.enzymes) {
+                result = std::min(result, std::min(enzyme.props.rate, enzyme.props.reject_rate));
+            }
+        }
+        return result;
+    }
+
+    /*************** print state *********************/
+
+    friend std::ostringstream& operator<<(std::ostringstream& os, const typename compartment<TIME>::state_type& s) {
+        os << "{";
+        os << "\"model_class\":\"compartment\",";
+        os << "\"id\":\"" << s.id << "\",";
+
+        // The deltas only print the sub models with a transition, the keyframes print all the
+        // sub models in full
+        bool delta = !s.changed.keyframe();
+        if (delta) {
+            os << "\"delta\":true,";
+        }
+        os << "\"models\": [";
+
+        bool separate = false;
+        auto print = [&os, &s, &separate](std::size_t index) {
+            if (separate) {
+                os << ",";
+            }
+            separate = true;
+            if (index == SPACE) {
+                os << s.space.state;
+            } else {
+                os << s.enzyme_sets[index - 1].state;
+            }
+        };
+
+        if (delta) {
+            for (std::size_t index : s.changed.changed()) {
+                print(index);
+            }
+        } else {
+            StateDelta::Snapshot full;
+            for (std::size_t index = SPACE; index <= s.enzyme_sets.size(); ++index) {
+                print(index);
+            }
+        }
+
+        os << "]";
+        os << "}";
+
+        return os;
+    }
+
+private:
+
+    using space_input_bags=typename space_model::input_bags;
+    using space_output_bags=typename space_model::output_bags;
+    using enzyme_set_input_bags=typename enzyme_set_model::input_bags;
+    using enzyme_set_output_bags=typename enzyme_set_model::output_bags;
+    using space_ports=compartment_space_ports;
+
+    /**
+     * @brief Messages delivered to the sub models in a single step.
+     */
+    struct local_inputs {
+        bool to_space = false;
+        space_input_bags space;
+        std::map<std::size_t, enzyme_set_input_bags> enzyme_sets; // sub model index -> inputs
+    };
+
+    Logger logger;
+
+    /**
+     * @brief Indexes of the sub models with the next internal transition.
+     */
+    std::vector<std::size_t> imminents() const {
+        std::vector<std::size_t> result;
+        if (this->state.schedule.empty()) {
+            return result;
+        }
+
+        const TIME& next_time = this->state.schedule.begin()->first;
+        for (auto it = this->state.schedule.begin(); it != this->state.schedule.end() && it->first == next_time; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Applies the transitions of the imminent sub models and the sub models with inputs.
+     */
+    void transition(const std::vector<std::size_t>& imminents, local_inputs& inputs) {
+
+        for (std::size_t index : imminents) {
+            TIME elapsed = this->state.current_time - this->state.last_times[index];
+
+            if (index == SPACE) {
+                if (inputs.to_space) {
+                    this->state.space.confluence_transition(elapsed, inputs.space);
+                    inputs.to_space = false;
+                } else {
+                    this->state.space.internal_transition();
+                }
+            } else {
+                auto enzyme_set_inputs = inputs.enzyme_sets.find(index);
+                if (enzyme_set_inputs == inputs.enzyme_sets.end()) {
+                    this->state.enzyme_sets[index - 1].internal_transition();
+                } else {
+                    this->state.enzyme_sets[index - 1].confluence_transition(elapsed, enzyme_set_inputs->second);
+                    inputs.enzyme_sets.erase(enzyme_set_inputs);
+                }
+            }
+            this->reschedule(index);
+        }
+
+        if (inputs.to_space) {
+            this->state.space.external_transition(this->state.current_time - this->state.last_times[SPACE], inputs.space);
+            this->reschedule(SPACE);
+        }
+
+        for (auto& enzyme_set_inputs : inputs.enzyme_sets) {
+            std::size_t index = enzyme_set_inputs.first;
+            TIME elapsed = this->state.current_time - this->state.last_times[index];
+            this->state.enzyme_sets[index - 1].external_transition(elapsed, enzyme_set_inputs.second);
+            this->reschedule(index);
+        }
+    }
+
+    /**
+     * @brief Splits the kernel inputs routed to this compartment between the space and the
+     * enzyme sets.
+     */
+    void route_input(const input_bags& mbs, local_inputs& inputs) const {
+        for (const auto& routed : get_messages<typename compartment_ports::in_product>(mbs)) {
+            if (routed.to != this->state.index) continue;
+
+            inputs.to_space = true;
+            get_messages<typename space_ports::in_0_product>(inputs.space).push_back(routed.message);
+        }
+        for (const auto& routed : get_messages<typename compartment_ports::in_information>(mbs)) {
+            if (routed.to != this->state.index) continue;
+
+            inputs.to_space = true;
+            get_messages<typename space_ports::in_0_information>(inputs.space).push_back(routed.message);
+        }
+
+        for (const auto& routed : get_messages<typename compartment_ports::in_reactant>(mbs)) {
+            if (routed.to != this->state.index) continue;
+
+            get_messages<typename enzyme_ports::in_0>(inputs.enzyme_sets[routed.enzyme_set + 1]).push_back(routed.message);
+        }
+    }
+
+    /**
+     * @brief Sends the output of a sub model to the sub models of the compartment (local) and
+     * to the other compartments (remote), any of them can be null to skip them.
+     */
+    void route_output(std::size_t index, local_inputs* local, output_bags* remote) const {
+        if (index == SPACE) {
+            this->route_space_output(this->state.space.output(), local, remote);
+        } else {
+            this->route_enzyme_set_output(index, this->state.enzyme_sets[index - 1].output(), local, remote);
+        }
+    }
+
+    void route_space_output(const space_output_bags& bags, local_inputs* local, output_bags* remote) const {
+        for (const auto& routed : get_messages<typename space_ports::out_routed>(bags)) {
+            if (routed.to < 0 || routed.to >= int(this->state.space_routes.size())) continue;
+
+            const std::pair<int, int>& route = this->state.space_routes[routed.to];
+            if (route.first == this->state.index && local != nullptr) {
+                get_messages<typename enzyme_ports::in_0>(local->enzyme_sets[route.second + 1]).push_back(routed.message);
+            } else if (route.first >= 0 && route.first != this->state.index && remote != nullptr) {
+                get_messages<typename compartment_ports::out_reactant>(*remote).push_back({route.first, route.second, routed.message});
+            }
+        }
+    }
+
+    void route_enzyme_set_output(std::size_t index, const enzyme_set_output_bags& bags, local_inputs* local, output_bags* remote) const {
+        const std::array<int, 3>& routes = this->state.enzyme_set_routes[index - 1];
+
+        for (std::size_t port = 0; port < routes.size(); ++port) {
+            const auto& products = enzyme_set_products(bags, port);
+            const auto& information = enzyme_set_information(bags, port);
+            if (products.empty() && information.empty()) continue;
+
+            if (routes[port] == TO_SPACE && local != nullptr) {
+                local->to_space = true;
+                append(get_messages<typename space_ports::in_0_product>(local->space), products);
+                append(get_messages<typename space_ports::in_0_information>(local->space), information);
+            } else if (routes[port] >= 0 && remote != nullptr) {
+                for (const pmgbp::types::Product& product : products) {
+                    get_messages<typename compartment_ports::out_product>(*remote).push_back({routes[port], -1, product});
+                }
+                for (const pmgbp::types::Information& released : information) {
+                    get_messages<typename compartment_ports::out_information>(*remote).push_back({routes[port], -1, released});
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Updates the sub model last and next times after one of its transitions.
+     */
+    void reschedule(std::size_t index) {
+        this->state.schedule.erase({this->state.next_times[index], index});
+
+        this->state.last_times[index] = this->state.current_time;
+        TIME time_advance = index == SPACE ? this->state.space.time_advance() : this->state.enzyme_sets[index - 1].time_advance();
+        if (time_advance == TIME::infinity()) {
+            this->state.next_times[index] = TIME::infinity();
+        } else {
+            this->state.next_times[index] = this->state.current_time + time_advance;
+            this->state.schedule.insert({this->state.next_times[index], index});
+        }
+
+        this->state.changed.touch(index);
+    }
+
+    template<class T>
+    static void append(cadmium::bag<T>& to, const cadmium::bag<T>& from) {
+        to.insert(to.end(), from.begin(), from.end());
+    }
+
+    static const cadmium::bag<pmgbp::types::Product>& enzyme_set_products(const enzyme_set_output_bags& bags, std::size_t port) {
+        switch (port) {
+        case 0: return get_messages<typename enzyme_ports::out_0_product>(bags);
+        case 1: return get_messages<typename enzyme_ports::out_1_product>(bags);
+        default: return get_messages<typename enzyme_ports::out_2_product>(bags);
+        }
+    }
+
+    static const cadmium::bag<pmgbp::types::Information>& enzyme_set_information(const enzyme_set_output_bags& bags, std::size_t port) {
+        switch (port) {
+        case 0: return get_messages<typename enzyme_ports::out_0_information>(bags);
+        case 1: return get_messages<typename enzyme_ports::out_1_information>(bags);
+        default: return get_messages<typename enzyme_ports::out_2_information>(bags);
+        }
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_MODEL_COMPARTMENT_HPP
@@ -44,7 +44,10 @@
 #include <cadmium/modeling/message_bag.hpp>
 
 #include <pmgbp/lib/Logger.hpp>
-#include <pmgbp/lib/Random.hpp> // RealRandom
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Random.hpp> // IntegerRandom
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
 #include <pmgbp/lib/TaskScheduler.hpp>
 #include <pmgbp/lib/TupleOperators.hpp>
 
@@ -93,11 +96,11 @@ template<class TIME>
 class enzyme {
 public:
 
-    using rid=std::string;
-    using cid=std::string;
-    using sid=std::string;
+    using rid=symbols::rid;
+    using cid=symbols::cid;
+    using sid=symbols::sid;
 
-    using rejected_type=map<pair<string, Way>, map<rid, Integer>>;
+    using rejected_type=map<pair<cid, Way>, map<rid, Integer>>;
 
     using Product=typename enzyme_ports::product_type;
     using Information=typename enzyme_ports::information_type;
@@ -115,8 +118,8 @@ public:
         TIME reject_rate;
         double koff_STP;
         double koff_PTS;
-        map<rid, MetaboliteAmounts> substrate_sctry; // the stoichiometry is separated by compartments
-        map<rid, MetaboliteAmounts> products_sctry; // the stoichiometry is separated by compartments
+        map<cid, MetaboliteAmounts> substrate_sctry; // the stoichiometry is separated by compartments
+        map<cid, MetaboliteAmounts> products_sctry; // the stoichiometry is separated by compartments
 
         reaction_props_type() = default;
 
@@ -144,11 +147,12 @@ public:
      */
     struct props_type {
         std::string id;
+        symbols::eid enzyme_id;
         pmgbp::structs::space::EnzymeAddress location;
         TIME reject_rate; // Temporal hotFix to fast test with the same reject_rate for all the reactions
         TIME rate; // Temporal hotFix to fast test with the same rate for all the reactions
         std::map<rid, reaction_props_type> reactions;
-        RoutingTable<string> routing_table;
+        DenseRoutingTable<sid> routing_table;
     };
 
     struct reaction_state_type {
@@ -159,6 +163,11 @@ public:
             this->substrate_comps.clear();
             this->product_comps.clear();
         }
+
+        template<class ARCHIVE>
+        void serialize(ARCHIVE& archive) {
+            archive & this->substrate_comps & this->product_comps;
+        }
     };
 
     /**
@@ -176,6 +185,7 @@ public:
         std::string id; // only te print then enzyme ID
         std::map<rid, reaction_state_type> reactions;
         TaskScheduler<TIME, output_bags> tasks;
+        ChangeTracker<TIME> changed_tasks; // times of the tasks added by the last transition
     };
 
     state_type state;
@@ -203,8 +213,8 @@ public:
 
     /**
      * @brief Parser constructor
-     * @details Construct a new reaction atomic model instance by opening and parsing the xml
-     * file in the path xml_file.
+     * @details Construct a new enzyme atomic model instance using the parameters of the xml
+     * file in the path xml_file. The file is parsed only once and shared by all the models.
      *
      * @param xml_file path where the xml file containing all the parameters is located.
      * @param id model id.
@@ -212,6 +222,7 @@ public:
     explicit enzyme(const char* xml_file, const char* id, pmgbp::structs::space::EnzymeAddress location) {
         // Set enzyme id
         this->props.id = id;
+        this->props.enzyme_id = symbols::enzymes().intern(this->props.id);
         this->props.location = location;
         this->state.id = id;
 
@@ -219,55 +230,46 @@ public:
         std::ostringstream oss;
         oss << "Enzyme_" << this->props.id << ":" << this->props.location;
         this->logger.setModuleName(oss.str());
-        logger.info("Loading from XML");
+        PMGBP_LOG_INFO(this->logger, "Loading from XML");
 
         // Initialize random generators
         this->initialize_random_engines();
 
-        tinyxml2::XMLDocument doc;
-        tinyxml2::XMLError opened = doc.LoadFile(xml_file);
-        assert(opened == tinyxml2::XML_SUCCESS);
-
-        // document root element
-        tinyxml2::XMLElement* root = doc.RootElement();
+        const ParameterStore& parameters = ParameterStore::get(xml_file);
 
         // Search the enzyme information
-        tinyxml2::XMLElement* enzyme = root->FirstChildElement("spaces")
-                ->FirstChildElement(this->props.location.compartment.c_str())
-                ->FirstChildElement("enzymes")
-                ->FirstChildElement(id);
-
-        while (enzyme->FirstChildElement("address")->Attribute("esn") != this->props.location.reaction_set) {
-            enzyme = enzyme->NextSiblingElement();
-        }
+        const tinyxml2::XMLElement* enzyme = parameters.space_enzyme(this->props.location.compartment_name(),
+                                                                     id,
+                                                                     this->props.location.reaction_set_name());
 
         // Load reactions information
-        tinyxml2::XMLElement* enzyme_reactions = enzyme->FirstChildElement("reactions");
-        for (tinyxml2::XMLElement* enzyme_reaction = enzyme_reactions->FirstChildElement("reaction"); enzyme_reaction != nullptr; enzyme_reaction = enzyme_reaction->NextSiblingElement()) {
+        const tinyxml2::XMLElement* enzyme_reactions = enzyme->FirstChildElement("reactions");
+        for (const tinyxml2::XMLElement* enzyme_reaction = enzyme_reactions->FirstChildElement("reaction"); enzyme_reaction != nullptr; enzyme_reaction = enzyme_reaction->NextSiblingElement()) {
             const char* reaction_id = enzyme_reaction->Attribute("id");
-            tinyxml2::XMLElement* reaction = root
-                    ->FirstChildElement("reactions")
-                    ->FirstChildElement(reaction_id);
-            this->load_reaction_props_and_state(reaction, reaction_id);
+            this->load_reaction_props_and_state(parameters.reaction(reaction_id), symbols::reactions().intern(reaction_id));
         }
     }
 
     /************** PDEVS methods ********************/
 
     void internal_transition() {
-        this->logger.info("Begin internal_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
+        this->state.changed_tasks.begin();
         this->state.tasks.advance();
-        this->logger.info("End internal_transition");
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
     }
 
     void external_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin external_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
 
-        std::ostringstream oss;
-        oss << "External: ";
-        pmgbp::tuple::print(oss, mbs);
-        this->logger.debug(oss.str());
+        if (Logger::enabled(Logger::Level::DEBUG)) {
+            std::ostringstream oss;
+            oss << "External: ";
+            pmgbp::tuple::print(oss, mbs);
+            this->logger.debug(oss.str());
+        }
 
+        this->state.changed_tasks.begin();
         this->state.tasks.update(e);
 
         // Inserting new accepted metabolites
@@ -279,60 +281,83 @@ public:
         sendBackRejected(rejected, rejected_metabolites);
         //TODO: reject_rate should be different for each reaction
         this->state.tasks.add(this->props.reject_rate, rejected_metabolites);
+        this->state.changed_tasks.touch(this->state.tasks.now() + this->props.reject_rate);
 
         // looking for new reactions
         output_bags products;
         this->lookForNewReactions(products);
         //TODO: rate should be different for each reaction
         this->state.tasks.add(this->props.rate, products);
-        this->logger.info("End external_transition");
+        this->state.changed_tasks.touch(this->state.tasks.now() + this->props.rate);
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
     }
 
     void confluence_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
         internal_transition();
+        this->state.changed_tasks.keep();
         external_transition(TIME::zero(), mbs);
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
     }
 
     output_bags output() const {
-        this->logger.info("Begin output");
+        PMGBP_LOG_INFO(this->logger, "Begin output");
 
         output_bags bags;
 
-        list<output_bags> outputs = this->state.tasks.next();
+        const list<output_bags>& outputs = this->state.tasks.next();
         for (const auto &current_bags: outputs) {
             pmgbp::tuple::merge(bags, current_bags);
         }
 
-        std::ostringstream oss;
-        oss << "Output: ";
-        pmgbp::tuple::print(oss, bags);
-        this->logger.debug(oss.str());
+        if (Logger::enabled(Logger::Level::DEBUG)) {
+            std::ostringstream oss;
+            oss << "Output: ";
+            pmgbp::tuple::print(oss, bags);
+            this->logger.debug(oss.str());
+        }
 
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
         return bags;
     }
 
     TIME time_advance() const {
-        this->logger.info("Begin time_advance");
+        PMGBP_LOG_INFO(this->logger, "Begin time_advance");
 
         TIME result = this->state.tasks.time_advance();
 
-        this->logger.info("End time_advance");
+        PMGBP_LOG_INFO(this->logger, "End time_advance");
         return result;
     }
 
+    /**
+     * @brief Writes or reads the dynamic state of the enzyme, it is read over an enzyme built
+     * from the same parameters.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->state.reactions & this->state.tasks & this->state.changed_tasks & this->integer_random;
+    }
+
     /*************** print state *********************/
 
     friend std::ostringstream& operator<<(std::ostringstream& os, const typename enzyme<TIME>::state_type& s) {
         os << "{";
         os << "\"model_class\":\"enzyme\",";
         os << "\"id\":\"" << s.id << "\",";
+
+        // The deltas only print the tasks with elements added by the last transition
+        bool delta = !s.changed_tasks.keyframe();
+        if (delta) {
+            os << "\"delta\":true,";
+        }
         os << "\"reactions_in_progress\": [";
 
         bool separate = false;
         for (const auto& task : s.tasks.queue()) {
+            if (delta && s.changed_tasks.changed().count(s.tasks.now() + task.time_left) == 0) {
+                continue;
+            }
             if (separate) {
                 os << ",";
             }
@@ -354,7 +379,7 @@ private:
 
     /*********** Private attributes **********/
 
-    RealRandom<double> real_random; // used for uniform random number generation
+    IntegerRandom<Integer> integer_random; // used for binomial random numbers generation
     Logger logger;
 
     /*********** Private attributes **********/
@@ -363,7 +388,7 @@ private:
     ********* helper functions *************
     ***************************************/
 
-    void load_reaction_props_and_state(tinyxml2::XMLElement *reaction, rid reaction_id) {
+    void load_reaction_props_and_state(const tinyxml2::XMLElement* reaction, rid reaction_id) {
 
         reaction_props_type new_reaction_props(
                 TIME(reaction->FirstChildElement("rate")->GetText()),
@@ -384,17 +409,17 @@ private:
         sid specie_id;
         Integer specie_amount;
 
-        tinyxml2::XMLElement* compartments = reaction->FirstChildElement("stoichiometryByCompartments");
-        for (tinyxml2::XMLElement* compartment_sctry = compartments->FirstChildElement("compartmentStoichiometry"); compartment_sctry != nullptr; compartment_sctry = compartment_sctry->NextSiblingElement()) {
+        const tinyxml2::XMLElement* compartments = reaction->FirstChildElement("stoichiometryByCompartments");
+        for (const tinyxml2::XMLElement* compartment_sctry = compartments->FirstChildElement("compartmentStoichiometry"); compartment_sctry != nullptr; compartment_sctry = compartment_sctry->NextSiblingElement()) {
 
-            compartment_id = compartment_sctry->Attribute("cid");
+            compartment_id = symbols::compartments().intern(compartment_sctry->Attribute("cid"));
 
             // Load substrate stoichiometry
             substrate_sctry.clear();
-            tinyxml2::XMLElement* substrate = compartment_sctry->FirstChildElement("substrate");
+            const tinyxml2::XMLElement* substrate = compartment_sctry->FirstChildElement("substrate");
             if (substrate != nullptr) {
-                for (tinyxml2::XMLElement* specie = substrate->FirstChildElement(); specie != nullptr; specie = specie->NextSiblingElement()) {
-                    specie_id = specie->Attribute("id");
+                for (const tinyxml2::XMLElement* specie = substrate->FirstChildElement(); specie != nullptr; specie = specie->NextSiblingElement()) {
+                    specie_id = symbols::species().intern(specie->Attribute("id"));
                     specie_amount = Integer(std::stoi(specie->Attribute("amount")));
                     substrate_sctry.insert({specie_id, specie_amount});
                 }
@@ -407,10 +432,10 @@ private:
 
             // Load product stoichiometry
             products_sctry.clear();
-            tinyxml2::XMLElement* product = compartment_sctry->FirstChildElement("product");
+            const tinyxml2::XMLElement* product = compartment_sctry->FirstChildElement("product");
             if (product != nullptr) {
-                for (tinyxml2::XMLElement* specie = product->FirstChildElement(); specie != nullptr; specie = specie->NextSiblingElement()) {
-                    specie_id = specie->Attribute("id");
+                for (const tinyxml2::XMLElement* specie = product->FirstChildElement(); specie != nullptr; specie = specie->NextSiblingElement()) {
+                    specie_id = symbols::species().intern(specie->Attribute("id"));
                     specie_amount = Integer(std::stoi(specie->Attribute("amount")));
                     products_sctry.insert({specie_id, specie_amount});
                 }
@@ -427,14 +452,15 @@ private:
         this->state.reactions.insert({reaction_id, new_reaction_state});
 
         // Add reaction metabolite addresses to the routing_table
-        for (tinyxml2::XMLElement* entry = reaction->FirstChildElement("routingTable")->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
-            if (this->props.routing_table.at(entry->Attribute("metaboliteId")) >= 0) {
+        for (const tinyxml2::XMLElement* entry = reaction->FirstChildElement("routingTable")->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+            sid metabolite_id = symbols::species().intern(entry->Attribute("metaboliteId"));
+            if (this->props.routing_table.at(metabolite_id) >= 0) {
 
-                assert(this->props.routing_table.at(entry->Attribute("metaboliteId")) == std::stoi(entry->Attribute("port")));
+                assert(this->props.routing_table.at(metabolite_id) == std::stoi(entry->Attribute("port")));
             } else {
 
                 this->props.routing_table.insert(
-                        entry->Attribute("metaboliteId"),
+                        metabolite_id,
                         std::stoi(entry->Attribute("port"))
                 );
             }
@@ -443,12 +469,11 @@ private:
 
     void initialize_random_engines() {
 
-        // real_random is initialized with a random generator engine
-        random_device real_rd; // Random generator engine
-        this->real_random.seed(real_rd());
+        // The same enzyme has a model in each location, thus the location is part of the stream
+        this->integer_random.seed(RandomSeed::stream("Enzyme_" + this->state.id + ":" + this->props.location.str()));
     }
 
-    void push_metabolite_to_correct_port(string metabolite_id, output_bags &bags, const Product &m) const {
+    void push_metabolite_to_correct_port(sid metabolite_id, output_bags &bags, const Product &m) const {
         int port_number = this->props.routing_table.at(metabolite_id);
         switch (port_number) {
             case 0: std::get<0>(bags).messages.emplace_back(m); break;
@@ -459,7 +484,7 @@ private:
         }
     }
 
-    void push_information_to_correct_port(string metabolite_id, output_bags &bags, const Information &m) const {
+    void push_information_to_correct_port(sid metabolite_id, output_bags &bags, const Information &m) const {
         int port_number = this->props.routing_table.at(metabolite_id);
         switch (port_number) {
             case 0: std::get<3>(bags).messages.emplace_back(m); break;
@@ -478,41 +503,42 @@ private:
             const reaction_props_type& reaction_props = this->props.reactions.at(x.rid);
 
             if (x.reaction_direction == Way::STP) {
-
-                // TODO: this step could be replaced by a single step using uniform distribution to calculate the rejected and accepted amount
-                for (int i = 0; i < x.reaction_amount; ++i) {
-                    if (acceptedMetabolites(reaction_props.koff_STP)) reaction_state.substrate_comps.at(x.from) += 1;
-                    else increaseRejected(rejected, x.from, x.rid, Way::STP);
-                }
-
+                Integer accepted = this->acceptedMetabolites(x.reaction_amount, reaction_props.koff_STP);
+                reaction_state.substrate_comps.at(x.from) += accepted;
+                this->increaseRejected(rejected, x.from, x.rid, Way::STP, x.reaction_amount - accepted);
             } else {
-
-                // TODO: this step could be replaced by a single step using uniform distribution to calculate the rejected and accepted amount
-                for (int i = 0; i < x.reaction_amount; ++i) {
-                    if (acceptedMetabolites(reaction_props.koff_PTS)) reaction_state.product_comps.at(x.from) += 1;
-                    else increaseRejected(rejected, x.from, x.rid, Way::PTS);
-                }
+                Integer accepted = this->acceptedMetabolites(x.reaction_amount, reaction_props.koff_PTS);
+                reaction_state.product_comps.at(x.from) += accepted;
+                this->increaseRejected(rejected, x.from, x.rid, Way::PTS, x.reaction_amount - accepted);
             }
         }
     }
 
-    bool acceptedMetabolites(double k) {
-        return (this->real_random.drawNumber(0.0, 1.0) > k);
+    /**
+     * @brief Number of metabolites accepted out of amount, each one is rejected
+     * with probability k.
+     */
+    Integer acceptedMetabolites(Integer amount, double k) {
+        return this->integer_random.drawBinomial(amount, 1.0 - k);
     }
 
-    void increaseRejected(rejected_type& rejected, const string& compartment, const rid& reaction_id, Way direction) {
+    void increaseRejected(rejected_type& rejected, cid compartment, rid reaction_id, Way direction, Integer amount) {
+
+        if (amount == 0) {
+            return;
+        }
 
         // insert rejected information compartment and rejected reaction direction
-        pair<string, Way> key = make_pair(compartment, direction);
+        pair<cid, Way> key = make_pair(compartment, direction);
         if(rejected.find(key) != rejected.end()) {
             if (rejected.at(key).find(reaction_id) != rejected.at(key).end()) {
-                rejected.at(key).at(reaction_id) += 1;
+                rejected.at(key).at(reaction_id) += amount;
             } else {
-                rejected.at(key).insert({reaction_id, 1});
+                rejected.at(key).insert({reaction_id, amount});
             }
         } else {
             map<rid, Integer> rejected_by_reactions;
-            rejected_by_reactions.insert({reaction_id, 1});
+            rejected_by_reactions.insert({reaction_id, amount});
             rejected.insert({key, rejected_by_reactions});
         }
     }
@@ -527,7 +553,7 @@ private:
 
                 // Send the released enzymes
                 Information informationMessage;
-                informationMessage.enzyme_id = this->state.id;
+                informationMessage.enzyme_id = this->props.enzyme_id;
                 informationMessage.released_enzymes = jt.second;
                 informationMessage.location = this->props.location;
 
@@ -592,7 +618,7 @@ private:
 
                 // Send the released enzymes
                 Information informationMessage;
-                informationMessage.enzyme_id = this->state.id;
+                informationMessage.enzyme_id = this->props.enzyme_id;
                 informationMessage.released_enzymes = stp_ready;
                 informationMessage.location = this->props.location;
 
@@ -619,7 +645,7 @@ private:
 
                 // Send the released enzymes
                 Information informationMessage;
-                informationMessage.enzyme_id = this->state.id;
+                informationMessage.enzyme_id = this->props.enzyme_id;
                 informationMessage.released_enzymes = pts_ready;
                 informationMessage.location = this->props.location;
 
@@ -632,14 +658,14 @@ private:
         }
     }
 
-    void removeMetabolites(map<string, Integer>& comp, Integer a) {
+    void removeMetabolites(map<cid, Integer>& comp, Integer a) {
 
         for (auto &it : comp) {
             it.second -= a;
         }
     }
 
-    Integer totalReadyFor(const map<string, Integer>& comp) {
+    Integer totalReadyFor(const map<cid, Integer>& comp) {
 
         if (comp.empty()) {
             return 0;
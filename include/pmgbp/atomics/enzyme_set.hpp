@@ -0,0 +1,349 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_MODEL_ENZYME_SET_HPP
+#define PMGBP_PDEVS_MODEL_ENZYME_SET_HPP
+
+#include <cstddef>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility> // pair
+#include <algorithm> // binary_search
+
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <pmgbp/lib/Logger.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
+#include <pmgbp/lib/ThreadPool.hpp>
+#include <pmgbp/lib/TupleOperators.hpp>
+
+#include <pmgbp/structures/types.hpp> // DenseRoutingTable
+#include <pmgbp/structures/space.hpp> // EnzymeAddress
+#include <pmgbp/structures/symbols.hpp>
+
+#include <pmgbp/atomics/enzyme.hpp>
+
+namespace pmgbp {
+namespace models {
+
+using namespace std;
+using namespace cadmium;
+
+/**
+ * @brief All the enzymes of an enzyme set in a single atomic model.
+ * @details The enzymes are stored in a vector and each incoming reactant is routed to its
+ * enzyme through a table indexed by the enzyme id. The enzyme set has the same ports than
+ * an enzyme, so it replaces the router and enzyme groups coupled models without limits in
+ * the amount of enzymes. Each enzyme keeps its own time and they are scheduled by their next
+ * internal time, thus the set behaves as the coupled model of its enzymes.
+ */
+template<class TIME>
+class enzyme_set {
+public:
+
+    using enzyme_model=enzyme<TIME>;
+
+    using input_ports=typename enzyme_ports::input_ports;
+    using output_ports=typename enzyme_ports::output_ports;
+
+    using output_bags=typename make_message_bags<output_ports>::type;
+    using input_bags=typename make_message_bags<input_ports>::type;
+
+    struct state_type {
+        std::string id;
+        TIME current_time;
+        std::vector<enzyme_model> enzymes;
+        std::vector<TIME> last_times; // time of the last transition of each enzyme
+        std::vector<TIME> next_times; // time of the next internal transition of each enzyme
+        std::set<std::pair<TIME, std::size_t>> schedule; // (next time, enzyme index) of the active enzymes
+        pmgbp::types::DenseRoutingTable<symbols::eid> routing_table; // enzyme id -> enzyme index
+        ChangeTracker<std::size_t> changed; // enzymes with a transition in the last step, the deltas only log those
+    };
+
+    state_type state;
+
+    /********** Constructors **************/
+
+    enzyme_set() = default;
+
+    /**
+     * @brief Parser constructor
+     * @details Constructs one enzyme model for each enzyme id, using the parameters of the xml
+     * file in the path xml_file.
+     *
+     * @param xml_file path where the xml file containing all the parameters is located.
+     * @param cid compartment id of the enzyme set.
+     * @param esn enzyme set name, it is the location of the enzymes in the compartment.
+     * @param enzyme_ids the ids of the enzymes of the set.
+     */
+    explicit enzyme_set(const char* xml_file, const char* cid, const char* esn, std::vector<std::string> enzyme_ids) {
+        this->state.id = std::string(cid) + "_" + std::string(esn);
+        this->logger.setModuleName("Enzyme_set_" + this->state.id);
+        PMGBP_LOG_INFO(this->logger, "Loading from XML");
+
+        pmgbp::structs::space::EnzymeAddress location(cid, esn);
+
+        this->state.current_time = TIME::zero();
+        this->state.enzymes.reserve(enzyme_ids.size());
+        for (const std::string& enzyme_id : enzyme_ids) {
+            this->state.routing_table.insert(symbols::enzymes().intern(enzyme_id), this->state.enzymes.size());
+            this->state.enzymes.emplace_back(xml_file, enzyme_id.c_str(), location);
+        }
+
+        this->state.last_times.assign(this->state.enzymes.size(), TIME::zero());
+        this->state.next_times.assign(this->state.enzymes.size(), TIME::infinity());
+        for (std::size_t index = 0; index < this->state.enzymes.size(); ++index) {
+            this->reschedule(index);
+        }
+    }
+
+    /********** P-DEVS functions **************/
+
+    void internal_transition() {
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
+
+        this->state.changed.begin();
+        this->state.current_time = this->state.schedule.begin()->first;
+
+        std::map<std::size_t, input_bags> inputs;
+        this->transition(this->imminents(), inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
+    }
+
+    void external_transition(TIME e, input_bags mbs) {
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
+
+        this->state.changed.begin();
+        this->state.current_time += e;
+
+        std::map<std::size_t, input_bags> inputs = this->route(mbs);
+        this->transition({}, inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
+    }
+
+    void confluence_transition(TIME e, input_bags mbs) {
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
+
+        this->state.changed.begin();
+        this->state.current_time += e;
+
+        std::map<std::size_t, input_bags> inputs = this->route(mbs);
+        this->transition(this->imminents(), inputs);
+
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
+    }
+
+    output_bags output() const {
+        PMGBP_LOG_INFO(this->logger, "Begin output");
+
+        // Each enzyme writes its own bags and they are merged in the enzymes order
+        std::vector<std::size_t> imminents = this->imminents();
+        std::vector<output_bags> outputs(imminents.size());
+        ThreadPool::current().parallel_for(0, imminents.size(), [this, &imminents, &outputs](std::size_t i) {
+            outputs[i] = this->state.enzymes[imminents[i]].output();
+        }, PARALLEL_GRAIN);
+
+        output_bags bags;
+        for (const output_bags& enzyme_bags : outputs) {
+            pmgbp::tuple::merge(bags, enzyme_bags);
+        }
+
+        PMGBP_LOG_INFO(this->logger, "End output");
+        return bags;
+    }
+
+    TIME time_advance() const {
+        if (this->state.schedule.empty()) {
+            return TIME::infinity();
+        }
+        return this->state.schedule.begin()->first - this->state.current_time;
+    }
+
+    /**
+     * @brief Writes or reads the dynamic state of the enzyme set and its enzymes, it is read
+     * over an enzyme set built from the same parameters.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->state.current_time;
+        pmgbp::serialization::expect_size(archive, this->state.enzymes.size());
+        for (enzyme_model& enzyme : this->state.enzymes) {
+            enzyme.serialize(archive);
+        }
+        archive & this->state.last_times & this->state.next_times & this->state.schedule & this->state.changed;
+    }
+
+    /*************** print state *********************/
+
+    friend std::ostringstream& operator<<(std::ostringstream& os, const typename enzyme_set<TIME>::state_type& s) {
+        os << "{";
+        os << "\"model_class\":\"enzyme_set\",";
+        os << "\"id\":\"" << s.id << "\",";
+
+        // The deltas only print the enzymes with a transition, the keyframes print all the
+        // enzymes in full to let the deltas of the following transitions be decoded
+        bool delta = !s.changed.keyframe();
+        if (delta) {
+            os << "\"delta\":true,";
+        }
+        os << "\"enzymes\": [";
+
+        bool separate = false;
+        if (delta) {
+            for (std::size_t index : s.changed.changed()) {
+                if (separate) {
+                    os << ",";
+                }
+                separate = true;
+                os << s.enzymes[index].state;
+            }
+        } else {
+            StateDelta::Snapshot full;
+            for (const enzyme_model& enzyme : s.enzymes) {
+                if (separate) {
+                    os << ",";
+                }
+                separate = true;
+                os << enzyme.state;
+            }
+        }
+
+        os << "]";
+        os << "}";
+
+        return os;
+    }
+
+private:
+
+    // Minimum amount of enzymes handled by a thread in each parallel loop
+    static constexpr std::size_t PARALLEL_GRAIN = 8;
+
+    Logger logger;
+
+    /**
+     * @brief Indexes of the enzymes with the next internal transition.
+     */
+    std::vector<std::size_t> imminents() const {
+        std::vector<std::size_t> result;
+        if (this->state.schedule.empty()) {
+            return result;
+        }
+
+        const TIME& next_time = this->state.schedule.begin()->first;
+        for (auto it = this->state.schedule.begin(); it != this->state.schedule.end() && it->first == next_time; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Applies the transitions of the imminent enzymes and the enzymes with inputs.
+     * @details The enzymes do not share any state, thus their transitions run in parallel in
+     * the thread pool of the calling thread. The schedule is updated afterwards in the enzymes order.
+     */
+    void transition(const std::vector<std::size_t>& imminents, std::map<std::size_t, input_bags>& inputs) {
+        struct step {
+            std::size_t index;
+            bool imminent;
+            const input_bags* inputs;
+        };
+
+        std::vector<step> steps;
+        steps.reserve(imminents.size() + inputs.size());
+        for (std::size_t index : imminents) {
+            auto enzyme_inputs = inputs.find(index);
+            steps.push_back({index, true, enzyme_inputs == inputs.end() ? nullptr : &enzyme_inputs->second});
+        }
+        // The imminents have the same time, thus they are sorted by index
+        for (const auto& enzyme_inputs : inputs) {
+            if (!std::binary_search(imminents.begin(), imminents.end(), enzyme_inputs.first)) {
+                steps.push_back({enzyme_inputs.first, false, &enzyme_inputs.second});
+            }
+        }
+
+        ThreadPool::current().parallel_for(0, steps.size(), [this, &steps](std::size_t i) {
+            const step& current = steps[i];
+            enzyme_model& enzyme = this->state.enzymes[current.index];
+            TIME elapsed = this->state.current_time - this->state.last_times[current.index];
+
+            if (current.inputs == nullptr) {
+                enzyme.internal_transition();
+            } else if (current.imminent) {
+                enzyme.confluence_transition(elapsed, *current.inputs);
+            } else {
+                enzyme.external_transition(elapsed, *current.inputs);
+            }
+        }, PARALLEL_GRAIN);
+
+        for (const step& current : steps) {
+            this->reschedule(current.index);
+        }
+    }
+
+    /**
+     * @brief Splits the incoming reactants by the index of the enzyme they are for.
+     */
+    std::map<std::size_t, input_bags> route(const input_bags& mbs) const {
+        std::map<std::size_t, input_bags> result;
+        for (const auto& reactant : get_messages<typename enzyme_ports::in_0>(mbs)) {
+            int index = this->state.routing_table.at(reactant.enzyme_id);
+            assert(index >= 0);
+            get_messages<typename enzyme_ports::in_0>(result[index]).push_back(reactant);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Updates the enzyme last and next times after one of its transitions.
+     */
+    void reschedule(std::size_t index) {
+        this->state.schedule.erase({this->state.next_times[index], index});
+
+        this->state.last_times[index] = this->state.current_time;
+        TIME time_advance = this->state.enzymes[index].time_advance();
+        if (time_advance == TIME::infinity()) {
+            this->state.next_times[index] = TIME::infinity();
+        } else {
+            this->state.next_times[index] = this->state.current_time + time_advance;
+            this->state.schedule.insert({this->state.next_times[index], index});
+        }
+
+        this->state.changed.touch(index);
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_MODEL_ENZYME_SET_HPP
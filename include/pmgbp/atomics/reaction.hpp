@@ -44,7 +44,9 @@
 #include <cadmium/modeling/message_bag.hpp>
 
 #include <pmgbp/lib/Logger.hpp>
-#include <pmgbp/lib/Random.hpp> // RealRandom
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Random.hpp> // IntegerRandom
+#include <pmgbp/lib/StateDelta.hpp>
 #include <pmgbp/lib/TaskScheduler.hpp>
 #include <pmgbp/lib/TupleOperators.hpp>
 
@@ -88,16 +90,17 @@ public:
     struct state_type{
         string id;
         TIME rate;
-        map<string, MetaboliteAmounts> substrate_sctry; // the stoichiometry is separated by compartments
-        map<string, MetaboliteAmounts> products_sctry; // the stoichiometry is separated by compartments
-        map<string, Integer> substrate_comps;
-        map<string, Integer> product_comps;
+        map<symbols::cid, MetaboliteAmounts> substrate_sctry; // the stoichiometry is separated by compartments
+        map<symbols::cid, MetaboliteAmounts> products_sctry; // the stoichiometry is separated by compartments
+        map<symbols::cid, Integer> substrate_comps;
+        map<symbols::cid, Integer> product_comps;
         double koff_STP;
         double koff_PTS;
         TIME reject_rate;
 
-        RoutingTable<string> routing_table;
+        DenseRoutingTable<symbols::sid> routing_table;
         TaskScheduler<TIME, output_bags> tasks;
+        ChangeTracker<TIME> changed_tasks; // times of the tasks added by the last transition
     };
 
     state_type state;
@@ -121,8 +124,8 @@ public:
 
     /**
      * @brief Parser constructor
-     * @details Construct a new reaction atomic model instance by opening and parsing the xml
-     * file in the path xml_file.
+     * @details Construct a new reaction atomic model instance using the parameters of the xml
+     * file in the path xml_file. The file is parsed only once and shared by all the models.
      *
      * @param xml_file path where the xml file containing all the parameters is located.
      * @param id model id.
@@ -134,13 +137,7 @@ public:
         // Initialize random generators
         this->initialize_random_engines();
 
-        tinyxml2::XMLDocument doc;
-        tinyxml2::XMLError opened = doc.LoadFile(xml_file);
-        assert(opened == tinyxml2::XML_SUCCESS);
-
-        tinyxml2::XMLElement* root = doc.RootElement()
-                ->FirstChildElement("reactions")
-                ->FirstChildElement(id);
+        const tinyxml2::XMLElement* root = ParameterStore::get(xml_file).reaction(id);
 
 
         // Read simple state parameters
@@ -150,10 +147,11 @@ public:
         this->state.koff_PTS = std::stod(root->FirstChildElement("koffPTS")->GetText());
 
         // Read stoichiometry by compartments
-        tinyxml2::XMLElement* compartment;
-        tinyxml2::XMLElement* stoichiometry_specie;
+        const tinyxml2::XMLElement* compartment;
+        const tinyxml2::XMLElement* stoichiometry_specie;
         MetaboliteAmounts  substrate_sctry, products_sctry;
-        string specie_id, cid;
+        symbols::sid specie_id;
+        symbols::cid cid;
         int specie_amount;
 
         compartment = root
@@ -161,7 +159,7 @@ public:
                 ->FirstChildElement("compartment");
         while (compartment != nullptr) {
 
-            cid = compartment->FirstChildElement("id")->GetText();
+            cid = symbols::compartments().intern(compartment->FirstChildElement("id")->GetText());
 
             substrate_sctry.clear();
             stoichiometry_specie = compartment->FirstChildElement("substrate");
@@ -169,7 +167,7 @@ public:
                 stoichiometry_specie = stoichiometry_specie->FirstChildElement();
             }
             while (stoichiometry_specie != nullptr) {
-                specie_id = stoichiometry_specie->Attribute("id");
+                specie_id = symbols::species().intern(stoichiometry_specie->Attribute("id"));
                 specie_amount = std::stoi(stoichiometry_specie->Attribute("amount"));
                 substrate_sctry.insert({specie_id, specie_amount});
 
@@ -186,7 +184,7 @@ public:
                 stoichiometry_specie = stoichiometry_specie->FirstChildElement();
             }
             while (stoichiometry_specie != nullptr) {
-                specie_id = stoichiometry_specie->Attribute("id");
+                specie_id = symbols::species().intern(stoichiometry_specie->Attribute("id"));
                 specie_amount = std::stoi(stoichiometry_specie->Attribute("amount"));
                 products_sctry.insert({specie_id, specie_amount});
 
@@ -201,15 +199,15 @@ public:
         }
 
         // Read routing_table
-        tinyxml2::XMLElement* routing_table;
-        tinyxml2::XMLElement* entry;
+        const tinyxml2::XMLElement* routing_table;
+        const tinyxml2::XMLElement* entry;
         int port_number;
-        string metabolite_id;
+        symbols::sid metabolite_id;
 
         routing_table = root->FirstChildElement("routingTable");
         entry = routing_table->FirstChildElement();
         while (entry != nullptr) {
-            metabolite_id = entry->Attribute("metaboliteId");
+            metabolite_id = symbols::species().intern(entry->Attribute("metaboliteId"));
             port_number = std::stoi(entry->Attribute("port"));
             this->state.routing_table.insert(metabolite_id, port_number);
 
@@ -218,59 +216,64 @@ public:
     }
 
     void internal_transition() {
-        this->logger.info("Begin internal_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
+        this->state.changed_tasks.begin();
         this->state.tasks.advance();
-        this->logger.info("End internal_transition");
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
     }
 
     void external_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin external_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
 
+        this->state.changed_tasks.begin();
         this->state.tasks.update(e);
 
         // Inserting new accepted metabolites
-        map<pair<string, Way>, int> rejected = {}; // first = STP, second = PTS
+        map<pair<symbols::cid, Way>, Integer> rejected = {}; // first = STP, second = PTS
         this->bindMetabolites(mbs, rejected);
 
         // New task for the rejected metabolites to be send it.
         output_bags rejected_metabolites;
         sendBackRejected(rejected, rejected_metabolites);
         this->state.tasks.add(this->state.reject_rate, rejected_metabolites);
+        this->state.changed_tasks.touch(this->state.tasks.now() + this->state.reject_rate);
 
         // looking for new reactions
         output_bags products;
         this->lookForNewReactions(products);
         this->state.tasks.add(this->state.rate, products);
-        this->logger.info("End external_transition");
+        this->state.changed_tasks.touch(this->state.tasks.now() + this->state.rate);
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
     }
 
     void confluence_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
         internal_transition();
+        this->state.changed_tasks.keep();
         external_transition(TIME::zero(), mbs);
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
     }
 
     output_bags output() const {
-        this->logger.info("Begin output");
+        PMGBP_LOG_INFO(this->logger, "Begin output");
 
         output_bags bags;
 
-        list<output_bags> outputs = this->state.tasks.next();
+        const list<output_bags>& outputs = this->state.tasks.next();
         for (const auto &current_bags: outputs) {
             pmgbp::tuple::merge(bags, current_bags);
         }
 
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
         return bags;
     }
 
     TIME time_advance() const {
-        this->logger.info("Begin time_advance");
+        PMGBP_LOG_INFO(this->logger, "Begin time_advance");
 
         TIME result = this->state.tasks.time_advance();
 
-        this->logger.info("End time_advance");
+        PMGBP_LOG_INFO(this->logger, "End time_advance");
         return result;
     }
 
@@ -278,10 +281,19 @@ public:
         os << "{";
         os << "\"model_class\":\"reaction\",";
         os << "\"id\":\"" << s.id << "\",";
+
+        // The deltas only print the tasks with elements added by the last transition
+        bool delta = !s.changed_tasks.keyframe();
+        if (delta) {
+            os << "\"delta\":true,";
+        }
         os << "\"reactions_in_progress\": [";
 
         bool separate = false;
         for (const auto& task : s.tasks.queue()) {
+            if (delta && s.changed_tasks.changed().count(s.tasks.now() + task.time_left) == 0) {
+                continue;
+            }
             if (separate) {
                 os << ",";
             }
@@ -303,7 +315,7 @@ private:
 
     /*********** Private attributes **********/
 
-    RealRandom<double> real_random; // used for uniform random number
+    IntegerRandom<Integer> integer_random; // used for binomial random numbers
     Logger logger;
 
     /*********** Private attributes **********/
@@ -314,55 +326,56 @@ private:
 
     void initialize_random_engines() {
 
-        // real_random is initialized with a random generator engine
-        random_device real_rd; // Random generator engine
-        this->real_random.seed(real_rd());
+        // The stream only depends on the master seed and the reaction id
+        this->integer_random.seed(RandomSeed::stream("Reaction_" + this->state.id));
     }
 
-    void push_to_correct_port(string metabolite_id, output_bags& bags, const Product& m) const {
+    void push_to_correct_port(symbols::sid metabolite_id, output_bags& bags, const Product& m) const {
         int port_number = this->state.routing_table.at(metabolite_id);
         pmgbp::tuple::get<Product>(bags, port_number).emplace_back(m);
     }
 
     void bindMetabolites(typename make_message_bags<input_ports>::type mbs,
-                         map<pair<string, Way>, int> &rejected) {
+                         map<pair<symbols::cid, Way>, Integer> &rejected) {
 
         for (const auto &x : get_messages<typename PORTS::in_0>(mbs)) {
 
             if (x.reaction_direction == Way::STP) {
-
-                // TODO: replace this by a single step using uniform distribution to calculate the rejected and accepted amount
-                for (int i = 0; i < x.reaction_amount; ++i) {
-                    if (acceptedMetabolites(state.koff_STP)) state.substrate_comps.at(x.from) += 1;
-                    else increaseRejected(rejected, x.from, Way::STP);
-                }
+                Integer accepted = this->acceptedMetabolites(x.reaction_amount, state.koff_STP);
+                state.substrate_comps.at(x.from) += accepted;
+                this->increaseRejected(rejected, x.from, Way::STP, x.reaction_amount - accepted);
             } else {
-
-                // TODO: replace this by a single step using uniform distribution to calculate the rejected and accepted amount
-                for (int i = 0; i < x.reaction_amount; ++i) {
-                    if (acceptedMetabolites(state.koff_PTS)) state.product_comps.at(x.from) += 1;
-                    else increaseRejected(rejected, x.from, Way::PTS);
-                }
+                Integer accepted = this->acceptedMetabolites(x.reaction_amount, state.koff_PTS);
+                state.product_comps.at(x.from) += accepted;
+                this->increaseRejected(rejected, x.from, Way::PTS, x.reaction_amount - accepted);
             }
         }
     }
 
-    bool acceptedMetabolites(double k) {
-        return (this->real_random.drawNumber(0.0, 1.0) > k);
+    /**
+     * @brief Number of metabolites accepted out of amount, each one is rejected
+     * with probability k.
+     */
+    Integer acceptedMetabolites(Integer amount, double k) {
+        return this->integer_random.drawBinomial(amount, 1.0 - k);
     }
 
-    void increaseRejected(map<pair<string, Way>, int>& rejected, const string& compartment, Way direction) {
+    void increaseRejected(map<pair<symbols::cid, Way>, Integer>& rejected, symbols::cid compartment, Way direction, Integer amount) {
+
+        if (amount == 0) {
+            return;
+        }
 
         // insert rejected information compartment and rejected reaction direction
-        pair<string, Way> key = make_pair(compartment, direction);
+        pair<symbols::cid, Way> key = make_pair(compartment, direction);
         if(rejected.find(key) != rejected.end()) {
-            rejected.at(key) += 1;
+            rejected.at(key) += amount;
         } else {
-            rejected.insert({key, 1});
+            rejected.insert({key, amount});
         }
     }
 
-    void sendBackRejected(const map<pair<string, Way>, int> &rejected, output_bags &bags) const {
+    void sendBackRejected(const map<pair<symbols::cid, Way>, Integer> &rejected, output_bags &bags) const {
 
         Product message;
         for ( const auto &it : rejected) {
@@ -422,7 +435,7 @@ private:
         }
     }
 
-    void removeMetabolites(map<string, Integer>& comp, Integer a) {
+    void removeMetabolites(map<symbols::cid, Integer>& comp, Integer a) {
 
         for (auto &it : comp) {
             it.second -= a;
@@ -430,7 +443,7 @@ private:
     }
 
     // TODO: test this function specially
-    Integer totalReadyFor(const map<string, Integer>& comp) {
+    Integer totalReadyFor(const map<symbols::cid, Integer>& comp) {
 
         Integer result = comp.cbegin()->second;
         for (const auto &it : comp) {
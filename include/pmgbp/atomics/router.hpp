@@ -1,12 +1,16 @@
 #ifndef PMGBP_PDEVS_MODEL_ROUTER_HPP
 #define PMGBP_PDEVS_MODEL_ROUTER_HPP
 
-#include <map>
+#include <cassert>
 
 #include <cadmium/modeling/message_bag.hpp>
 
 #include <pmgbp/lib/TupleOperators.hpp>
 #include <pmgbp/lib/Logger.hpp>
+#include <pmgbp/lib/ParameterStore.hpp>
+
+#include <pmgbp/structures/symbols.hpp>
+#include <pmgbp/structures/types.hpp> // DenseRoutingTable
 
 #include <tinyxml2.h>
 
@@ -28,7 +32,7 @@ public:
     struct state_type {
         string id;
         output_bags output;
-        map<string, int> routing_table;
+        pmgbp::types::DenseRoutingTable<symbols::eid> routing_table;
     };
 
     state_type state;
@@ -37,8 +41,8 @@ public:
 
     /**
      * @brief Parser constructor
-     * @details Construct a new router atomic model instance by opening and parsing the xml
-     * file in the path xml_file.
+     * @details Construct a new router atomic model instance using the parameters of the xml
+     * file in the path xml_file. The file is parsed only once and shared by all the models.
      *
      * @param xml_file path where the xml file containing all the parameters is located.
      * @param id model id.
@@ -46,61 +50,55 @@ public:
     explicit router_template(const char* xml_file, const char* id) {
         this->state.id = id;
         logger.setModuleName("Router_" + this->state.id);
-        logger.info("Loading from XML");
-
-        tinyxml2::XMLDocument doc;
-        tinyxml2::XMLError opened = doc.LoadFile(xml_file);
-        assert(opened == tinyxml2::XML_SUCCESS);
+        PMGBP_LOG_INFO(this->logger, "Loading from XML");
 
-        tinyxml2::XMLElement* root = doc.RootElement()
-                ->FirstChildElement("routers")
-                ->FirstChildElement(id);
+        const tinyxml2::XMLElement* root = ParameterStore::get(xml_file).router(id);
 
         // Load routing table
-        tinyxml2::XMLElement* routing_table = root->FirstChildElement("routingTable");
-        for (tinyxml2::XMLElement* entry = routing_table->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
-            string enzyme_id = entry->Attribute("enzymeID");
+        const tinyxml2::XMLElement* routing_table = root->FirstChildElement("routingTable");
+        for (const tinyxml2::XMLElement* entry = routing_table->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+            symbols::eid enzyme_id = symbols::enzymes().intern(entry->Attribute("enzymeID"));
             int port_number = std::stoi(entry->Attribute("port"));
-            this->state.routing_table.insert({enzyme_id, port_number});
+            this->state.routing_table.insert(enzyme_id, port_number);
         }
     }
 
     /********** P-DEVS functions **************/
 
     void internal_transition() {
-        this->logger.info("Begin internal_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
         pmgbp::tuple::map<typename PORTS::output_type>(this->state.output, router_template::clear_bag);
-        this->logger.info("End internal_transition");
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
     }
 
     void external_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin external_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
         for (const auto &x : get_messages<typename PORTS::in_0>(mbs)) {
             this->push_to_correct_port(x);
         }
-        this->logger.info("End external_transition");
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
     }
 
     void confluence_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
         internal_transition();
         external_transition(TIME::zero(), mbs);
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
     }
 
     TIME time_advance() const {
-        this->logger.info("Begin time_advance");
+        PMGBP_LOG_INFO(this->logger, "Begin time_advance");
         TIME next_internal = TIME::infinity();
         if (!pmgbp::tuple::empty(this->state.output)) {
             next_internal = TIME::zero();
         }
-        this->logger.info("End time_advance");
+        PMGBP_LOG_INFO(this->logger, "End time_advance");
         return next_internal;
     }
 
     output_bags output() const {
-        this->logger.info("Begin output");
-        this->logger.info("End output");
+        PMGBP_LOG_INFO(this->logger, "Begin output");
+        PMGBP_LOG_INFO(this->logger, "End output");
         return this->state.output;
     }
 
@@ -145,6 +143,7 @@ private:
 
     void push_to_correct_port(const typename PORTS::output_type& message) {
         int port_num = this->state.routing_table.at(message.enzyme_id);
+        assert(port_num >= 0);
         pmgbp::tuple::get<typename PORTS::output_type>(this->state.output, port_num).emplace_back(message);
     }
 };
@@ -32,6 +32,8 @@
 #include <cassert>
 #include <algorithm>
 #include <cmath>
+#include <set>
+#include <type_traits>
 
 #include <cadmium/modeling/message_bag.hpp>
 
@@ -39,7 +41,11 @@
 
 #include <pmgbp/lib/Random.hpp> // RealRandom
 #include <pmgbp/lib/Logger.hpp>
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
 #include <pmgbp/lib/TaskScheduler.hpp>
+#include <pmgbp/lib/TauLeaping.hpp>
 #include <pmgbp/lib/TupleOperators.hpp>
 
 #include <pmgbp/structures/types.hpp> // ReactionInfo, Integer, RoutingTable
@@ -54,6 +60,17 @@ using namespace cadmium;
 using namespace pmgbp::types;
 using namespace pmgbp::structs::space;
 
+/**
+ * @brief Detects the space ports with a single out_routed port. The spaces with these ports
+ * send all their reactants through it, as Routed messages to their routing table port, and
+ * the model holding the space routes them at runtime.
+ */
+template<class PORTS, class = void>
+struct has_routed_output : std::false_type {};
+
+template<class PORTS>
+struct has_routed_output<PORTS, std::void_t<typename PORTS::out_routed>> : std::true_type {};
+
 /**
  * @author Laouen Mayal Louan Belloli
  *
@@ -78,11 +95,15 @@ public:
     using output_bags=typename make_message_bags<output_ports>::type;
     using input_bags=typename make_message_bags<input_ports>::type;
 
+    // The same enzyme can be located in several enzyme sets
+    using enzyme_key=pair<symbols::eid, EnzymeAddress>;
+
     struct state_type {
         string id;
+        symbols::cid compartment;
         TIME interval_time;
         MetaboliteAmounts metabolites;
-        map<string, Enzyme> enzymes;
+        map<enzyme_key, Enzyme> enzymes;
         RoutingTable<EnzymeAddress> routing_table;
         // Volume in cubic meters
         long double volume;
@@ -96,6 +117,10 @@ public:
         //long double volume = 0.0000000000000000001;
 
         TaskScheduler<TIME, Task<output_ports>> tasks;
+
+        // Entries changed by the last transition, only those are logged in the deltas
+        ChangeTracker<symbols::sid> changed_metabolites;
+        ChangeTracker<enzyme_key> changed_enzymes;
     };
 
     state_type state;
@@ -117,31 +142,30 @@ public:
 
         // Initialize random generators
         this->initialize_random_engines();
+
+        this->buildBindingIndex();
+        this->setNextSelection();
     }
 
     /**
      * @brief Parser constructor
-     * @details Construct a new space atomic model instance by opening and parsing the xml
-     * file in the path xml_file.
+     * @details Construct a new space atomic model instance using the parameters of the
+     * xml file in the path xml_file. The file is parsed only once and shared by all the models.
      *
      * @param xml_file path where the xml file containing all the parameters is located.
      * @param id model id.
      */
     explicit space(const char* xml_file, const char* id) {
         this->state.id = id;
+        this->state.compartment = symbols::compartments().intern(this->state.id);
         logger.setModuleName("Space_" + this->state.id);
-        logger.info("Loading from XML");
+        PMGBP_LOG_INFO(this->logger, "Loading from XML");
 
         // Initialize random generators
         this->initialize_random_engines();
 
-        tinyxml2::XMLDocument doc;
-        tinyxml2::XMLError opened = doc.LoadFile(xml_file);
-        assert(opened == tinyxml2::XML_SUCCESS);
-
-        tinyxml2::XMLElement* root = doc.RootElement()
-                ->FirstChildElement("spaces")
-                ->FirstChildElement(id);
+        const ParameterStore& parameters = ParameterStore::get(xml_file);
+        const tinyxml2::XMLElement* root = parameters.space(id);
 
 
         // Load compartment volume
@@ -151,45 +175,43 @@ public:
         this->state.interval_time = TIME(root->FirstChildElement("intervalTime")->GetText());
 
         // Load metabolites
-        tinyxml2::XMLElement* metabolites = root->FirstChildElement("metabolites");
-        tinyxml2::XMLElement* metabolite = metabolites->FirstChildElement();
+        const tinyxml2::XMLElement* metabolites = root->FirstChildElement("metabolites");
+        const tinyxml2::XMLElement* metabolite = metabolites->FirstChildElement();
         while (metabolite != nullptr) {
-            string specie = metabolite->Attribute("id");
+            symbols::sid specie = symbols::species().intern(metabolite->Attribute("id"));
             Integer amount = Integer(std::stoi(metabolite->Attribute("amount")));
             this->state.metabolites.insert({specie, amount});
             metabolite = metabolite->NextSiblingElement();
         }
 
         // Load enzymes
-        string specie_id;
+        symbols::sid specie_id;
         Integer specie_amount;
 
-        tinyxml2::XMLElement* enzymes = root->FirstChildElement("enzymes");
-        for (tinyxml2::XMLElement* enzyme_entry = enzymes->FirstChildElement(); enzyme_entry != nullptr; enzyme_entry = enzyme_entry->NextSiblingElement()) {
+        const tinyxml2::XMLElement* enzymes = root->FirstChildElement("enzymes");
+        for (const tinyxml2::XMLElement* enzyme_entry = enzymes->FirstChildElement(); enzyme_entry != nullptr; enzyme_entry = enzyme_entry->NextSiblingElement()) {
 
             string enzyme_id = enzyme_entry->Value();
-            logger.debug("Loading enzyme " + enzyme_id);
+            PMGBP_LOG_DEBUG(this->logger, "Loading enzyme " + enzyme_id);
 
             // Load the enzyme address
-            tinyxml2::XMLElement* address = enzyme_entry->FirstChildElement("address");
+            const tinyxml2::XMLElement* address = enzyme_entry->FirstChildElement("address");
             EnzymeAddress enzyme_location(address->Attribute("cid"), address->Attribute("esn"));
 
             Integer enzyme_amount = Integer(std::stoi(enzyme_entry->Attribute("amount")));
 
             // Load handled reactions
-            map<string, ReactionInfo> handled_reactions;
-            tinyxml2::XMLElement* reactions = enzyme_entry->FirstChildElement("reactions");
-            for (tinyxml2::XMLElement* handled_reaction = reactions->FirstChildElement(); handled_reaction != nullptr; handled_reaction = handled_reaction->NextSiblingElement()) {
+            map<symbols::rid, ReactionInfo> handled_reactions;
+            const tinyxml2::XMLElement* reactions = enzyme_entry->FirstChildElement("reactions");
+            for (const tinyxml2::XMLElement* handled_reaction = reactions->FirstChildElement(); handled_reaction != nullptr; handled_reaction = handled_reaction->NextSiblingElement()) {
 
                 string reaction_id = handled_reaction->Attribute("id");
-                logger.debug("Loading enzyme " + enzyme_id + " reaction " + reaction_id);
+                PMGBP_LOG_DEBUG(this->logger, "Loading enzyme " + enzyme_id + " reaction " + reaction_id);
 
-                tinyxml2::XMLElement* reaction_parameters = doc.RootElement()
-                        ->FirstChildElement("reactions")
-                        ->FirstChildElement(reaction_id.c_str());
+                const tinyxml2::XMLElement* reaction_parameters = parameters.reaction(reaction_id);
 
                 // Load the reaction stoichiometry
-                tinyxml2::XMLElement* compartment_sctry = reaction_parameters
+                const tinyxml2::XMLElement* compartment_sctry = reaction_parameters
                         ->FirstChildElement("stoichiometryByCompartments")
                         ->FirstChildElement();
 
@@ -205,14 +227,14 @@ public:
                 double konPTS = std::stod(reaction_parameters->FirstChildElement("konPTS")->GetText());
                 double koffSTP = std::stod(reaction_parameters->FirstChildElement("koffSTP")->GetText());
                 double koffPTS = std::stod(reaction_parameters->FirstChildElement("koffPTS")->GetText());
-                bool reversible =reaction_parameters->FirstChildElement("reversible")->GetText() == "true";
+                bool reversible = ParameterStore::is_true(reaction_parameters->FirstChildElement("reversible"));
 
                 // Load the substrate stoichiometry
                 MetaboliteAmounts substrate_sctry;
-                tinyxml2::XMLElement* substrate = compartment_sctry->FirstChildElement("substrate");
+                const tinyxml2::XMLElement* substrate = compartment_sctry->FirstChildElement("substrate");
                 if (substrate != nullptr) {
-                    for (tinyxml2::XMLElement* species = substrate->FirstChildElement(); species != nullptr; species = species->NextSiblingElement()) {
-                        specie_id = species->Attribute("id");
+                    for (const tinyxml2::XMLElement* species = substrate->FirstChildElement(); species != nullptr; species = species->NextSiblingElement()) {
+                        specie_id = symbols::species().intern(species->Attribute("id"));
                         specie_amount = Integer(std::stoi(species->Attribute("amount")));
                         substrate_sctry.insert({specie_id, specie_amount});
                     }
@@ -220,17 +242,18 @@ public:
 
                 // Load the product stoichiometry
                 MetaboliteAmounts products_sctry;
-                tinyxml2::XMLElement* product = compartment_sctry->FirstChildElement("product");
+                const tinyxml2::XMLElement* product = compartment_sctry->FirstChildElement("product");
                 if (product != nullptr) {
-                    for (tinyxml2::XMLElement* species = product->FirstChildElement(); species != nullptr; species = species->NextSiblingElement()) {
-                        specie_id = species->Attribute("id");
+                    for (const tinyxml2::XMLElement* species = product->FirstChildElement(); species != nullptr; species = species->NextSiblingElement()) {
+                        specie_id = symbols::species().intern(species->Attribute("id"));
                         specie_amount = Integer(std::stoi(species->Attribute("amount")));
                         products_sctry.insert({specie_id, specie_amount});
                     }
                 }
 
                 // Save the reaction information
-                ReactionInfo reaction_information = ReactionInfo(reaction_id,
+                symbols::rid reaction_symbol = symbols::reactions().intern(reaction_id);
+                ReactionInfo reaction_information = ReactionInfo(reaction_symbol,
                                                                  substrate_sctry,
                                                                  products_sctry,
                                                                  konSTP,
@@ -239,23 +262,23 @@ public:
                                                                  koffPTS,
                                                                  reversible);
 
-                handled_reactions.insert({reaction_id, reaction_information});
+                handled_reactions.insert({reaction_symbol, reaction_information});
             }
 
             // If all the enzyme reactions are not related with the compartment, then, the compartment
             // mustn't handle the enzyme at all.
             if (!handled_reactions.empty()) {
-                Enzyme enzyme(enzyme_id, enzyme_location, enzyme_amount, handled_reactions);
-                this->state.enzymes.insert({enzyme_id + ":" + enzyme.location.str(), enzyme});
+                Enzyme enzyme(symbols::enzymes().intern(enzyme_id), enzyme_location, enzyme_amount, handled_reactions);
+                this->state.enzymes.insert({enzyme_key(enzyme.id, enzyme.location), enzyme});
             }
 
-            logger.debug("Loaded enzyme " + enzyme_id);
+            PMGBP_LOG_DEBUG(this->logger, "Loaded enzyme " + enzyme_id);
         }
 
-        logger.debug("Loading routing table");
+        PMGBP_LOG_DEBUG(this->logger, "Loading routing table");
         // Load routing_table
-        tinyxml2::XMLElement* routing_table;
-        tinyxml2::XMLElement* entry;
+        const tinyxml2::XMLElement* routing_table;
+        const tinyxml2::XMLElement* entry;
         int port_number;
 
         routing_table = root->FirstChildElement("routingTable");
@@ -266,6 +289,9 @@ public:
             this->state.routing_table.insert(enzyme_address, port_number);
             entry = entry->NextSiblingElement();
         }
+
+        this->buildBindingIndex();
+        this->setNextSelection();
     }
 
     /********* Space constructors *************/
@@ -273,7 +299,8 @@ public:
     /********** P-DEVS functions **************/
 
     void internal_transition() {
-        this->logger.info("Begin internal_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin internal_transition");
+        this->beginChanges();
 
         if (this->state.tasks.is_in_next(Task<output_ports>(Status::SELECTING_FOR_REACTION))) {
 
@@ -287,7 +314,11 @@ public:
             Task<output_ports> selected_reactants(Status::SENDING_REACTIONS);
             this->selectMetabolitesToReact(selected_reactants.message_bags);
             if (!pmgbp::tuple::empty(selected_reactants.message_bags)) {
-                pmgbp::tuple::map(selected_reactants.message_bags, space::mergeMessages);
+                if constexpr (has_routed_output<PORTS>::value) {
+                    space::mergeRoutedMessages(get_messages<typename PORTS::out_routed>(selected_reactants.message_bags));
+                } else {
+                    pmgbp::tuple::map(selected_reactants.message_bags, space::mergeMessages);
+                }
                 this->state.tasks.add(TIME_TO_SEND_FOR_REACTION, selected_reactants);
             }
         } else {
@@ -297,78 +328,116 @@ public:
 
         // setting new selection
         this->setNextSelection();
-        this->logger.info("End internal_transition");
+        PMGBP_LOG_INFO(this->logger, "End internal_transition");
     }
 
     void external_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin external_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin external_transition");
 
-        std::ostringstream oss;
-        oss << "External: ";
-        pmgbp::tuple::print(oss, mbs);
-        this->logger.debug(oss.str());
-
-        bool show_metabolites = false;
+        if (Logger::enabled(Logger::Level::DEBUG)) {
+            std::ostringstream oss;
+            oss << "External: ";
+            pmgbp::tuple::print(oss, mbs);
+            this->logger.debug(oss.str());
+        }
 
+        this->beginChanges();
         this->state.tasks.update(e);
 
         // Receive new metabolites
         for (const auto &x : get_messages<typename PORTS::in_0_product>(mbs)) {
             this->addMultipleMetabolites(this->state.metabolites, x.metabolites);
+            this->refreshBindings(x.metabolites);
+            this->touchMetabolites(x.metabolites);
         }
 
         // Receive released enzymes
         for (const auto &x : get_messages<typename PORTS::in_0_information>(mbs)) {
-            string eid = x.enzyme_id + ":" + x.location.str();
-            this->state.enzymes.at(eid).amount += x.released_enzymes;
+            enzyme_key key(x.enzyme_id, x.location);
+            size_t owner = this->enzyme_owners.at(key);
+            this->state.enzymes.at(key).amount += x.released_enzymes;
+            this->setFree(owner, true);
+            this->state.changed_enzymes.touch(key);
         }
 
         this->setNextSelection();
 
-        this->logger.info("End external_transition");
+        PMGBP_LOG_INFO(this->logger, "End external_transition");
     }
 
     void confluence_transition(TIME e, input_bags mbs) {
-        this->logger.info("Begin confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "Begin confluence_transition");
         internal_transition();
+        this->state.changed_metabolites.keep();
+        this->state.changed_enzymes.keep();
         external_transition(TIME::zero(), mbs);
-        this->logger.info("End confluence_transition");
+        PMGBP_LOG_INFO(this->logger, "End confluence_transition");
     }
 
     output_bags output() const {
-        this->logger.info("Begin output");
+        PMGBP_LOG_INFO(this->logger, "Begin output");
 
         output_bags bags;
 
-        list<Task<output_ports>> current_tasks = this->state.tasks.next();
+        const list<Task<output_ports>>& current_tasks = this->state.tasks.next();
         for (const auto &task : current_tasks) {
             if (task.kind == Status::SELECTING_FOR_REACTION) continue;
             pmgbp::tuple::merge(bags, task.message_bags);
         }
 
-        std::ostringstream oss;
-        oss << "Output: ";
-        pmgbp::tuple::print(oss, bags);
-        this->logger.debug(oss.str());
+        if (Logger::enabled(Logger::Level::DEBUG)) {
+            std::ostringstream oss;
+            oss << "Output: ";
+            pmgbp::tuple::print(oss, bags);
+            this->logger.debug(oss.str());
+        }
 
-        this->logger.info("End output");
+        PMGBP_LOG_INFO(this->logger, "End output");
         return bags;
     }
 
     TIME time_advance() const {
-        this->logger.info("Begin time_advance");
+        PMGBP_LOG_INFO(this->logger, "Begin time_advance");
 
+        // Without tasks the space is passive until an input lets an enzyme bind
         TIME result = this->state.tasks.time_advance();
 
-        if (result == TIME::infinity()) {
-            result = this->state.interval_time;
+        PMGBP_LOG_INFO(this->logger, "End time_advance");
+        return result;
+    }
+
+    /**
+     * @brief Writes or reads the dynamic state of the space, it is read over a space built
+     * from the same parameters.
+     * @details The binding probabilities are read as they were written, recomputing their
+     * running totals would not give the same rounding.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->state.metabolites;
+        pmgbp::serialization::expect_size(archive, this->state.enzymes.size());
+        for (auto& enzyme : this->state.enzymes) {
+            archive & enzyme.second.amount;
         }
+        archive & this->state.tasks & this->state.changed_metabolites & this->state.changed_enzymes;
+        archive & this->integer_random;
 
-        this->logger.info("End time_advance");
-        return result;
+        pmgbp::serialization::expect_size(archive, this->bindings.size());
+        for (Binding& binding : this->bindings) {
+            archive & binding.probability;
+        }
+        archive & this->enzyme_bindings;
+
+        if (ARCHIVE::loading) {
+            this->countBindableEnzymes();
+        }
     }
 
     friend std::ostringstream& operator<<(std::ostringstream& os, const typename space<PORTS,TIME>::state_type& s) {
+        if (!s.changed_metabolites.keyframe()) {
+            return space::printDelta(os, s);
+        }
+
         bool separate = false;
 
         os << "{";
@@ -381,7 +450,7 @@ public:
             }
             separate = true;
             os << "{";
-            os << "\"id\":\"" << enzyme.second.id << "\",";
+            os << "\"id\":\"" << symbols::enzymes().name(enzyme.second.id) << "\",";
             os << "\"amount\":" << enzyme.second.amount;
             os << "}";
         }
@@ -395,7 +464,7 @@ public:
             }
             separate = true;
             os << "{";
-            os << "\"id\":\"" << metabolite.first << "\",";
+            os << "\"id\":\"" << symbols::species().name(metabolite.first) << "\",";
             os << "\"amount\":" << metabolite.second;
             os << "}";
         }
@@ -412,182 +481,368 @@ private:
 
     /*********** Private attributes **********/
 
-    RealRandom<double> real_random;
     IntegerRandom<Integer> integer_random;
     Logger logger;
 
+    // Scratch buffers reused by each selection to avoid allocations
+    vector<pair<Enzyme*, size_t>> selection_order; // enzyme and its bindings index
+    vector<size_t> channels; // ready bindings of the current enzyme
+    vector<double> channel_probabilities;
+    vector<size_t> channel_order;
+
+    // Scratch buffers of the tau leaping
+    struct LeapDraw {
+        Enzyme* enzyme;
+        size_t binding;
+        Integer count;
+    };
+    vector<pair<Enzyme*, size_t>> leapers; // enzyme species that leap and their bindings index
+    vector<Integer> channel_counts;
+    vector<LeapDraw> leap_draws;
+    map<symbols::sid, long double> leap_expected; // expected consumption of each species in the interval
+    set<symbols::sid> leap_touched;
+
+    // Reaction directions of each enzyme with their binding probability for the current
+    // amounts, indexed by the species they consume to only recompute the ones that changed
+    struct Binding {
+        size_t owner; // index in enzyme_bindings
+        symbols::rid reaction;
+        Way direction;
+        MetaboliteAmounts sctry;
+        double kon;
+        double probability; // zero if it can't bind
+    };
+
+    // Bindings of each enzyme, in the state.enzymes order, with the running totals of
+    // the STP (sons) and PTS (pons) binding probabilities
+    struct EnzymeBindings {
+        size_t begin;
+        size_t end;
+        size_t ready;
+        long double sons;
+        long double pons;
+        bool free; // the enzyme amount is positive
+    };
+
+    vector<Binding> bindings;
+    vector<EnzymeBindings> enzyme_bindings;
+    map<enzyme_key, size_t> enzyme_owners; // index in enzyme_bindings of each enzyme
+    size_t bindable_enzymes = 0; // free enzymes with a ready binding
+    map<symbols::sid, vector<size_t>> bindings_by_species;
+
     /*********** Private attributes **********/
 
     void initialize_random_engines() {
 
-        // The random attributes must be initialized with a random generator variables
-        random_device real_rd;
-        this->real_random.seed(real_rd());
-
-        random_device integer_rd;
-        this->integer_random.seed(integer_rd());
+        // The stream only depends on the master seed and the space id
+        this->integer_random.seed(RandomSeed::stream("Space_" + this->state.id));
     }
 
     void push_to_correct_port(EnzymeAddress address, output_bags& bags, const Reactant& p) {
         int port_number = this->state.routing_table.at(address);
-        pmgbp::tuple::get<Reactant>(bags, port_number).emplace_back(p);
+        if constexpr (has_routed_output<PORTS>::value) {
+            get_messages<typename PORTS::out_routed>(bags).push_back(Routed<Reactant>{port_number, -1, p});
+        } else {
+            pmgbp::tuple::get<Reactant>(bags, port_number).emplace_back(p);
+        }
     }
 
+    /**
+     * @brief Selects the enzymes that bind metabolites in the current selection interval.
+     * @details The enzyme species are randomly iterated. For each species the cached binding
+     * probabilities of its reaction directions for the current metabolite amounts are taken
+     * and the species amount is split between the directions with a multinomial draw, as a
+     * chain of conditional binomials over the directions in random order. A direction never
+     * takes more enzymes than the available metabolites can feed, the enzymes it can't feed
+     * stay free and are drawn again over the remaining directions, as if they had tried to
+     * bind to those first. The metabolites are consumed before the next species is considered.
+     * With the tau leaping the species that don't consume a critical species bind first in leaps.
+     */
     void selectMetabolitesToReact(output_bags& bags) {
 
-        Reactant reactant;
-        map<string, long double> sons, pons;
-        ReactionInfo re;
-
-        // Enzyme are individually considered and randomly iterated
-        vector<string> unfolded_enzymes;
-        this->unfoldEnzymes(unfolded_enzymes);
-        this->shuffleEnzymes(unfolded_enzymes);
-
-        for (auto &eid : unfolded_enzymes) {
+        this->selection_order.clear();
+        size_t owner = 0;
+        for (auto &enzyme : this->state.enzymes) {
+            if (enzyme.second.amount > 0) {
+                this->selection_order.emplace_back(&enzyme.second, owner);
+            }
+            ++owner;
+        }
+        this->integer_random.shuffle(this->selection_order.begin(), this->selection_order.end());
 
-            sons.clear();
-            pons.clear();
-            re.clear();
+        // The enzyme species that can leap bind first, only the others are left in the order
+        if (TauLeaping::enabled()) {
+            this->leap(bags);
+        }
 
-            Enzyme& enzyme = this->state.enzymes.at(eid);
+        for (const auto &selected : this->selection_order) {
 
-            this->collectOns(enzyme.handled_reactions, sons, pons);
+            Enzyme* enzyme = selected.first;
+            if (!this->normalizeChannelProbabilities(this->collectChannels(selected.second))) {
+                continue;
+            }
 
-            // sons + pons can't be greater than 1. If that happen, they are normalized
-            // if sons + pons is smaller than 1, there is a chance that the enzyme does'nt react
-            long double total = this->sumAll(sons) + this->sumAll(pons);
-            if (total > 1) {
-                this->normalize(sons, total);
-                this->normalize(pons, total);
+            // The channels are drawn in random order to avoid favouring the first reactions
+            // when there are not enough metabolites for all the bound enzymes
+            this->channel_order.resize(this->channels.size());
+            for (size_t i = 0; i < this->channel_order.size(); ++i) {
+                this->channel_order[i] = i;
             }
+            this->integer_random.shuffle(this->channel_order.begin(), this->channel_order.end());
 
-            // The interval [0,1] is  divided in pieces:
-            // {[0,son1), [son1, son1+son2),
-            // ... ,
-            // [son1 + ... + sonk, son1 + ... + sonk + pon1),
-            // ... ,
-            // [son1 + ... + sonk + pon1 + ... + ponk, 1)}
-            // Depending to which intervals rv belongs, the enzyme triggers
-            // the corresponding reaction or do nothing (last interval).
-
-            long double rv = real_random.drawNumber(0.0, 1.0);
-
-            long double partial = 0.0;
-            for (auto &son : sons) {
-
-                partial += son.second;
-                if (rv < partial) {
-
-                    // send message to trigger the reaction
-                    re = enzyme.handled_reactions.at(son.first);
-                    reactant.clear();
-                    reactant.rid = re.id;
-                    reactant.enzyme_id = enzyme.id;
-                    reactant.from = this->state.id;
-                    reactant.reaction_direction = Way::STP;
-                    reactant.reaction_amount = 1;
-                    this->push_to_correct_port(enzyme.location, bags, reactant);
-
-                    // update enzyme amount
-                    enzyme.amount--;
-
-                    // update the metabolite amount in the space
-                    for (auto &metabolite : re.substrate_sctry) {
-                        if (this->state.metabolites.find(metabolite.first) != this->state.metabolites.end()) {
-                            assert(this->state.metabolites.at(metabolite.first) >= metabolite.second);
-                            this->state.metabolites.at(metabolite.first) -= metabolite.second;
-                        }
-                    }
+            // Probability of the channels not drawn yet plus the probability of not binding,
+            // the normalized probabilities add up to at most 1
+            long double remaining = 1.0;
+            Integer free = enzyme->amount;
+            for (size_t channel_index : this->channel_order) {
 
-                    // once the reaction is set the enzyme was processed and it moves on to the next enzyme
+                if (free == 0) {
                     break;
                 }
+
+                double probability = this->channel_probabilities[channel_index];
+                double conditional = (remaining > probability) ? double(probability / remaining) : 1.0;
+                remaining -= probability;
+
+                Integer drawn = this->integer_random.drawBinomial(free, conditional);
+                if (drawn == 0) {
+                    continue;
+                }
+
+                const Binding& binding = this->bindings[this->channels[channel_index]];
+                const MetaboliteAmounts& sctry = binding.sctry;
+
+                // The enzymes over the metabolites of the channel stay free for the next channels
+                Integer amount = std::min(drawn, this->maxReactions(sctry));
+                if (amount == 0) {
+                    continue;
+                }
+                free -= amount;
+
+                this->bind(enzyme, binding, amount, bags);
+                this->refreshBindings(sctry);
             }
+        }
+    }
 
-            if (!re.empty()) {
-                // If a reaction was triggered, then, we move to the next enzyme
+    /**
+     * @brief Sends amount enzymes of the species to react through the binding and consumes their
+     * metabolites from the space, the caller refreshes the bindings of the consumed species.
+     */
+    void bind(Enzyme* enzyme, const Binding& binding, Integer amount, output_bags& bags) {
+
+        // send message to trigger the reaction
+        Reactant reactant;
+        reactant.rid = binding.reaction;
+        reactant.enzyme_id = enzyme->id;
+        reactant.from = this->state.compartment;
+        reactant.reaction_direction = binding.direction;
+        reactant.reaction_amount = amount;
+        this->push_to_correct_port(enzyme->location, bags, reactant);
+
+        // update enzyme amount
+        enzyme->amount -= amount;
+        this->setFree(binding.owner, enzyme->amount > 0);
+        this->state.changed_enzymes.touch(enzyme_key(enzyme->id, enzyme->location));
+
+        // update the metabolite amount in the space, the binding was ready only if all the
+        // stoichiometry species are in the space
+        this->state.metabolites.subtract(binding.sctry, amount);
+        this->touchMetabolites(binding.sctry);
+    }
+
+    /**
+     * @brief Binds the enzyme species of the selection order that don't consume a critical
+     * species with a binomial tau leap, and leaves the others in the order for the exact selection.
+     * @details The interval is split in the leaps needed by the leap condition (see TauLeaping).
+     * In each leap all the leaping species draw how many of their free enzymes bind to each
+     * reaction direction from the binding probabilities at the start of the leap, the draws are
+     * applied together and the bindings of the consumed species are refreshed once. A direction
+     * never takes more enzymes than the metabolites left can feed, the others stay free for the
+     * next leap.
+     */
+    void leap(output_bags& bags) {
+
+        this->leapers.clear();
+        size_t exact = 0;
+        for (const auto &selected : this->selection_order) {
+            if (!this->normalizeChannelProbabilities(this->collectChannels(selected.second))) {
                 continue;
             }
+            if (this->consumesCritical()) {
+                this->selection_order[exact++] = selected;
+            } else {
+                this->leapers.push_back(selected);
+            }
+        }
+        this->selection_order.resize(exact);
+
+        // The species that need too many leaps are critical too
+        this->expectLeapConsumption();
+        this->leap_touched.clear();
+        for (const auto &expected : this->leap_expected) {
+            if (TauLeaping::leaps(expected.second, this->state.metabolites.at(expected.first)) > TauLeaping::MAX_LEAPS) {
+                this->leap_touched.insert(expected.first);
+            }
+        }
+        if (!this->leap_touched.empty()) {
+            size_t kept = 0;
+            for (const auto &selected : this->leapers) {
+                this->collectChannels(selected.second);
+                if (this->consumesAny(this->leap_touched)) {
+                    this->selection_order.push_back(selected);
+                } else {
+                    this->leapers[kept++] = selected;
+                }
+            }
+            this->leapers.resize(kept);
+            this->expectLeapConsumption();
+        }
+
+        size_t leaps = 1;
+        for (const auto &expected : this->leap_expected) {
+            leaps = std::max(leaps, TauLeaping::leaps(expected.second, this->state.metabolites.at(expected.first)));
+        }
 
-            // TODO(Lao): By adding the reaction direction to the Pons and Sons I can merge both lists
-            // and then just iterate over a sngle list instead of this.
-            // if re is empty, then no one of the STP reactions have ben triggered
-            // and the search continues with the PTS reactions.
-            for (auto &pon : pons) {
-
-                partial += pon.second;
-                if (rv < partial) {
-
-                    // send message to trigger the reaction
-                    re = enzyme.handled_reactions.at(pon.first);
-                    reactant.clear();
-                    reactant.rid = re.id;
-                    reactant.enzyme_id = enzyme.id;
-                    reactant.from = this->state.id;
-                    reactant.reaction_direction = Way::PTS;
-                    reactant.reaction_amount = 1;
-                    this->push_to_correct_port(enzyme.location, bags, reactant);
-
-                    // update enzyme amount
-                    enzyme.amount--;
-
-                    // update the metabolite amount in the space
-                    for (auto &metabolite : re.products_sctry) {
-                        if (this->state.metabolites.find(metabolite.first) != this->state.metabolites.end()) {
-                            assert(this->state.metabolites.at(metabolite.first) >= metabolite.second);
-                            this->state.metabolites.at(metabolite.first) -= metabolite.second;
-                        }
+        for (size_t step = 0; step < leaps && !this->leapers.empty(); ++step) {
+
+            this->leap_draws.clear();
+            for (const auto &selected : this->leapers) {
+                Enzyme* enzyme = selected.first;
+                long double total = this->collectChannels(selected.second);
+                if (enzyme->amount == 0 || !this->normalizeChannelProbabilities(total)) {
+                    continue;
+                }
+
+                // The directions keep their share of the probability of binding in the leap
+                double interval = double(std::min<long double>(total, 1.0));
+                double scale = TauLeaping::leapProbability(interval, leaps) / interval;
+                for (double& probability : this->channel_probabilities) {
+                    probability *= scale;
+                }
+
+                this->integer_random.drawMultinomial(enzyme->amount, this->channel_probabilities, this->channel_counts);
+                for (size_t i = 0; i < this->channels.size(); ++i) {
+                    if (this->channel_counts[i] > 0) {
+                        this->leap_draws.push_back(LeapDraw{enzyme, this->channels[i], this->channel_counts[i]});
                     }
+                }
+            }
 
-                    // once the reaction is set the enzyme was processed and it moves on to the next enzyme
-                    break;
+            // Applied in random order, the first ones take the metabolites when there are not enough
+            this->integer_random.shuffle(this->leap_draws.begin(), this->leap_draws.end());
+            this->leap_touched.clear();
+            for (const LeapDraw& draw : this->leap_draws) {
+                const Binding& binding = this->bindings[draw.binding];
+                Integer amount = std::min(draw.count, this->maxReactions(binding.sctry));
+                if (amount == 0) {
+                    continue;
+                }
+                this->bind(draw.enzyme, binding, amount, bags);
+                for (const auto &metabolite : binding.sctry) {
+                    this->leap_touched.insert(metabolite.first);
                 }
             }
+
+            for (symbols::sid specie : this->leap_touched) {
+                this->refreshBindings(specie);
+            }
         }
     }
 
-    void unfoldEnzymes(vector<string> &ce) const {
-        for (const auto &enzyme : this->state.enzymes) {
-            ce.insert(ce.end(), enzyme.second.amount, enzyme.first);
+    /**
+     * @brief Expected consumption of each species in the whole interval by the leaping enzyme
+     * species, with the current binding probabilities.
+     */
+    void expectLeapConsumption() {
+        this->leap_expected.clear();
+        for (const auto &selected : this->leapers) {
+            this->normalizeChannelProbabilities(this->collectChannels(selected.second));
+            for (size_t i = 0; i < this->channels.size(); ++i) {
+                for (const auto &metabolite : this->bindings[this->channels[i]].sctry) {
+                    this->leap_expected[metabolite.first] += (long double) selected.first->amount * this->channel_probabilities[i] * metabolite.second;
+                }
+            }
         }
     }
 
-    // TODO: test this function specially and put this in the random number class
-    void shuffleEnzymes(vector<string> &ce) const {
-        random_device rd;
-        mt19937 g(rd());
-        shuffle(ce.begin(), ce.end(), g);
+    /**
+     * @brief Tells if a collected channel consumes a species with less than
+     * TauLeaping::CRITICAL_AMOUNT metabolites.
+     */
+    bool consumesCritical() const {
+        for (size_t index : this->channels) {
+            for (const auto &metabolite : this->bindings[index].sctry) {
+                if (this->state.metabolites.at(metabolite.first) < Integer(TauLeaping::CRITICAL_AMOUNT)) {
+                    return true;
+                }
+            }
+        }
+        return false;
     }
 
-    void collectOns(const map<string, ReactionInfo>& reactions, map<string, long double>& son, map<string, long double>& pon) {
+    /**
+     * @brief Tells if a collected channel consumes one of the species.
+     */
+    bool consumesAny(const set<symbols::sid>& species) const {
+        for (size_t index : this->channels) {
+            for (const auto &metabolite : this->bindings[index].sctry) {
+                if (species.count(metabolite.first) > 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
 
-        long double threshold;
-        for (const auto &reaction : reactions) {
+    /**
+     * @brief Normalizes the channel probabilities if their total is more than 1.
+     * @return False if no channel can bind.
+     */
+    bool normalizeChannelProbabilities(long double total) {
 
-            // calculating the sons
-            bool can_react_STP = this->consumeMetaboliteFromSpace(reaction.second.substrate_sctry)
-                                 && this->thereAreEnoughToReact(reaction.second.substrate_sctry);
+        // The binding probabilities can't be greater than 1. If that happen, they are normalized
+        // if the total is smaller than 1, there is a chance that the enzymes does'nt react
+        if (total <= 0.0) {
+            return false;
+        }
 
-            if (can_react_STP) {
-                threshold = this->bindingThreshold(reaction.second.substrate_sctry, reaction.second.konSTP);
-                son.insert({reaction.first, threshold});
-            } else {
-                son.insert({reaction.first, 0});
+        if (total > 1) {
+            for (double& probability : this->channel_probabilities) {
+                probability /= total;
             }
+        }
+        return true;
+    }
 
-            // calculating the pons
-            bool can_react_PTS = reaction.second.reversible
-                                 && this->consumeMetaboliteFromSpace(reaction.second.products_sctry)
-                                 && this->thereAreEnoughToReact(reaction.second.products_sctry);
+    /**
+     * @brief Fills the channels with the ready bindings of the enzyme and their probabilities.
+     * @return The total binding probability of the channels.
+     */
+    long double collectChannels(size_t owner) {
 
-            if (can_react_PTS) {
-                threshold = this->bindingThreshold(reaction.second.products_sctry, reaction.second.konPTS);
-                pon.insert({reaction.first, threshold});
-            } else {
-                pon.insert({reaction.first, 0});
+        this->channels.clear();
+        this->channel_probabilities.clear();
+
+        const EnzymeBindings& enzyme = this->enzyme_bindings[owner];
+        if (enzyme.ready == 0) {
+            return 0.0;
+        }
+
+        for (size_t index = enzyme.begin; index < enzyme.end; ++index) {
+            if (this->bindings[index].probability > 0.0) {
+                this->channels.push_back(index);
+                this->channel_probabilities.push_back(this->bindings[index].probability);
             }
         }
+        return enzyme.sons + enzyme.pons;
+    }
+
+    /**
+     * @brief Maximum number of times the stoichiometry can be consumed from the space.
+     */
+    Integer maxReactions(const MetaboliteAmounts &sctry) const {
+        return this->state.metabolites.multiplicity(sctry);
     }
 
     // TODO: use the correct formula using the volume and everything and test this function specially
@@ -597,9 +852,9 @@ private:
         long double concentration = 1.0;
         long double LxVolume = L * this->state.volume;
         for (const auto &metabolite : sctry) {
-            if (this->state.metabolites.find(metabolite.first) != this->state.metabolites.end()) {
-                Integer amount = this->state.metabolites.at(metabolite.first);
-                concentration *= amount / LxVolume;
+            auto metabolite_info = this->state.metabolites.find(metabolite.first);
+            if (metabolite_info != this->state.metabolites.end()) {
+                concentration *= metabolite_info->second / LxVolume;
             }
         }
 
@@ -621,27 +876,69 @@ private:
     }
 
     bool thereAreEnoughToReact(const MetaboliteAmounts &stcry) const {
-        for (const auto &metabolite : stcry) {
-            auto metabolite_info = this->state.metabolites.find(metabolite.first);
-            if (metabolite_info == this->state.metabolites.end() || metabolite_info->second < metabolite.second) {
-                return false;
-            }
-        }
-
-        return true;
+        return this->state.metabolites.covers(stcry);
     }
 
     /**
      * Takes all the metabolites from om with an amount grater than 0 and add them to m.
      */
     void addMultipleMetabolites(MetaboliteAmounts &m, const MetaboliteAmounts &om) {
+        m.add(om);
+    }
 
-        for (const auto &metabolite : om) {
-            if (m.find(metabolite.first) != m.end()) {
-                m.at(metabolite.first) += metabolite.second;
-            } else {
-                m.insert({metabolite.first, metabolite.second});
+    /**
+     * @brief Prints the amounts changed by the last transition, the enzymes are printed
+     * with their location and the metabolites that ran out with amount 0.
+     */
+    static std::ostringstream& printDelta(std::ostringstream& os, const state_type& s) {
+        bool separate = false;
+
+        os << "{";
+        os << "\"model_class\":\"space\",";
+        os << "\"id\":\"" << s.id << "\",";
+        os << "\"delta\":true,";
+        os << "\"enzymes\": [";
+        for(const auto& key : s.changed_enzymes.changed()) {
+            if (separate) {
+                os << ",";
+            }
+            separate = true;
+            os << "{";
+            os << "\"id\":\"" << symbols::enzymes().name(key.first) << "\",";
+            os << "\"location\":\"" << key.second.str() << "\",";
+            os << "\"amount\":" << s.enzymes.at(key).amount;
+            os << "}";
+        }
+        os << "],";
+
+        separate = false;
+        os << "\"metabolites\": [";
+        for(symbols::sid specie : s.changed_metabolites.changed()) {
+            if (separate) {
+                os << ", ";
             }
+            separate = true;
+            auto metabolite = s.metabolites.find(specie);
+            os << "{";
+            os << "\"id\":\"" << symbols::species().name(specie) << "\",";
+            os << "\"amount\":" << (metabolite == s.metabolites.end() ? Integer(0) : metabolite->second);
+            os << "}";
+        }
+
+        os << "]";
+        os << "}";
+
+        return os;
+    }
+
+    void beginChanges() {
+        this->state.changed_metabolites.begin();
+        this->state.changed_enzymes.begin();
+    }
+
+    void touchMetabolites(const MetaboliteAmounts &m) {
+        for (const auto &metabolite : m) {
+            this->state.changed_metabolites.touch(metabolite.first);
         }
     }
 
@@ -650,7 +947,7 @@ private:
      * @param messages The non grouped messages to Unify
      */
     static void mergeMessages(cadmium::bag<Reactant> &messages) {
-        map<string, Reactant> merged_messages;
+        map<symbols::rid, Reactant> merged_messages;
 
         for (auto &product : messages) {
             space::insertMessageMerging(merged_messages, product);
@@ -663,7 +960,30 @@ private:
         }
     }
 
-    static void insertMessageMerging(std::map<string, Reactant>& ms, Reactant &m) {
+    /**
+     * @brief Merges the reactants of each routing table port as mergeMessages does, the merged
+     * reactants are ordered by port.
+     */
+    static void mergeRoutedMessages(cadmium::bag<Routed<Reactant>> &messages) {
+        map<pair<int, symbols::rid>, Routed<Reactant>> merged_messages;
+
+        for (auto &routed : messages) {
+            if (routed.message.reaction_amount <= 0) continue;
+
+            auto inserted = merged_messages.insert({{routed.to, routed.message.rid}, routed});
+            if (!inserted.second) {
+                inserted.first->second.message.reaction_amount += routed.message.reaction_amount;
+            }
+        }
+
+        messages.clear();
+
+        for (auto &merged_product : merged_messages) {
+            messages.emplace_back(merged_product.second);
+        }
+    }
+
+    static void insertMessageMerging(std::map<symbols::rid, Reactant>& ms, Reactant &m) {
 
         if (m.reaction_amount > 0) {
             if (ms.find(m.rid) != ms.end()) {
@@ -675,53 +995,157 @@ private:
     }
 
     /**
-     * @brief Looks if there is metabolites to send and in this case, if the space have
-     * not already programed a selection task to send metabolites, it will program one.
+     * @brief Looks if a free enzyme can bind and in this case, if the space have not
+     * already programed a selection task to send metabolites, it will program one.
+     * @details Otherwise the space waits passive for the products or the released enzymes
+     * that let an enzyme bind again.
      */
     void setNextSelection() {
 
-        if (this->thereIsMetabolites() && !this->thereIsNextSelection()) {
+        if (this->thereIsBindableEnzyme() && !this->thereIsNextSelection()) {
             Task<output_ports> selection_task(Status::SELECTING_FOR_REACTION);
             this->state.tasks.add(this->state.interval_time, selection_task);
         }
     }
 
     /**
-     * @brief Tells if there is or not metabolites in the space.
-     * @return True if there is metabolites in the space.
+     * @brief Indexes the reaction directions of the enzymes by the species they consume
+     * and computes their binding probabilities.
      */
-    bool thereIsMetabolites() const {
+    void buildBindingIndex() {
+        this->bindings.clear();
+        this->enzyme_bindings.clear();
+        this->enzyme_owners.clear();
+        this->bindings_by_species.clear();
 
-        for (const auto &metabolite : this->state.metabolites) {
-            if (metabolite.second > 0) {
-                return true;
+        for (const auto &enzyme : this->state.enzymes) {
+            EnzymeBindings owner{this->bindings.size(), 0, 0, 0.0, 0.0, enzyme.second.amount > 0};
+            this->enzyme_owners.emplace(enzyme.first, this->enzyme_bindings.size());
+
+            for (const auto &reaction : enzyme.second.handled_reactions) {
+                this->addBinding(this->enzyme_bindings.size(), reaction.second, Way::STP);
+                if (reaction.second.reversible) {
+                    this->addBinding(this->enzyme_bindings.size(), reaction.second, Way::PTS);
+                }
             }
+
+            owner.end = this->bindings.size();
+            this->enzyme_bindings.push_back(owner);
+        }
+
+        this->bindable_enzymes = 0;
+        for (size_t index = 0; index < this->bindings.size(); ++index) {
+            this->refreshBinding(index);
         }
-        return false;
+    }
+
+    void addBinding(size_t owner, const ReactionInfo& reaction, Way direction) {
+        const MetaboliteAmounts& sctry = (direction == Way::STP) ? reaction.substrate_sctry : reaction.products_sctry;
+        double kon = (direction == Way::STP) ? reaction.konSTP : reaction.konPTS;
+        if (!this->consumeMetaboliteFromSpace(sctry)) {
+            return;
+        }
+
+        for (const auto &metabolite : sctry) {
+            this->bindings_by_species[metabolite.first].push_back(this->bindings.size());
+        }
+        this->bindings.push_back(Binding{owner, reaction.id, direction, sctry, kon, 0.0});
     }
 
     /**
-     * @brief Looks if there is a selection task already programed.
-     * @return True if there is a selection task, otherwise false.
+     * @brief Updates the binding probabilities that depend on the species of sctry.
      */
-    bool thereIsNextSelection() const {
-        return this->state.tasks.exists(Task<output_ports >(Status::SELECTING_FOR_REACTION));
+    void refreshBindings(const MetaboliteAmounts& sctry) {
+        for (const auto &metabolite : sctry) {
+            this->refreshBindings(metabolite.first);
+        }
     }
 
-    long double sumAll(const map<string, long double> &ons) const {
-        long double result = 0.0;
+    void refreshBindings(symbols::sid specie) {
+        auto dependents = this->bindings_by_species.find(specie);
+        if (dependents == this->bindings_by_species.end()) return;
 
-        for (const auto &on : ons) {
-            result += on.second;
+        for (size_t index : dependents->second) {
+            this->refreshBinding(index);
         }
-        return result;
     }
 
-    void normalize(map<string, long double> &ons, long double total) {
-        for (auto &on : ons) {
-            on.second /= total;
+    void refreshBinding(size_t index) {
+        Binding& binding = this->bindings[index];
+
+        double probability = this->thereAreEnoughToReact(binding.sctry) ? double(this->bindingThreshold(binding.sctry, binding.kon)) : 0.0;
+        if (probability == binding.probability) {
+            return;
+        }
+
+        EnzymeBindings& owner = this->enzyme_bindings[binding.owner];
+        bool was_bindable = isBindable(owner);
+        long double& total = (binding.direction == Way::STP) ? owner.sons : owner.pons;
+        if (binding.probability > 0.0) {
+            --owner.ready;
+            total -= binding.probability;
+        }
+        if (probability > 0.0) {
+            ++owner.ready;
+            total += probability;
+        }
+
+        // Drops the rounding errors of the running totals
+        if (owner.ready == 0) {
+            owner.sons = 0.0;
+            owner.pons = 0.0;
+        }
+        binding.probability = probability;
+        this->countBindable(was_bindable, isBindable(owner));
+    }
+
+    /**
+     * @brief Updates the free flag of the enzyme after its amount changed.
+     */
+    void setFree(size_t index, bool free) {
+        EnzymeBindings& owner = this->enzyme_bindings[index];
+        bool was_bindable = isBindable(owner);
+        owner.free = free;
+        this->countBindable(was_bindable, isBindable(owner));
+    }
+
+    static bool isBindable(const EnzymeBindings& owner) {
+        return owner.free && owner.ready > 0;
+    }
+
+    void countBindable(bool was_bindable, bool bindable) {
+        if (was_bindable != bindable) {
+            bindable ? ++this->bindable_enzymes : --this->bindable_enzymes;
         }
     }
+
+    /**
+     * @brief Recounts the bindable enzymes, used after restoring the bindings from a checkpoint.
+     */
+    void countBindableEnzymes() {
+        this->bindable_enzymes = 0;
+        for (const EnzymeBindings& owner : this->enzyme_bindings) {
+            if (isBindable(owner)) {
+                ++this->bindable_enzymes;
+            }
+        }
+    }
+
+    /**
+     * @brief Tells if a free enzyme has a ready binding, the count is kept by refreshBinding
+     * and setFree.
+     */
+    bool thereIsBindableEnzyme() const {
+        return this->bindable_enzymes > 0;
+    }
+
+    /**
+     * @brief Looks if there is a selection task already programed.
+     * @return True if there is a selection task, otherwise false.
+     */
+    bool thereIsNextSelection() const {
+        return this->state.tasks.exists(Task<output_ports >(Status::SELECTING_FOR_REACTION));
+    }
 };
 
 }
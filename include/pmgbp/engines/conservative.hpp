@@ -0,0 +1,511 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_CONSERVATIVE_HPP
+#define PMGBP_PDEVS_ENGINE_CONSERVATIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <exception>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/ThreadPool.hpp>
+#include <pmgbp/lib/TupleOperators.hpp>
+
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/atomics/compartment.hpp>
+
+#include <pmgbp/engines/partition.hpp>
+#include <pmgbp/engines/state_sink.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Conservative parallel simulation of the compartments (Chandy-Misra-Bryant).
+ * @details Each compartment kernel is a logical process with its own thread. The processes
+ * only exchange the messages of the membrane enzyme sets, through one channel for each pair
+ * of linked compartments. Each channel has a clock: the sender promises that no message
+ * with a lower time (or with the same time, once the clock is closed) will follow. A process
+ * only runs the events whose messages have all arrived, and it sends null messages with the
+ * earliest time it can send a message:
+ *
+ *     min(next internal time, min(next input time, input clocks) + lookahead)
+ *
+ * The lookahead is the compartment minimum delay between an input and an output to another
+ * compartment (TIME_TO_SEND_FOR_REACTION and the enzyme rates), it is always positive. As the
+ * P-DEVS output does not depend on the inputs of the same time, a process sends its output as
+ * soon as all the earlier messages have arrived and then closes its clocks, thus the processes
+ * with simultaneous events never wait for each other. The messages of the same time are merged
+ * by channel in the compartments order, thus the results do not depend on the threads scheduling.
+ * The threads of the shared pool are split among the processes, each one runs the enzyme
+ * transitions of its compartment in its own pool.
+ *
+ * The states of the compartments are written to the sink ordered by time and compartment. Each
+ * process publishes a floor, the earliest time it can still log a state (its next event time or
+ * its input clocks), and the states older than every floor are written while the processes run,
+ * thus the logs only keep the states of the times that are not safe yet. The rest is written at
+ * the end of each run_until.
+ */
+template<class TIME>
+class conservative {
+public:
+
+    using kernel=pmgbp::models::compartment<TIME>;
+    using input_bags=typename kernel::input_bags;
+    using output_bags=typename kernel::output_bags;
+
+    /**
+     * @brief Builds a compartment kernel for each space of the xml file in the path xml_file.
+     *
+     * @param xml_file path where the xml file containing all the parameters is located.
+     * @param sink destination of the states log, a text stream, a trajectory writer or none.
+     */
+    conservative(const std::string& xml_file, state_sink<TIME> sink)
+            : conservative(xml_file, sink, pmgbp::structs::layout::model_layout(ParameterStore::get(xml_file))) {}
+
+    conservative(const std::string& xml_file, state_sink<TIME> sink, const pmgbp::structs::layout::model_layout& layout)
+            : sink(sink), compartments(ParameterStore::get(xml_file), layout) {
+
+        std::size_t threads = std::max<std::size_t>(ThreadPool::shared().size() / std::max<std::size_t>(layout.spaces.size(), 1), 1);
+        for (std::size_t i = 0; i < layout.spaces.size(); ++i) {
+            this->processes.emplace_back(new process(xml_file.c_str(), layout.spaces[i].c_str(), layout, threads));
+        }
+
+        for (std::size_t i = 0; i < this->processes.size(); ++i) {
+            for (std::size_t from : this->compartments.inputs(i)) {
+                this->processes[i]->inputs.push_back(channel{from, {}, horizon{TIME::zero(), false}});
+            }
+            this->processes[i]->promised.assign(this->processes.size(), horizon{TIME::zero(), false});
+        }
+    }
+
+    /**
+     * @brief Runs all the compartments until the time end, it can be called again with a
+     * later time to continue the simulation.
+     */
+    void run_until(const TIME& end) {
+        this->aborted = false;
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(this->processes.size());
+        for (std::size_t id = 0; id < this->processes.size(); ++id) {
+            threads.emplace_back([this, id, &end, &errors]() {
+                ThreadPool::Scope scope(this->processes[id]->pool);
+                try {
+                    this->simulate(*this->processes[id], end);
+                } catch (const stopped&) {
+                    // another compartment failed, its error is rethrown
+                } catch (...) {
+                    errors[id] = std::current_exception();
+                    this->abort();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (std::exception_ptr& error : errors) {
+            if (!error) continue;
+
+            // The states older than the failure are written before reporting it
+            std::lock_guard<std::mutex> lock(this->log_mutex);
+            this->flush_safe();
+            std::rethrow_exception(error);
+        }
+        if (this->log_error) {
+            std::exception_ptr error = this->log_error;
+            this->log_error = nullptr;
+            std::rethrow_exception(error);
+        }
+
+        this->flush();
+    }
+
+    std::size_t size() const {
+        return this->processes.size();
+    }
+
+    /**
+     * @brief Calls f with the state of each compartment model, between the run_until calls.
+     */
+    template<class F>
+    void for_each_state(F f) const {
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            f(lp->model.state);
+        }
+    }
+
+    /**
+     * @brief Calls f with the state of each space, between the run_until calls.
+     */
+    template<class F>
+    void for_each_space(F f) const {
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            f(lp->model.state.space.state);
+        }
+    }
+
+    /**
+     * @brief Writes or reads the state of the compartments and of their channels, between the
+     * run_until calls. It is read over an engine built from the same parameters.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        pmgbp::serialization::expect_size(archive, this->processes.size());
+        for (std::unique_ptr<process>& lp : this->processes) {
+            lp->model.serialize(archive);
+            archive & lp->last_time & lp->promised & lp->sent;
+
+            pmgbp::serialization::expect_size(archive, lp->inputs.size());
+            for (channel& input : lp->inputs) {
+                archive & input.messages & input.clock;
+            }
+        }
+    }
+
+private:
+
+    /**
+     * @brief Channel clock, a closed clock also excludes the messages with its same time.
+     */
+    struct horizon {
+        TIME time;
+        bool closed;
+
+        bool operator<(const horizon& other) const {
+            return this->time < other.time || (this->time == other.time && !this->closed && other.closed);
+        }
+
+        template<class ARCHIVE>
+        void serialize(ARCHIVE& archive) {
+            archive & this->time & this->closed;
+        }
+    };
+
+    struct channel {
+        std::size_t from;
+        std::deque<std::pair<TIME, input_bags>> messages;
+        horizon clock; // no more messages before the clock will arrive
+    };
+
+    /**
+     * @brief A compartment kernel with its channels, only the mutex protects the inputs.
+     */
+    struct process {
+        kernel model;
+        TIME last_time;
+        TIME lookahead;
+        std::vector<horizon> promised; // last clock sent to each process
+        bool sent = false; // the output of the next internal transition was already sent
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::uint64_t version = 0;
+        std::vector<channel> inputs;
+
+        // The logged states not written yet and the earliest time of the following ones,
+        // both protected by the engine log_mutex
+        std::vector<typename state_sink<TIME>::entry> log;
+        TIME floor;
+        ThreadPool pool;
+
+        process(const char* xml_file, const char* cid, const pmgbp::structs::layout::model_layout& layout, std::size_t threads)
+                : model(xml_file, cid, layout), last_time(TIME::zero()), lookahead(model.lookahead()), floor(TIME::zero()), pool(threads) {
+
+            if (!(TIME::zero() < this->lookahead)) {
+                throw std::invalid_argument(std::string("The compartment ") + cid + " has no lookahead, the enzymes rates must be positive");
+            }
+        }
+
+        horizon safe_time() const {
+            horizon result{TIME::infinity(), true};
+            for (const channel& input : this->inputs) {
+                result = std::min(result, input.clock);
+            }
+            return result;
+        }
+
+        TIME next_input_time() const {
+            TIME result = TIME::infinity();
+            for (const channel& input : this->inputs) {
+                if (!input.messages.empty()) {
+                    result = std::min(result, input.messages.front().first);
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Merges the messages of time t of all the channels, in the channels order.
+         */
+        bool take_inputs(const TIME& t, input_bags& bags) {
+            bool result = false;
+            for (channel& input : this->inputs) {
+                while (!input.messages.empty() && input.messages.front().first == t) {
+                    pmgbp::tuple::merge(bags, input.messages.front().second);
+                    input.messages.pop_front();
+                    result = true;
+                }
+            }
+            return result;
+        }
+    };
+
+    struct stopped {};
+
+    // Logged states of a process that trigger the write of the safe states
+    static constexpr std::size_t FLUSH_ENTRIES = 1024;
+
+    state_sink<TIME> sink;
+    partition<TIME> compartments;
+    std::vector<std::unique_ptr<process>> processes;
+
+    std::mutex log_mutex;
+    std::exception_ptr log_error; // first error of the sink while the processes run
+    std::atomic<bool> aborted{false}; // a process failed, the others stop
+
+    channel& input_channel(process& to, std::size_t from) {
+        for (channel& input : to.inputs) {
+            if (input.from == from) {
+                return input;
+            }
+        }
+        throw std::logic_error("There is no channel between the compartments");
+    }
+
+    std::size_t index(const process& lp) const {
+        for (std::size_t i = 0; i < this->processes.size(); ++i) {
+            if (this->processes[i].get() == &lp) {
+                return i;
+            }
+        }
+        throw std::logic_error("Unknown process");
+    }
+
+    void simulate(process& lp, const TIME& end) {
+        std::size_t id = this->index(lp);
+
+        while (true) {
+            if (this->aborted) throw stopped();
+
+            TIME next_internal = lp.last_time + lp.model.time_advance();
+            TIME t;
+            input_bags inputs;
+            bool has_inputs = false;
+
+            std::unique_lock<std::mutex> lock(lp.mutex);
+            while (true) {
+                horizon safe = lp.safe_time();
+                TIME next_input = lp.next_input_time();
+                std::uint64_t version = lp.version;
+                t = std::min(next_internal, next_input);
+                bool output = !lp.sent && next_internal < end && !(next_input < next_internal) && !(safe < horizon{next_internal, false});
+                lock.unlock();
+
+                if (output) {
+                    this->send(id, next_internal, lp.model.output());
+                    lp.sent = true;
+                }
+                if (lp.sent) {
+                    this->promise(id, horizon{next_internal, true});
+                } else {
+                    this->promise(id, horizon{std::min(next_internal, std::min(next_input, safe.time) + lp.lookahead), false});
+                }
+
+                lock.lock();
+                if (t < end && !(safe < horizon{t, true})) {
+                    break;
+                }
+                if (!(t < end) && !(safe < horizon{end, false})) {
+                    this->publish(lp, end);
+                    return;
+                }
+                if (!output) {
+                    this->publish(lp, std::min(t, safe.time));
+                    lp.changed.wait(lock, [this, &lp, version]() { return lp.version != version || this->aborted; });
+                    if (this->aborted) throw stopped();
+                }
+            }
+            has_inputs = lp.take_inputs(t, inputs);
+            lock.unlock();
+
+            if (t == next_internal) {
+                if (!lp.sent) {
+                    this->send(id, t, lp.model.output());
+                }
+                lp.sent = false;
+                if (has_inputs) {
+                    lp.model.confluence_transition(t - lp.last_time, inputs);
+                } else {
+                    lp.model.internal_transition();
+                }
+            } else {
+                lp.model.external_transition(t - lp.last_time, inputs);
+            }
+            lp.last_time = t;
+
+            if (this->sink.enabled()) {
+                typename state_sink<TIME>::entry logged = this->sink.compartment(t, lp.model);
+                std::lock_guard<std::mutex> lock(this->log_mutex);
+                lp.log.push_back(std::move(logged));
+                lp.floor = t;
+                if (lp.log.size() >= FLUSH_ENTRIES) {
+                    this->flush_safe();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Stops all the processes after one of them failed, waking the ones waiting for
+     * their channels.
+     */
+    void abort() {
+        this->aborted = true;
+        for (std::unique_ptr<process>& lp : this->processes) {
+            {
+                std::lock_guard<std::mutex> lock(lp->mutex);
+                ++lp->version;
+            }
+            lp->changed.notify_all();
+        }
+    }
+
+    /**
+     * @brief Sets the earliest time of the states the process can still log.
+     */
+    void publish(process& lp, const TIME& floor) {
+        if (this->sink.enabled()) {
+            std::lock_guard<std::mutex> lock(this->log_mutex);
+            lp.floor = floor;
+        }
+    }
+
+    /**
+     * @brief Writes the logged states older than the floors of all the processes, the caller
+     * holds the log_mutex. The errors of the sink are rethrown by run_until.
+     */
+    void flush_safe() {
+        if (this->log_error) {
+            return;
+        }
+
+        TIME safe = TIME::infinity();
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            safe = std::min(safe, lp->floor);
+        }
+
+        std::vector<std::vector<typename state_sink<TIME>::entry>> ready(this->processes.size());
+        std::vector<const std::vector<typename state_sink<TIME>::entry>*> logs;
+        for (std::size_t i = 0; i < this->processes.size(); ++i) {
+            std::vector<typename state_sink<TIME>::entry>& log = this->processes[i]->log;
+            auto last = std::find_if(log.begin(), log.end(), [&safe](const auto& logged) { return !(logged.time < safe); });
+            ready[i].assign(std::make_move_iterator(log.begin()), std::make_move_iterator(last));
+            log.erase(log.begin(), last);
+            logs.push_back(&ready[i]);
+        }
+
+        try {
+            this->sink.write(logs);
+        } catch (...) {
+            this->log_error = std::current_exception();
+        }
+    }
+
+    /**
+     * @brief Sends the messages of the compartment id at time t to the destination compartments.
+     */
+    void send(std::size_t id, const TIME& t, const output_bags& bags) {
+        std::map<std::size_t, input_bags> messages = this->compartments.messages(bags);
+
+        for (auto& message : messages) {
+            process& to = *this->processes[message.first];
+            {
+                std::lock_guard<std::mutex> lock(to.mutex);
+                this->input_channel(to, id).messages.emplace_back(t, std::move(message.second));
+                ++to.version;
+            }
+            to.changed.notify_one();
+        }
+    }
+
+    /**
+     * @brief Sends a null message, no message with a lower time will leave the compartment id.
+     */
+    void promise(std::size_t id, const horizon& time) {
+        process& lp = *this->processes[id];
+
+        for (std::size_t to_id : this->compartments.outputs(id)) {
+            if (!(lp.promised[to_id] < time)) continue;
+            lp.promised[to_id] = time;
+
+            process& to = *this->processes[to_id];
+            {
+                std::lock_guard<std::mutex> lock(to.mutex);
+                channel& input = this->input_channel(to, id);
+                input.clock = std::max(input.clock, time);
+                ++to.version;
+            }
+            to.changed.notify_one();
+        }
+    }
+
+    /**
+     * @brief Writes the states logged by all the compartments ordered by time.
+     */
+    void flush() {
+        std::vector<const std::vector<typename state_sink<TIME>::entry>*> logs;
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            logs.push_back(&lp->log);
+        }
+        this->sink.write(logs);
+
+        for (std::unique_ptr<process>& lp : this->processes) {
+            lp->log.clear();
+        }
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_CONSERVATIVE_HPP
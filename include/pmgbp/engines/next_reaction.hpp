@@ -0,0 +1,458 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_NEXT_REACTION_HPP
+#define PMGBP_PDEVS_ENGINE_NEXT_REACTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+
+#include <tinyxml2.h>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Random.hpp>
+#include <pmgbp/lib/IndexedPriorityQueue.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/TimeText.hpp>
+
+#include <pmgbp/structures/types.hpp>
+#include <pmgbp/structures/symbols.hpp>
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/model_generator/generic_space.hpp>
+
+#include <pmgbp/engines/state_sink.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Exact stochastic simulation of the parameters with the next reaction method (Gibson and Bruck).
+ * @details The reaction channels are the directions of the reactions handled by each enzyme entry
+ * of the spaces. A channel belongs to the entry of the first space its direction consumes from, and
+ * firing it consumes the substrates and adds the products of all the spaces of its stoichiometry.
+ *
+ * The propensities are the mean turnover of the enzyme cycle of the P-DEVS models instead of the
+ * polling itself. Each interval a free enzyme binds the channel i with the space binding probability
+ * p_i (normalized if they add up more than one), and it is busy (1 - koff_i) rate_i + koff_i rejectRate_i
+ * until it is released. Thus the amount E of enzymes of the entry fires the channel j with propensity
+ *
+ *     E (1 - koff_j) p_j / (interval + sum_i(p_i busy_i))
+ *
+ * and all the channels of an entry depend on the substrates of each other.
+ *
+ * Each channel keeps its absolute next firing time in an indexed priority queue. After a firing,
+ * only the channels of the entries whose substrates changed (the dependency graph) are updated,
+ * reusing their waiting time scaled by the ratio of the propensities, thus a step draws a single
+ * random number.
+ *
+ * The states of the spaces changed by each firing are written to the sink, as text with the same
+ * space state of the P-DEVS models or as trajectory records. Only the metabolites are written, the
+ * propensities use the mean enzyme cycle instead of binding and releasing each enzyme, thus there
+ * are no free enzyme amounts to compare with the P-DEVS models and the spaces are left without
+ * enzymes.
+ */
+template<class TIME>
+class next_reaction {
+public:
+
+    using space_model=generic_space<TIME>;
+    using Integer=pmgbp::types::Integer;
+
+    next_reaction(const std::string& xml_file, state_sink<TIME> sink) : sink(sink) {
+        const ParameterStore& parameters = ParameterStore::get(xml_file);
+        pmgbp::structs::layout::model_layout layout(parameters);
+
+        for (const std::string& cid : layout.spaces) {
+            this->space_index.insert({cid, this->spaces.size()});
+            this->spaces.emplace_back(xml_file.c_str(), cid.c_str());
+        }
+
+        for (const std::string& cid : layout.spaces) {
+            const tinyxml2::XMLElement* space_parameters = parameters.space(cid);
+            const tinyxml2::XMLElement* enzymes = space_parameters->FirstChildElement("enzymes");
+            if (enzymes == nullptr) continue;
+
+            double interval = pmgbp::time_text::seconds(space_parameters->FirstChildElement("intervalTime")->GetText());
+            for (const tinyxml2::XMLElement* entry = enzymes->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+                this->add_entry(parameters, this->space_index.at(cid), interval, entry);
+            }
+        }
+
+        this->build_dependencies();
+
+        // The entries keep the enzyme amounts
+        for (space_model& space : this->spaces) {
+            space.state.enzymes.clear();
+        }
+
+        this->random.seed(RandomSeed::stream("NextReaction"));
+        std::vector<double> times(this->channels.size(), std::numeric_limits<double>::infinity());
+        for (std::size_t index = 0; index < this->entries.size(); ++index) {
+            this->update_propensities(this->entries[index]);
+        }
+        for (std::size_t index = 0; index < this->channels.size(); ++index) {
+            if (this->channels[index].propensity > 0) {
+                times[index] = this->random.drawExponential(this->channels[index].propensity);
+            }
+        }
+        this->queue = IndexedPriorityQueue<double>(times);
+    }
+
+    /**
+     * @brief Fires the reactions until the time end, it can be called again with a later
+     * time to continue the simulation.
+     */
+    void run_until(const TIME& end) {
+        while (!this->queue.empty()) {
+            std::size_t index = this->queue.top();
+            double now = this->queue.key(index);
+            if (std::isinf(now)) break;
+
+            TIME time = to_time(now);
+            if (!(time < end)) break;
+
+            this->fire(index, now);
+            ++this->fired_reactions;
+
+            if (this->sink.enabled()) {
+                for (std::size_t space : this->channels[index].spaces) {
+                    this->sink.write(this->sink.space(time, this->spaces[space].state));
+                }
+            }
+        }
+    }
+
+    std::size_t size() const {
+        return this->spaces.size();
+    }
+
+    /**
+     * @brief Calls f with the state of each space model, between the run_until calls.
+     */
+    template<class F>
+    void for_each_state(F f) const {
+        for (const space_model& space : this->spaces) {
+            f(space.state);
+        }
+    }
+
+    /**
+     * @brief Calls f with the state of each space, between the run_until calls.
+     */
+    template<class F>
+    void for_each_space(F f) const {
+        for (const space_model& space : this->spaces) {
+            f(space.state);
+        }
+    }
+
+    std::size_t channel_amount() const {
+        return this->channels.size();
+    }
+
+    uint64_t fired() const {
+        return this->fired_reactions;
+    }
+
+    /**
+     * @brief Writes or reads the amounts of the spaces, the propensities and the firing times
+     * of the channels, between the run_until calls. It is read over an engine built from
+     * the same parameters.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        pmgbp::serialization::expect_size(archive, this->spaces.size());
+        for (space_model& space : this->spaces) {
+            space.serialize(archive);
+        }
+        pmgbp::serialization::expect_size(archive, this->channels.size());
+        for (channel& current : this->channels) {
+            archive & current.binding & current.propensity;
+        }
+        archive & this->queue & this->random & this->fired_reactions;
+    }
+
+private:
+
+    struct term {
+        std::size_t species;
+        Integer amount;
+    };
+
+    struct channel {
+        std::size_t entry;
+        double kon;
+        double koff;
+        double busy; // mean seconds the enzyme is bound
+        std::vector<term> substrates;
+        std::vector<std::pair<std::size_t, long long>> changes; // species -> net amount change
+        std::vector<std::size_t> spaces; // spaces changed by firing
+        double binding = 0;
+        double propensity = 0;
+    };
+
+    struct entry {
+        Integer amount;
+        double interval; // seconds between the space selections
+        std::vector<std::size_t> channels;
+        std::vector<std::size_t> dependents; // entries to update after firing one of its channels, itself included
+    };
+
+    state_sink<TIME> sink;
+    std::vector<space_model> spaces;
+    std::map<std::string, std::size_t> space_index;
+    std::vector<std::pair<std::size_t, pmgbp::symbols::sid>> species; // (space, specie)
+    std::map<std::pair<std::size_t, pmgbp::symbols::sid>, std::size_t> species_index;
+    std::vector<entry> entries;
+    std::vector<channel> channels;
+    IndexedPriorityQueue<double> queue;
+    RealRandom<double> random;
+    uint64_t fired_reactions = 0;
+
+    /**
+     * @brief Converts the seconds of a firing to the simulation time, rounded to nanoseconds.
+     */
+    static TIME to_time(double seconds) {
+        long long rest = std::llround(seconds * 1e9);
+        int nanoseconds = int(rest % 1000); rest /= 1000;
+        int microseconds = int(rest % 1000); rest /= 1000;
+        int milliseconds = int(rest % 1000); rest /= 1000;
+        int secs = int(rest % 60); rest /= 60;
+        int minutes = int(rest % 60); rest /= 60;
+        return TIME({int(rest), minutes, secs, milliseconds, microseconds, nanoseconds});
+    }
+
+    std::size_t specie(std::size_t space, const char* id) {
+        std::pair<std::size_t, pmgbp::symbols::sid> key(space, pmgbp::symbols::species().intern(id));
+        auto inserted = this->species_index.insert({key, this->species.size()});
+        if (inserted.second) {
+            this->species.push_back(key);
+        }
+        return inserted.first->second;
+    }
+
+    void add_entry(const ParameterStore& parameters, std::size_t space, double interval, const tinyxml2::XMLElement* xml) {
+        const tinyxml2::XMLElement* reactions = xml->FirstChildElement("reactions");
+        Integer amount = Integer(std::stoi(xml->Attribute("amount")));
+        if (amount == 0 || reactions == nullptr) return;
+
+        entry result;
+        result.amount = amount;
+        result.interval = interval;
+        std::size_t index = this->entries.size();
+
+        for (const tinyxml2::XMLElement* reaction = reactions->FirstChildElement(); reaction != nullptr; reaction = reaction->NextSiblingElement()) {
+            std::string rid = reaction->Attribute("id");
+            if (!parameters.has_reaction(rid)) continue;
+
+            const tinyxml2::XMLElement* reaction_parameters = parameters.reaction(rid);
+            this->add_channel(reaction_parameters, index, space, pmgbp::types::Way::STP, result.channels);
+            if (ParameterStore::is_true(reaction_parameters->FirstChildElement("reversible"))) {
+                this->add_channel(reaction_parameters, index, space, pmgbp::types::Way::PTS, result.channels);
+            }
+        }
+
+        if (!result.channels.empty()) {
+            this->entries.push_back(std::move(result));
+        }
+    }
+
+    /**
+     * @brief Adds the channel of the reaction direction way to the entry, if the
+     * direction consumes from the space before any other space.
+     */
+    void add_channel(const tinyxml2::XMLElement* reaction, std::size_t entry, std::size_t space, pmgbp::types::Way way, std::vector<std::size_t>& entry_channels) {
+        const bool stp = way == pmgbp::types::Way::STP;
+        const char* consumed = stp ? "substrate" : "product";
+        const char* produced = stp ? "product" : "substrate";
+
+        channel result;
+        result.entry = entry;
+        result.kon = std::stod(reaction->FirstChildElement(stp ? "konSTP" : "konPTS")->GetText());
+        result.koff = std::stod(reaction->FirstChildElement(stp ? "koffSTP" : "koffPTS")->GetText());
+        result.busy = (1.0 - result.koff) * pmgbp::time_text::seconds(reaction->FirstChildElement("rate")->GetText())
+                      + result.koff * pmgbp::time_text::seconds(reaction->FirstChildElement("rejectRate")->GetText());
+
+        std::map<std::size_t, long long> changes;
+        const tinyxml2::XMLElement* compartments = reaction->FirstChildElement("stoichiometryByCompartments");
+        for (const tinyxml2::XMLElement* compartment = compartments->FirstChildElement(); compartment != nullptr; compartment = compartment->NextSiblingElement()) {
+            auto found = this->space_index.find(compartment->Attribute("cid"));
+            const tinyxml2::XMLElement* substrate = compartment->FirstChildElement(consumed);
+            const tinyxml2::XMLElement* product = compartment->FirstChildElement(produced);
+            bool consumes = substrate != nullptr && substrate->FirstChildElement() != nullptr;
+
+            // The metabolites of the compartments without space never reach the enzyme
+            if (found == this->space_index.end()) {
+                if (consumes) return;
+                continue;
+            }
+
+            if (consumes) {
+                if (result.substrates.empty() && found->second != space) return;
+
+                for (const tinyxml2::XMLElement* s = substrate->FirstChildElement(); s != nullptr; s = s->NextSiblingElement()) {
+                    std::size_t index = this->specie(found->second, s->Attribute("id"));
+                    Integer stoichiometry = Integer(std::stoi(s->Attribute("amount")));
+                    result.substrates.push_back({index, stoichiometry});
+                    changes[index] -= (long long) stoichiometry;
+                }
+            }
+            if (product != nullptr) {
+                for (const tinyxml2::XMLElement* s = product->FirstChildElement(); s != nullptr; s = s->NextSiblingElement()) {
+                    std::size_t index = this->specie(found->second, s->Attribute("id"));
+                    changes[index] += (long long) std::stoi(s->Attribute("amount"));
+                }
+            }
+        }
+
+        if (result.substrates.empty()) return;
+
+        for (const auto& change : changes) {
+            if (change.second == 0) continue;
+            result.changes.push_back(change);
+            result.spaces.push_back(this->species[change.first].first);
+        }
+        std::sort(result.spaces.begin(), result.spaces.end());
+        result.spaces.erase(std::unique(result.spaces.begin(), result.spaces.end()), result.spaces.end());
+
+        entry_channels.push_back(this->channels.size());
+        this->channels.push_back(std::move(result));
+    }
+
+    void build_dependencies() {
+        std::vector<std::vector<std::size_t>> consumers(this->species.size());
+        for (std::size_t index = 0; index < this->channels.size(); ++index) {
+            for (const term& substrate : this->channels[index].substrates) {
+                consumers[substrate.species].push_back(this->channels[index].entry);
+            }
+        }
+
+        for (std::size_t index = 0; index < this->entries.size(); ++index) {
+            entry& current = this->entries[index];
+            current.dependents.push_back(index);
+            for (std::size_t channel_index : current.channels) {
+                for (const auto& change : this->channels[channel_index].changes) {
+                    current.dependents.insert(current.dependents.end(), consumers[change.first].begin(), consumers[change.first].end());
+                }
+            }
+            std::sort(current.dependents.begin(), current.dependents.end());
+            current.dependents.erase(std::unique(current.dependents.begin(), current.dependents.end()), current.dependents.end());
+        }
+    }
+
+    Integer amount(std::size_t index) const {
+        const auto& metabolites = this->spaces[this->species[index].first].state.metabolites;
+        auto it = metabolites.find(this->species[index].second);
+        return it == metabolites.end() ? 0 : it->second;
+    }
+
+    /**
+     * @brief Binding probability of the space selection, zero if there are not enough
+     * metabolites to react once.
+     */
+    double binding(const channel& current) const {
+        long double concentration = 1.0;
+        for (const term& substrate : current.substrates) {
+            Integer available = this->amount(substrate.species);
+            if (available < substrate.amount) return 0.0;
+
+            concentration *= available / (pmgbp::types::L * this->spaces[this->species[substrate.species].first].state.volume);
+        }
+        return double(std::exp(-(1.0L / (concentration * current.kon))));
+    }
+
+    void update_propensities(const entry& current) {
+        double total = 0;
+        for (std::size_t index : current.channels) {
+            this->channels[index].binding = this->binding(this->channels[index]);
+            total += this->channels[index].binding;
+        }
+
+        double normalization = total > 1.0 ? total : 1.0;
+        double cycle = current.interval;
+        for (std::size_t index : current.channels) {
+            cycle += this->channels[index].binding / normalization * this->channels[index].busy;
+        }
+
+        for (std::size_t index : current.channels) {
+            channel& c = this->channels[index];
+            c.propensity = cycle > 0 ? current.amount * (1.0 - c.koff) * (c.binding / normalization) / cycle : 0.0;
+        }
+    }
+
+    void fire(std::size_t index, double now) {
+        const channel& fired = this->channels[index];
+        for (std::size_t space : fired.spaces) {
+            this->spaces[space].state.changed_metabolites.begin();
+            this->spaces[space].state.changed_enzymes.begin();
+        }
+        for (const auto& change : fired.changes) {
+            const auto& key = this->species[change.first];
+            Integer& amount = this->spaces[key.first].state.metabolites[key.second];
+            amount = Integer((long long) amount + change.second);
+            this->spaces[key.first].state.changed_metabolites.touch(key.second);
+        }
+
+        for (std::size_t dependent : this->entries[fired.entry].dependents) {
+            const entry& current = this->entries[dependent];
+
+            std::vector<double> previous;
+            for (std::size_t channel_index : current.channels) {
+                previous.push_back(this->channels[channel_index].propensity);
+            }
+            this->update_propensities(current);
+
+            for (std::size_t i = 0; i < current.channels.size(); ++i) {
+                std::size_t channel_index = current.channels[i];
+                double propensity = this->channels[channel_index].propensity;
+                double scheduled = this->queue.key(channel_index);
+
+                double next = std::numeric_limits<double>::infinity();
+                if (propensity > 0) {
+                    if (channel_index != index && previous[i] > 0 && !std::isinf(scheduled)) {
+                        next = now + (previous[i] / propensity) * (scheduled - now);
+                    } else {
+                        next = now + this->random.drawExponential(propensity);
+                    }
+                }
+                this->queue.update(channel_index, next);
+            }
+        }
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_NEXT_REACTION_HPP
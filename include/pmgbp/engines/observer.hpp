@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_OBSERVER_HPP
+#define PMGBP_PDEVS_ENGINE_OBSERVER_HPP
+
+#include <cstddef>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <utility>
+#include <stdexcept>
+
+#include <pmgbp/structures/types.hpp>
+#include <pmgbp/structures/symbols.hpp>
+#include <pmgbp/structures/space.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Samples the metabolite and free enzyme amounts of the spaces as a csv time series.
+ * @details Each sample is a row with the time followed by one column per compartment and
+ * species, named "compartment:species", and per compartment and enzyme, named
+ * "compartment:enzyme@location". The columns are the entries of the spaces in the first
+ * sample, the parameters list all the species of each compartment and the spaces never
+ * remove them.
+ *
+ * The runner calls add with the state of each space and then write with the sample time.
+ */
+template<class TIME>
+class observer {
+public:
+
+    explicit observer(const std::string& path) : file(path) {
+        if (!this->file) {
+            throw std::runtime_error("Unable to open the sample file " + path);
+        }
+    }
+
+    observer(const observer&) = delete;
+    observer& operator=(const observer&) = delete;
+
+    /**
+     * @brief Adds the amounts of the space to the current sample.
+     */
+    template<class SPACE_STATE>
+    void add(const SPACE_STATE& state) {
+        auto found = this->spaces.find(state.compartment);
+        if (found == this->spaces.end()) {
+            if (this->samples > 0) {
+                throw std::runtime_error("The space " + state.id + " was not in the first sample");
+            }
+            found = this->spaces.insert({state.compartment, this->new_columns(state)}).first;
+        }
+
+        const columns& space = found->second;
+        std::size_t column = space.offset;
+        for (pmgbp::symbols::sid specie : space.metabolites) {
+            auto metabolite = state.metabolites.find(specie);
+            this->row[column++] = (metabolite == state.metabolites.end()) ? pmgbp::types::Integer(0) : metabolite->second;
+        }
+        for (const auto& key : space.enzymes) {
+            auto enzyme = state.enzymes.find(key);
+            this->row[column++] = (enzyme == state.enzymes.end()) ? pmgbp::types::Integer(0) : enzyme->second.amount;
+        }
+    }
+
+    /**
+     * @brief Writes the current sample at time, the header is written with the first one.
+     */
+    void write(const TIME& time) {
+        if (this->samples == 0) {
+            this->file << "time";
+            for (const std::string& name : this->names) {
+                this->file << "," << name;
+            }
+            this->file << "\n";
+        }
+
+        this->file << time;
+        for (const pmgbp::types::Integer& value : this->row) {
+            this->file << "," << value;
+        }
+        this->file << "\n";
+        this->file.flush();
+        if (!this->file) {
+            throw std::runtime_error("Unable to write the sample file");
+        }
+        ++this->samples;
+    }
+
+    std::size_t size() const {
+        return this->samples;
+    }
+
+private:
+
+    // Columns of a space in the order they are written
+    struct columns {
+        std::size_t offset;
+        std::vector<pmgbp::symbols::sid> metabolites;
+        std::vector<std::pair<pmgbp::symbols::eid, pmgbp::structs::space::EnzymeAddress>> enzymes;
+    };
+
+    std::ofstream file;
+    std::size_t samples = 0;
+    std::map<pmgbp::symbols::cid, columns> spaces;
+    std::vector<std::string> names;
+    std::vector<pmgbp::types::Integer> row;
+
+    template<class SPACE_STATE>
+    columns new_columns(const SPACE_STATE& state) {
+        columns result;
+        result.offset = this->names.size();
+
+        for (const auto& metabolite : state.metabolites) {
+            result.metabolites.push_back(metabolite.first);
+            this->names.push_back(state.id + ":" + pmgbp::symbols::species().name(metabolite.first));
+        }
+        for (const auto& enzyme : state.enzymes) {
+            result.enzymes.push_back(enzyme.first);
+            this->names.push_back(state.id + ":" + pmgbp::symbols::enzymes().name(enzyme.first.first) + "@" + enzyme.first.second.str());
+        }
+
+        this->row.resize(this->names.size());
+        return result;
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_OBSERVER_HPP
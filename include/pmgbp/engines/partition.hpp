@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_PARTITION_HPP
+#define PMGBP_PDEVS_ENGINE_PARTITION_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/atomics/compartment.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Partition of a model in one compartment kernel per space, as used by the parallel engines.
+ * @details It keeps which compartments exchange messages (the membrane enzyme sets) and routes
+ * the outputs of a kernel to the inputs of the kernels of the other compartments. The
+ * compartments are numbered in the order of the layout spaces.
+ */
+template<class TIME>
+class partition {
+public:
+
+    using kernel=pmgbp::models::compartment<TIME>;
+    using input_bags=typename kernel::input_bags;
+    using output_bags=typename kernel::output_bags;
+
+    partition(const ParameterStore& parameters, const pmgbp::structs::layout::model_layout& layout)
+            : destinations(layout.spaces.size()),
+              sources(layout.spaces.size()) {
+
+        // Reactants for the enzyme sets of other compartments
+        for (const auto& link : layout.space_links) {
+            const std::string& cid = std::get<2>(link).first;
+            if (std::get<0>(link) == cid || !parameters.has_space(cid)) continue;
+
+            this->link(layout.compartment_index(std::get<0>(link)), layout.compartment_index(cid));
+        }
+
+        // Products and information for the spaces of other compartments
+        for (const auto& enzyme_set : layout.enzyme_set_links) {
+            const std::string& cid = enzyme_set.first.first;
+            if (!parameters.has_space(cid)) continue;
+
+            for (const auto& link : enzyme_set.second) {
+                if (link.second == cid || !parameters.has_space(link.second)) continue;
+                this->link(layout.compartment_index(cid), layout.compartment_index(link.second));
+            }
+        }
+
+        for (std::size_t i = 0; i < this->destinations.size(); ++i) {
+            std::sort(this->destinations[i].begin(), this->destinations[i].end());
+            std::sort(this->sources[i].begin(), this->sources[i].end());
+        }
+    }
+
+    std::size_t size() const {
+        return this->destinations.size();
+    }
+
+    /**
+     * @brief Compartments the compartment from sends messages to, in increasing order.
+     */
+    const std::vector<std::size_t>& outputs(std::size_t from) const {
+        return this->destinations[from];
+    }
+
+    /**
+     * @brief Compartments the compartment to receives messages from, in increasing order.
+     */
+    const std::vector<std::size_t>& inputs(std::size_t to) const {
+        return this->sources[to];
+    }
+
+    /**
+     * @brief Splits the outputs of a compartment in the input bags of each destination, the
+     * kernels have already routed them.
+     */
+    std::map<std::size_t, input_bags> messages(const output_bags& bags) const {
+        std::map<std::size_t, input_bags> result;
+
+        for (const auto& routed : cadmium::get_messages<typename ports::out_reactant>(bags)) {
+            cadmium::get_messages<typename ports::in_reactant>(result[routed.to]).push_back(routed);
+        }
+        for (const auto& routed : cadmium::get_messages<typename ports::out_product>(bags)) {
+            cadmium::get_messages<typename ports::in_product>(result[routed.to]).push_back(routed);
+        }
+        for (const auto& routed : cadmium::get_messages<typename ports::out_information>(bags)) {
+            cadmium::get_messages<typename ports::in_information>(result[routed.to]).push_back(routed);
+        }
+
+        return result;
+    }
+
+private:
+
+    using ports=pmgbp::models::compartment_ports;
+
+    std::vector<std::vector<std::size_t>> destinations;
+    std::vector<std::vector<std::size_t>> sources;
+
+    void link(std::size_t from, std::size_t to) {
+        if (std::find(this->destinations[from].begin(), this->destinations[from].end(), to) != this->destinations[from].end()) {
+            return;
+        }
+        this->destinations[from].push_back(to);
+        this->sources[to].push_back(from);
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_PARTITION_HPP
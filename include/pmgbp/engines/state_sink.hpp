@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_STATE_SINK_HPP
+#define PMGBP_PDEVS_ENGINE_STATE_SINK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <ostream>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+#include <pmgbp/lib/Trajectory.hpp>
+#include <pmgbp/lib/TimeText.hpp>
+
+#include <pmgbp/structures/types.hpp>
+#include <pmgbp/structures/symbols.hpp>
+#include <pmgbp/structures/space.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Destination of the states logged by the engines.
+ * @details The text sink writes the json states as "time state" lines. The binary sink writes
+ * the metabolite and free enzyme amounts of the spaces as trajectory records, the enzymes are
+ * named by their id and location as "id@compartment_enzymeset". With the delta logging only
+ * the amounts changed by each transition are written between the keyframes. The states are converted to
+ * entries by the thread of each compartment and written together by write.
+ */
+template<class TIME>
+class state_sink {
+public:
+
+    struct amount {
+        pmgbp::symbols::id_type id; // metabolite or enzyme
+        bool enzyme;
+        pmgbp::structs::space::EnzymeAddress location; // only for the enzymes
+        pmgbp::types::Integer value;
+    };
+
+    struct entry {
+        TIME time;
+        std::string text;
+        pmgbp::symbols::cid model;
+        std::vector<amount> amounts;
+    };
+
+    /**
+     * @brief Sink that discards the states, the engines don't log when it is not enabled.
+     */
+    state_sink() = default;
+
+    state_sink(std::ostream& text) : text(&text) {}
+
+    state_sink(pmgbp::trajectory::writer& binary) : binary(&binary) {}
+
+    bool enabled() const {
+        return this->text != nullptr || this->binary != nullptr;
+    }
+
+    /**
+     * @brief Entry of the compartment model state, only its space amounts are logged
+     * in the binary sink.
+     */
+    template<class COMPARTMENT>
+    entry compartment(const TIME& time, const COMPARTMENT& model) const {
+        entry result{time, std::string(), 0, {}};
+        if (this->binary == nullptr) {
+            std::ostringstream state;
+            state << model.state;
+            result.text = state.str();
+        } else if (model.state.last_times[COMPARTMENT::SPACE] == model.state.current_time) {
+            // the space had a transition in the last step
+            state_sink::space_amounts(model.state.space.state, result);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Entry of the space model state.
+     */
+    template<class SPACE_STATE>
+    entry space(const TIME& time, const SPACE_STATE& state) const {
+        entry result{time, std::string(), 0, {}};
+        if (this->binary == nullptr) {
+            std::ostringstream text;
+            text << state;
+            result.text = text.str();
+        } else {
+            state_sink::space_amounts(state, result);
+        }
+        return result;
+    }
+
+    void write(const entry& logged) {
+        if (this->binary == nullptr) {
+            *this->text << logged.time << " " << logged.text << std::endl;
+            return;
+        }
+
+        int64_t time = this->nanoseconds(logged.time);
+        uint32_t model = this->model_id(logged.model);
+        for (const amount& current : logged.amounts) {
+            this->binary->append(time, model, this->species_id(current), int64_t(current.value));
+        }
+    }
+
+    /**
+     * @brief Writes the entries logged by each compartment ordered by time and compartment.
+     */
+    void write(const std::vector<const std::vector<entry>*>& logs) {
+        std::vector<std::pair<std::size_t, const entry*>> entries;
+        for (std::size_t i = 0; i < logs.size(); ++i) {
+            for (const entry& logged : *logs[i]) {
+                entries.emplace_back(i, &logged);
+            }
+        }
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& l, const auto& r) {
+            return l.second->time < r.second->time || (l.second->time == r.second->time && l.first < r.first);
+        });
+
+        for (const auto& logged : entries) {
+            this->write(*logged.second);
+        }
+    }
+
+private:
+    std::ostream* text = nullptr;
+    pmgbp::trajectory::writer* binary = nullptr;
+
+    // Dictionary ids of the trajectory
+    std::map<pmgbp::symbols::cid, uint32_t> models;
+    std::map<std::tuple<bool, pmgbp::symbols::id_type, pmgbp::symbols::cid, pmgbp::symbols::esn>, uint32_t> species;
+
+    // The last converted time, the entries come ordered
+    TIME last_time;
+    int64_t last_nanoseconds = -1;
+
+    /**
+     * @brief Amounts of the space, only the ones changed by the last transition if its
+     * state is a delta.
+     */
+    template<class SPACE_STATE>
+    static void space_amounts(const SPACE_STATE& state, entry& result) {
+        result.model = state.compartment;
+        if (!state.changed_metabolites.keyframe()) {
+            for (pmgbp::symbols::sid specie : state.changed_metabolites.changed()) {
+                auto metabolite = state.metabolites.find(specie);
+                pmgbp::types::Integer value = metabolite == state.metabolites.end() ? pmgbp::types::Integer(0) : metabolite->second;
+                result.amounts.push_back(amount{specie, false, pmgbp::structs::space::EnzymeAddress(), value});
+            }
+            for (const auto& key : state.changed_enzymes.changed()) {
+                result.amounts.push_back(amount{key.first, true, key.second, state.enzymes.at(key).amount});
+            }
+            return;
+        }
+
+        result.amounts.reserve(state.metabolites.size() + state.enzymes.size());
+        for (const auto& metabolite : state.metabolites) {
+            result.amounts.push_back(amount{metabolite.first, false, pmgbp::structs::space::EnzymeAddress(), metabolite.second});
+        }
+        for (const auto& enzyme : state.enzymes) {
+            result.amounts.push_back(amount{enzyme.first.first, true, enzyme.first.second, enzyme.second.amount});
+        }
+    }
+
+    uint32_t model_id(pmgbp::symbols::cid model) {
+        auto found = this->models.find(model);
+        if (found == this->models.end()) {
+            found = this->models.insert({model, this->binary->model(pmgbp::symbols::compartments().name(model))}).first;
+        }
+        return found->second;
+    }
+
+    uint32_t species_id(const amount& current) {
+        auto key = std::make_tuple(current.enzyme, current.id, current.location.compartment, current.location.reaction_set);
+        auto found = this->species.find(key);
+        if (found == this->species.end()) {
+            std::string name;
+            if (current.enzyme) {
+                name = pmgbp::symbols::enzymes().name(current.id) + "@" + current.location.str();
+            } else {
+                name = pmgbp::symbols::species().name(current.id);
+            }
+            found = this->species.insert({key, this->binary->species(name)}).first;
+        }
+        return found->second;
+    }
+
+    /**
+     * @brief Nanoseconds of the time, read from its hh:mm:ss:ms:us:ns text.
+     */
+    int64_t nanoseconds(const TIME& time) {
+        if (this->last_nanoseconds >= 0 && time == this->last_time) {
+            return this->last_nanoseconds;
+        }
+
+        std::ostringstream text;
+        text << time;
+        int64_t result = pmgbp::time_text::nanoseconds(text.str());
+
+        this->last_time = time;
+        this->last_nanoseconds = result;
+        return result;
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_STATE_SINK_HPP
@@ -0,0 +1,666 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_TIME_WARP_HPP
+#define PMGBP_PDEVS_ENGINE_TIME_WARP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/TupleOperators.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/ThreadPool.hpp>
+
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/atomics/compartment.hpp>
+
+#include <pmgbp/engines/partition.hpp>
+#include <pmgbp/engines/state_sink.hpp>
+#include <pmgbp/engines/transport.hpp>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Optimistic parallel simulation of the compartments (Time Warp).
+ * @details Each compartment kernel is a logical process with its own thread that runs its
+ * events as soon as it has them, without waiting for the other compartments. When a message
+ * arrives with a time already simulated (a straggler) the process rolls back: it restores the
+ * state before the message, sends anti-messages that cancel the messages it
+ * sent after that time and undoes the events in between. An anti-message of a message already
+ * used rolls back the receiver in the same way.
+ * The messages sent at the time of the straggler are kept, as the P-DEVS output of a time only
+ * depends on the previous events, otherwise two compartments exchanging messages at the same
+ * time would roll back each other forever.
+ *
+ * The states are saved incrementally: each event keeps the previous state of the sub models
+ * (the space and the enzyme sets) it changed, only those with a transition at its time, and a
+ * rollback restores them undoing the events from the last one. The sub models are the smallest
+ * parts the kernel serializes (the amounts, the tasks, the enzyme schedules and the random
+ * engines, without the parameters), thus an event saves much less than a copy of the whole
+ * kernel and the rollbacks never re-run transitions.
+ *
+ * The processes periodically stop to compute the global virtual time (GVT): the earliest time
+ * of any pending event once all the messages in transit are delivered. No rollback can go
+ * before the GVT, thus the saved states, messages and anti-message records older than it are
+ * released (fossil collection) and the logged states older than it are written to the sink.
+ * The run ends when the GVT reaches the end time.
+ *
+ * The processes only exchange serialized bytes through a transport (shared memory or local
+ * sockets), which must deliver the messages of each pair of processes in order. The messages
+ * of the same time are merged in the compartments order and the states are written ordered
+ * by time and compartment, thus the results are the same of the conservative engine. As in the
+ * conservative engine, each process runs the enzyme transitions in its own share of the threads.
+ */
+template<class TIME>
+class time_warp {
+public:
+
+    using kernel=pmgbp::models::compartment<TIME>;
+    using input_bags=typename kernel::input_bags;
+    using output_bags=typename kernel::output_bags;
+
+    /**
+     * @brief Builds a compartment kernel for each space of the xml file in the path xml_file.
+     *
+     * @param xml_file path where the xml file containing all the parameters is located.
+     * @param sink destination of the states log, a text stream, a trajectory writer or none.
+     * @param type transport used by the compartments to exchange their messages.
+     */
+    time_warp(const std::string& xml_file, state_sink<TIME> sink, transport::kind type = transport::kind::SHARED_MEMORY)
+            : time_warp(xml_file, sink, pmgbp::structs::layout::model_layout(ParameterStore::get(xml_file)), type) {}
+
+    time_warp(const std::string& xml_file, state_sink<TIME> sink, const pmgbp::structs::layout::model_layout& layout, transport::kind type)
+            : sink(sink), compartments(ParameterStore::get(xml_file), layout),
+              channel(transport::make(type, layout.spaces.size())),
+              sync(layout.spaces.size()) {
+
+        std::size_t threads = std::max<std::size_t>(ThreadPool::shared().size() / std::max<std::size_t>(layout.spaces.size(), 1), 1);
+        for (std::size_t i = 0; i < layout.spaces.size(); ++i) {
+            this->processes.emplace_back(new process(xml_file.c_str(), layout.spaces[i].c_str(), layout, threads));
+        }
+    }
+
+    /**
+     * @brief Runs all the compartments until the time end, it can be called again with a
+     * later time to continue the simulation.
+     */
+    void run_until(const TIME& end) {
+        this->gvt_requested = false;
+        this->idle = 0;
+
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(this->processes.size());
+        for (std::size_t id = 0; id < this->processes.size(); ++id) {
+            threads.emplace_back([this, id, &end, &errors]() {
+                ThreadPool::Scope scope(this->processes[id]->pool);
+                try {
+                    this->simulate(id, end);
+                } catch (const stopped&) {
+                    // another compartment failed, its error is rethrown
+                } catch (...) {
+                    errors[id] = std::current_exception();
+                    this->gvt_requested = true;
+                    this->sync.abort();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+
+        this->flush(TIME::infinity());
+    }
+
+    std::size_t size() const {
+        return this->processes.size();
+    }
+
+    /**
+     * @brief Calls f with the state of each compartment model, between the run_until calls.
+     */
+    template<class F>
+    void for_each_state(F f) const {
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            f(lp->model.state);
+        }
+    }
+
+    /**
+     * @brief Calls f with the state of each space, between the run_until calls.
+     */
+    template<class F>
+    void for_each_space(F f) const {
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            f(lp->model.state.space.state);
+        }
+    }
+
+    /**
+     * @brief Writes or reads the state of the compartments and their pending inputs, between
+     * the run_until calls. It is read over an engine built from the same parameters.
+     * @details Once run_until returns the GVT reached its end time: all the messages are
+     * delivered and no rollback can go back, thus the undo records, the sent messages and the
+     * used inputs are not written and the history restarts from the read state.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        pmgbp::serialization::expect_size(archive, this->processes.size());
+        for (std::unique_ptr<process>& lp : this->processes) {
+            lp->model.serialize(archive);
+            archive & lp->last_time & lp->now & lp->started & lp->next_id;
+
+            std::map<std::pair<TIME, std::size_t>, input> pending;
+            if (!ARCHIVE::loading) {
+                auto next = lp->started ? lp->inputs.upper_bound({lp->now, std::numeric_limits<std::size_t>::max()}) : lp->inputs.begin();
+                pending.insert(next, lp->inputs.end());
+            }
+            archive & pending;
+
+            if (ARCHIVE::loading) {
+                lp->inputs = std::move(pending);
+                lp->outputs.clear();
+                lp->has_output = false;
+                lp->save_all();
+                lp->events = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Amount of rollbacks of all the compartments since the engine creation.
+     */
+    std::size_t rollbacks() const {
+        std::size_t result = 0;
+        for (const std::unique_ptr<process>& lp : this->processes) {
+            result += lp->rollbacks;
+        }
+        return result;
+    }
+
+private:
+
+    enum class message_kind : uint8_t { POSITIVE, ANTI };
+
+    struct input {
+        uint64_t id;
+        input_bags bags;
+
+        template<class ARCHIVE>
+        void serialize(ARCHIVE& archive) {
+            archive & this->id & this->bags;
+        }
+    };
+
+    struct sent {
+        TIME time;
+        std::size_t to;
+        uint64_t id;
+    };
+
+    /**
+     * @brief Parts of the kernel state before the event at time that the event changed, only
+     * their dynamic state is kept (kernel::serialize_sub_model), the parameters never change.
+     */
+    struct undo {
+        TIME time;
+        std::string clock; // kernel::serialize_clock
+        std::vector<std::pair<std::size_t, std::string>> sub_models; // (sub model index, state)
+        TIME last_time;
+        TIME now;
+        bool started;
+    };
+
+    struct process {
+        kernel model;
+        TIME last_time; // time of the last kernel transition
+        TIME now; // time of the last event, the inputs until now are already used
+        bool started = false;
+
+        std::map<std::pair<TIME, std::size_t>, input> inputs; // (time, sender) -> message
+        std::deque<sent> outputs; // messages that can still be cancelled, in the order they were sent
+        std::deque<undo> history; // events that can still be rolled back, in the order they ran
+        std::vector<std::string> sub_models; // current state of each sub model of the kernel
+        uint64_t next_id = 0;
+        bool has_output = false; // the output of output_time was already sent
+        TIME output_time;
+
+        std::size_t rollbacks = 0;
+        std::size_t events = 0; // since the last GVT
+        bool idle = false;
+
+        std::vector<typename state_sink<TIME>::entry> log;
+        ThreadPool pool;
+
+        process(const char* xml_file, const char* cid, const pmgbp::structs::layout::model_layout& layout, std::size_t threads)
+                : model(xml_file, cid, layout), last_time(TIME::zero()), now(TIME::zero()), pool(threads) {
+            this->save_all();
+        }
+
+        /**
+         * @brief Saves the state of all the sub models and drops the history, the next events
+         * only save the sub models they change.
+         */
+        void save_all() {
+            this->sub_models.resize(this->model.sub_models());
+            for (std::size_t index = 0; index < this->sub_models.size(); ++index) {
+                this->sub_models[index] = this->save_sub_model(index);
+            }
+            this->history.clear();
+        }
+
+        std::string save_sub_model(std::size_t index) {
+            pmgbp::serialization::writer state;
+            this->model.serialize_sub_model(index, state);
+            return state.release();
+        }
+
+        /**
+         * @brief Starts the undo record of the event at time, before running it.
+         */
+        void begin(const TIME& time) {
+            pmgbp::serialization::writer clock;
+            this->model.serialize_clock(clock);
+            this->history.push_back({time, clock.release(), {}, this->last_time, this->now, this->started});
+        }
+
+        /**
+         * @brief Saves the sub models changed by the event, their previous state goes to its undo record.
+         */
+        void commit() {
+            undo& record = this->history.back();
+            std::vector<std::size_t> stepped;
+            this->model.stepped(stepped);
+            for (std::size_t index : stepped) {
+                std::string state = this->save_sub_model(index);
+                if (state != this->sub_models[index]) {
+                    record.sub_models.emplace_back(index, std::move(this->sub_models[index]));
+                    this->sub_models[index] = std::move(state);
+                }
+            }
+        }
+
+        /**
+         * @brief Restores the state before the last event.
+         */
+        void undo_last() {
+            undo& record = this->history.back();
+            for (std::pair<std::size_t, std::string>& saved : record.sub_models) {
+                pmgbp::serialization::reader state(saved.second);
+                this->model.serialize_sub_model(saved.first, state);
+                this->sub_models[saved.first] = std::move(saved.second);
+            }
+            pmgbp::serialization::reader clock(record.clock);
+            this->model.serialize_clock(clock);
+            this->last_time = record.last_time;
+            this->now = record.now;
+            this->started = record.started;
+            this->history.pop_back();
+        }
+
+        TIME next_input_time() const {
+            auto next = this->started ? this->inputs.upper_bound({this->now, std::numeric_limits<std::size_t>::max()}) : this->inputs.begin();
+            return next == this->inputs.end() ? TIME::infinity() : next->first.first;
+        }
+
+        TIME next_event_time() const {
+            return std::min(this->last_time + this->model.time_advance(), this->next_input_time());
+        }
+
+        bool used(const TIME& time) const {
+            return this->started && !(this->now < time);
+        }
+    };
+
+    struct stopped {};
+
+    /**
+     * @brief Reusable barrier, the last thread to arrive runs the completion before releasing the others.
+     */
+    class barrier {
+    public:
+        explicit barrier(std::size_t size) : size(size) {}
+
+        void wait(const std::function<void()>& completion = nullptr) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            if (this->aborted) throw stopped();
+
+            std::size_t generation = this->generation;
+            if (++this->count == this->size) {
+                if (completion) completion();
+                this->count = 0;
+                ++this->generation;
+                this->released.notify_all();
+                return;
+            }
+            this->released.wait(lock, [this, generation]() { return this->generation != generation || this->aborted; });
+            if (this->aborted) throw stopped();
+        }
+
+        void abort() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->aborted = true;
+            this->released.notify_all();
+        }
+
+    private:
+        std::size_t size;
+        std::size_t count = 0;
+        std::size_t generation = 0;
+        bool aborted = false;
+        std::mutex mutex;
+        std::condition_variable released;
+    };
+
+    static constexpr std::size_t GVT_PERIOD = 256; // events of a process between two GVT requests
+
+    state_sink<TIME> sink;
+    partition<TIME> compartments;
+    std::unique_ptr<transport> channel;
+    std::vector<std::unique_ptr<process>> processes;
+
+    barrier sync;
+    std::atomic<bool> gvt_requested{false};
+    std::atomic<std::size_t> idle{0};
+    std::atomic<uint64_t> sent_messages{0};
+    std::atomic<uint64_t> received_messages{0};
+    std::mutex gvt_mutex;
+    TIME gvt_candidate;
+    TIME gvt;
+
+    void simulate(std::size_t id, const TIME& end) {
+        process& lp = *this->processes[id];
+        lp.idle = false;
+
+        while (true) {
+            if (this->gvt_requested) {
+                if (this->gvt_round(id, end)) {
+                    return;
+                }
+                continue;
+            }
+
+            this->receive(id);
+
+            if (this->step(id, end)) {
+                this->set_idle(lp, false);
+                if (++lp.events >= GVT_PERIOD) {
+                    this->gvt_requested = true;
+                }
+            } else {
+                this->set_idle(lp, true);
+                if (this->idle == this->processes.size()) {
+                    this->gvt_requested = true;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+    }
+
+    void set_idle(process& lp, bool value) {
+        if (lp.idle != value) {
+            lp.idle = value;
+            value ? ++this->idle : --this->idle;
+        }
+    }
+
+    /**
+     * @brief Runs the next event of the compartment id if it is before end.
+     */
+    bool step(std::size_t id, const TIME& end) {
+        process& lp = *this->processes[id];
+
+        TIME next_internal = lp.last_time + lp.model.time_advance();
+        TIME t = std::min(next_internal, lp.next_input_time());
+        if (!(t < end)) {
+            return false;
+        }
+
+        input_bags inputs;
+        bool has_inputs = false;
+        for (auto it = lp.inputs.lower_bound({t, 0}); it != lp.inputs.end() && it->first.first == t; ++it) {
+            pmgbp::tuple::merge(inputs, it->second.bags);
+            has_inputs = true;
+        }
+
+        lp.begin(t);
+        if (t == next_internal) {
+            if (!(lp.has_output && lp.output_time == t)) {
+                this->send(id, t, lp.model.output());
+                lp.has_output = true;
+                lp.output_time = t;
+            }
+            if (has_inputs) {
+                lp.model.confluence_transition(t - lp.last_time, inputs);
+            } else {
+                lp.model.internal_transition();
+            }
+        } else {
+            lp.model.external_transition(t - lp.last_time, inputs);
+        }
+        lp.commit();
+        lp.last_time = t;
+        lp.now = t;
+        lp.started = true;
+
+        if (this->sink.enabled()) {
+            lp.log.push_back(this->sink.compartment(t, lp.model));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Undoes the events of the compartment id with a time greater or equal than time.
+     */
+    void rollback(std::size_t id, const TIME& time) {
+        process& lp = *this->processes[id];
+        ++lp.rollbacks;
+
+        while (!lp.history.empty() && !(lp.history.back().time < time)) {
+            lp.undo_last();
+        }
+
+        while (!lp.outputs.empty() && time < lp.outputs.back().time) {
+            const sent& cancelled = lp.outputs.back();
+            pmgbp::serialization::writer message;
+            this->envelope(message, message_kind::ANTI, id, cancelled.id, cancelled.time);
+            this->transmit(cancelled.to, message);
+            lp.outputs.pop_back();
+        }
+        // Only a straggler at a simulated time rolls back, thus an internal event at time already sent its output
+        lp.has_output = true;
+        lp.output_time = time;
+
+        while (!lp.log.empty() && !(lp.log.back().time < time)) {
+            lp.log.pop_back();
+        }
+    }
+
+    void envelope(pmgbp::serialization::writer& message, message_kind kind, std::size_t from, uint64_t id, const TIME& time) const {
+        std::ostringstream text;
+        text << time;
+        message & kind & static_cast<uint64_t>(from) & id & text.str();
+    }
+
+    void transmit(std::size_t to, pmgbp::serialization::writer& message) {
+        ++this->sent_messages;
+        this->channel->send(to, message.release());
+    }
+
+    /**
+     * @brief Sends the messages of the compartment id at time t to the destination compartments.
+     */
+    void send(std::size_t id, const TIME& t, const output_bags& bags) {
+        process& lp = *this->processes[id];
+
+        for (auto& destination : this->compartments.messages(bags)) {
+            uint64_t message_id = lp.next_id++;
+            pmgbp::serialization::writer message;
+            this->envelope(message, message_kind::POSITIVE, id, message_id, t);
+            std::apply([&message](auto&... bag) { (message & ... & bag.messages); }, destination.second);
+
+            lp.outputs.push_back({t, destination.first, message_id});
+            this->transmit(destination.first, message);
+        }
+    }
+
+    /**
+     * @brief Takes all the messages delivered to the compartment id, rolling it back if needed.
+     */
+    void receive(std::size_t id) {
+        process& lp = *this->processes[id];
+        std::string bytes;
+
+        while (this->channel->receive(id, bytes)) {
+            ++this->received_messages;
+            pmgbp::serialization::reader message(bytes);
+
+            message_kind kind;
+            uint64_t from;
+            uint64_t message_id;
+            std::string text;
+            message & kind & from & message_id & text;
+            TIME time(text);
+            std::pair<TIME, std::size_t> key(time, std::size_t(from));
+
+            if (kind == message_kind::POSITIVE) {
+                input received{message_id, input_bags()};
+                std::apply([&message](auto&... bag) { (message & ... & bag.messages); }, received.bags);
+
+                if (lp.used(time)) {
+                    this->rollback(id, time);
+                }
+                if (!lp.inputs.emplace(key, std::move(received)).second) {
+                    throw std::logic_error("time_warp: two messages with the same time from the same compartment");
+                }
+            } else {
+                auto cancelled = lp.inputs.find(key);
+                if (cancelled == lp.inputs.end() || cancelled->second.id != message_id) {
+                    throw std::logic_error("time_warp: anti-message without its message, the transport is not ordered");
+                }
+                if (lp.used(time)) {
+                    this->rollback(id, time);
+                }
+                lp.inputs.erase(cancelled);
+            }
+        }
+    }
+
+    /**
+     * @brief Computes the GVT with all the other compartments and releases the history older
+     * than it, returns true when the GVT reached the end time.
+     */
+    bool gvt_round(std::size_t id, const TIME& end) {
+        process& lp = *this->processes[id];
+
+        this->sync.wait([this]() { this->gvt_candidate = TIME::infinity(); });
+
+        // Deliver all the messages in transit, the rollbacks can send new anti-messages
+        while (true) {
+            this->receive(id);
+            this->sync.wait();
+            bool delivered = this->sent_messages == this->received_messages;
+            this->sync.wait();
+            if (delivered) break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->gvt_mutex);
+            this->gvt_candidate = std::min(this->gvt_candidate, lp.next_event_time());
+        }
+        this->sync.wait([this]() {
+            this->gvt = this->gvt_candidate;
+            this->gvt_requested = false;
+        });
+        TIME gvt = this->gvt;
+
+        this->fossil_collection(lp, gvt);
+        lp.events = 0;
+        this->set_idle(lp, false);
+
+        // Nobody requests a new GVT before all the processes read this one, the states
+        // before it are committed
+        this->sync.wait([this, &gvt]() { this->flush(gvt); });
+        return !(gvt < end);
+    }
+
+    void fossil_collection(process& lp, const TIME& gvt) {
+        while (!lp.history.empty() && lp.history.front().time < gvt) {
+            lp.history.pop_front();
+        }
+        lp.inputs.erase(lp.inputs.begin(), lp.inputs.lower_bound({gvt, 0}));
+
+        while (!lp.outputs.empty() && lp.outputs.front().time < gvt) {
+            lp.outputs.pop_front();
+        }
+    }
+
+    /**
+     * @brief Writes the states logged by all the compartments before the time until, ordered
+     * by time. No rollback can remove them once until is not after the GVT.
+     */
+    void flush(const TIME& until) {
+        std::vector<std::vector<typename state_sink<TIME>::entry>> committed(this->processes.size());
+        std::vector<const std::vector<typename state_sink<TIME>::entry>*> logs;
+        for (std::size_t i = 0; i < this->processes.size(); ++i) {
+            std::vector<typename state_sink<TIME>::entry>& log = this->processes[i]->log;
+            auto last = std::find_if(log.begin(), log.end(), [&until](const auto& logged) { return !(logged.time < until); });
+            committed[i].assign(std::make_move_iterator(log.begin()), std::make_move_iterator(last));
+            log.erase(log.begin(), last);
+            logs.push_back(&committed[i]);
+        }
+        this->sink.write(logs);
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_TIME_WARP_HPP
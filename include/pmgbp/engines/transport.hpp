@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ENGINE_TRANSPORT_HPP
+#define PMGBP_PDEVS_ENGINE_TRANSPORT_HPP
+
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace pmgbp {
+namespace engines {
+
+/**
+ * @brief Channel used by the partitions of a distributed engine to exchange their messages.
+ * @details Each partition has a mailbox. send can be called by any partition, while receive
+ * is only called by the owner of the mailbox and never blocks. The messages of a sender to
+ * a receiver are received in the order they were sent.
+ */
+class transport {
+public:
+
+    enum class kind { SHARED_MEMORY, SOCKET };
+
+    virtual ~transport() = default;
+
+    virtual void send(std::size_t to, std::string bytes) = 0;
+
+    /**
+     * @brief Takes the next message of the mailbox of the partition to, if any.
+     */
+    virtual bool receive(std::size_t to, std::string& bytes) = 0;
+
+    static std::unique_ptr<transport> make(kind type, std::size_t partitions);
+};
+
+/**
+ * @brief Mailboxes in the memory shared by the threads of the process.
+ */
+class shared_memory_transport : public transport {
+public:
+
+    explicit shared_memory_transport(std::size_t partitions) {
+        for (std::size_t i = 0; i < partitions; ++i) {
+            this->mailboxes.emplace_back(new mailbox());
+        }
+    }
+
+    void send(std::size_t to, std::string bytes) override {
+        mailbox& destination = *this->mailboxes.at(to);
+        std::lock_guard<std::mutex> lock(destination.mutex);
+        destination.messages.push_back(std::move(bytes));
+    }
+
+    bool receive(std::size_t to, std::string& bytes) override {
+        mailbox& destination = *this->mailboxes.at(to);
+        std::lock_guard<std::mutex> lock(destination.mutex);
+        if (destination.messages.empty()) {
+            return false;
+        }
+        bytes = std::move(destination.messages.front());
+        destination.messages.pop_front();
+        return true;
+    }
+
+private:
+
+    struct mailbox {
+        std::mutex mutex;
+        std::deque<std::string> messages;
+    };
+
+    std::vector<std::unique_ptr<mailbox>> mailboxes;
+};
+
+/**
+ * @brief Mailboxes on local (unix domain) sequenced packet sockets, one message per packet.
+ * @details The sockets are non blocking. When the socket of a receiver is full the messages
+ * wait in a queue of the sender side, which is retried on each send and each receive of the
+ * same mailbox, thus a full mailbox never blocks its senders.
+ */
+class socket_transport : public transport {
+public:
+
+    explicit socket_transport(std::size_t partitions) {
+        for (std::size_t i = 0; i < partitions; ++i) {
+            this->mailboxes.emplace_back(new mailbox());
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, this->mailboxes.back()->sockets) != 0) {
+                throw std::runtime_error(std::string("socket_transport: socketpair failed: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    ~socket_transport() override {
+        for (std::unique_ptr<mailbox>& destination : this->mailboxes) {
+            close(destination->sockets[0]);
+            close(destination->sockets[1]);
+        }
+    }
+
+    void send(std::size_t to, std::string bytes) override {
+        mailbox& destination = *this->mailboxes.at(to);
+        std::lock_guard<std::mutex> lock(destination.mutex);
+        destination.pending.push_back(std::move(bytes));
+        this->flush(destination);
+    }
+
+    bool receive(std::size_t to, std::string& bytes) override {
+        mailbox& destination = *this->mailboxes.at(to);
+        int socket = destination.sockets[0];
+
+        ssize_t size = recv(socket, nullptr, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+        if (size < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                throw std::runtime_error(std::string("socket_transport: recv failed: ") + std::strerror(errno));
+            }
+            std::lock_guard<std::mutex> lock(destination.mutex);
+            this->flush(destination);
+            return false;
+        }
+
+        bytes.resize(std::size_t(size));
+        if (recv(socket, &bytes[0], bytes.size(), MSG_DONTWAIT) != size) {
+            throw std::runtime_error("socket_transport: truncated message");
+        }
+
+        std::lock_guard<std::mutex> lock(destination.mutex);
+        this->flush(destination);
+        return true;
+    }
+
+private:
+
+    struct mailbox {
+        int sockets[2]; // the owner reads from 0, the senders write to 1
+        std::mutex mutex;
+        std::deque<std::string> pending; // messages that did not fit in the socket yet
+    };
+
+    std::vector<std::unique_ptr<mailbox>> mailboxes;
+
+    void flush(mailbox& destination) {
+        while (!destination.pending.empty()) {
+            const std::string& bytes = destination.pending.front();
+            if (::send(destination.sockets[1], bytes.data(), bytes.size(), MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                    return;
+                }
+                throw std::runtime_error(std::string("socket_transport: send failed: ") + std::strerror(errno));
+            }
+            destination.pending.pop_front();
+        }
+    }
+};
+
+inline std::unique_ptr<transport> transport::make(kind type, std::size_t partitions) {
+    if (type == kind::SOCKET) {
+        return std::unique_ptr<transport>(new socket_transport(partitions));
+    }
+    return std::unique_ptr<transport>(new shared_memory_transport(partitions));
+}
+
+}
+}
+
+#endif //PMGBP_PDEVS_ENGINE_TRANSPORT_HPP
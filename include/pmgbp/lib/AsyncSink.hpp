@@ -0,0 +1,238 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_ASYNCSINK_HPP
+#define PMGBP_PDEVS_ASYNCSINK_HPP
+
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <exception>
+#include <type_traits>
+#include <algorithm>
+
+template <class SINK, class BATCH, class = void>
+struct has_write_batch : std::false_type {};
+
+template <class SINK, class BATCH>
+struct has_write_batch<SINK, BATCH, std::void_t<decltype(std::declval<SINK&>().write_batch(std::declval<const BATCH&>()))>> : std::true_type {};
+
+template <class SINK, class = void>
+struct has_flush : std::false_type {};
+
+template <class SINK>
+struct has_flush<SINK, std::void_t<decltype(std::declval<SINK&>().flush())>> : std::true_type {};
+
+/**
+ * @brief Write behind sink, the records are written to the downstream sink by a background thread.
+ * @details The records given with << go to a lock free ring of fixed capacity and a background
+ * thread takes them in batches of at most batch_size records. A batch goes in a single
+ * write_batch(const std::vector<RECORD>&) call when the downstream sink has one, otherwise each
+ * record is written with <<. When the ring is full the writer waits for the background thread
+ * (backpressure), thus the memory used by the pending records is bounded.
+ *
+ * There is a single writer thread. The downstream sink is only used by the background thread,
+ * except by flush once all the records are written. The destructor flushes the pending records.
+ * The first exception thrown by the downstream sink is rethrown by every following << and flush,
+ * the sink writes nothing after it.
+ */
+template <class SINK, class RECORD = std::string>
+class AsyncSink {
+public:
+
+    using batch_type = std::vector<RECORD>;
+
+    /**
+     * @param capacity Pending records before the writer waits, rounded up to a power of two.
+     * @param batch_size Maximum records of a downstream write.
+     */
+    AsyncSink(SINK& downstream, std::size_t capacity, std::size_t batch_size)
+    : downstream(downstream), ring(AsyncSink::roundCapacity(capacity)), mask(ring.size() - 1),
+      batch_size(batch_size == 0 ? 1 : batch_size) {
+        this->consumer = std::thread([this]() { this->consume(); });
+    }
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    ~AsyncSink() {
+        try {
+            this->flush();
+        } catch (const std::exception&) {
+            // the records lost by the downstream sink can't be reported anymore
+        }
+        this->stopping.store(true, std::memory_order_release);
+        this->consumer.join();
+    }
+
+    template <class VALUE>
+    AsyncSink& operator<<(VALUE&& value) {
+        this->check();
+        std::size_t tail = this->tail.load(std::memory_order_relaxed);
+        while (tail - this->head.load(std::memory_order_acquire) == this->ring.size()) {
+            ++this->waits;
+            this->check();
+            std::this_thread::yield();
+        }
+        this->ring[tail & this->mask] = RECORD(std::forward<VALUE>(value));
+        this->tail.store(tail + 1, std::memory_order_release);
+        return *this;
+    }
+
+    /**
+     * @brief Waits until the downstream sink has all the records and flushes it when it can.
+     */
+    void flush() {
+        std::size_t tail = this->tail.load(std::memory_order_relaxed);
+        while (this->written.load(std::memory_order_acquire) != tail) {
+            this->check();
+            std::this_thread::yield();
+        }
+        this->check();
+        AsyncSink::flush_downstream(this->downstream, has_flush<SINK>());
+    }
+
+    std::size_t capacity() const {
+        return this->ring.size();
+    }
+
+    /**
+     * @brief Records given to the sink.
+     */
+    std::size_t pushed() const {
+        return this->tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Records written to the downstream sink.
+     */
+    std::size_t records() const {
+        return this->written.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Downstream writes, one per batch.
+     */
+    std::size_t batches() const {
+        return this->batch_count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Times the writer found the ring full.
+     */
+    std::size_t full_waits() const {
+        return this->waits;
+    }
+
+private:
+
+    SINK& downstream;
+    std::vector<RECORD> ring;
+    std::size_t mask;
+    std::size_t batch_size;
+
+    // Positions always grow, the slot of a position is position & mask
+    alignas(64) std::atomic<std::size_t> head{0}; // next record to take, moved by the consumer
+    alignas(64) std::atomic<std::size_t> tail{0}; // next free slot, moved by the writer
+    alignas(64) std::atomic<std::size_t> written{0};
+    std::atomic<std::size_t> batch_count{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::size_t waits = 0;
+    std::thread consumer;
+
+    void consume() {
+        batch_type batch;
+        batch.reserve(this->batch_size);
+        while (true) {
+            std::size_t head = this->head.load(std::memory_order_relaxed);
+            std::size_t available = this->tail.load(std::memory_order_acquire) - head;
+
+            if (available == 0) {
+                if (this->stopping.load(std::memory_order_acquire)) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+
+            std::size_t taken = std::min(available, this->batch_size);
+            for (std::size_t i = 0; i < taken; ++i) {
+                batch.push_back(std::move(this->ring[(head + i) & this->mask]));
+            }
+            this->head.store(head + taken, std::memory_order_release);
+
+            if (!this->failed.load(std::memory_order_relaxed)) {
+                try {
+                    AsyncSink::write(this->downstream, batch, has_write_batch<SINK, batch_type>());
+                    this->batch_count.fetch_add(1, std::memory_order_release);
+                } catch (...) {
+                    this->error = std::current_exception();
+                    this->failed.store(true, std::memory_order_release);
+                }
+            }
+            batch.clear();
+            this->written.fetch_add(taken, std::memory_order_release);
+        }
+    }
+
+    void check() const {
+        if (this->failed.load(std::memory_order_acquire)) {
+            std::rethrow_exception(this->error);
+        }
+    }
+
+    static void write(SINK& sink, const batch_type& batch, std::true_type) {
+        sink.write_batch(batch);
+    }
+
+    static void write(SINK& sink, const batch_type& batch, std::false_type) {
+        for (const RECORD& record : batch) {
+            sink << record;
+        }
+    }
+
+    static void flush_downstream(SINK& sink, std::true_type) {
+        sink.flush();
+    }
+
+    static void flush_downstream(SINK&, std::false_type) {}
+
+    static std::size_t roundCapacity(std::size_t capacity) {
+        std::size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+};
+
+#endif //PMGBP_PDEVS_ASYNCSINK_HPP
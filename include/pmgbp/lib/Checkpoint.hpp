@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_CHECKPOINT_HPP
+#define PMGBP_PDEVS_CHECKPOINT_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <pmgbp/lib/Serialization.hpp>
+
+namespace pmgbp {
+namespace checkpoint {
+
+/**
+ * @brief Binary file with the state of a simulation at a simulated time, to resume it later.
+ * @details The file is a header followed by the serialized fields:
+ *
+ *     header   "PMGBPCKP" uint32 version
+ *     fields   mode, seed, time and state with the pmgbp::serialization archives
+ *
+ * The state is written by the serialize member of the engine, it only holds the dynamic state
+ * and it is read over an engine built from the same parameters, by the same build. The file is
+ * written aside and renamed over the previous one, thus a crash while writing it keeps the
+ * previous checkpoint.
+ */
+static const char MAGIC[8] = {'P', 'M', 'G', 'B', 'P', 'C', 'K', 'P'};
+static const uint32_t VERSION = 1;
+
+struct file {
+    std::string mode; // simulation mode that wrote the state
+    uint64_t seed = 0; // master seed of the random streams
+    std::string time; // simulated time of the state, as text
+    std::string state;
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->mode & this->seed & this->time & this->state;
+    }
+
+    void write(const std::string& path) const {
+        pmgbp::serialization::writer fields;
+        fields & *this;
+
+        std::string aside = path + ".tmp";
+        {
+            std::ofstream out(aside, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("Unable to open the checkpoint file " + aside);
+            }
+            out.write(MAGIC, sizeof(MAGIC));
+            out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+            out.write(fields.bytes().data(), std::streamsize(fields.bytes().size()));
+            out.flush();
+            if (!out) {
+                throw std::runtime_error("Unable to write the checkpoint file " + aside);
+            }
+        }
+        if (std::rename(aside.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Unable to replace the checkpoint file " + path);
+        }
+    }
+
+    /**
+     * @brief Reads the checkpoint in path, a wrong header or a truncated file throws std::runtime_error.
+     */
+    static file read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Unable to open the checkpoint file " + path);
+        }
+        std::ostringstream content;
+        content << in.rdbuf();
+        std::string bytes = content.str();
+
+        std::size_t header = sizeof(MAGIC) + sizeof(VERSION);
+        if (bytes.size() < header || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a checkpoint file " + path);
+        }
+        uint32_t version;
+        std::memcpy(&version, bytes.data() + sizeof(MAGIC), sizeof(version));
+        if (version != VERSION) {
+            throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+        }
+
+        file result;
+        std::string serialized = bytes.substr(header);
+        pmgbp::serialization::reader fields(serialized);
+        fields & result;
+        if (!fields.done()) {
+            throw std::runtime_error("Unexpected bytes after the checkpoint in " + path);
+        }
+        return result;
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_CHECKPOINT_HPP
@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_FLAT_MAP_HPP
+#define PMGBP_PDEVS_FLAT_MAP_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+#include <stdexcept>
+#include <initializer_list>
+
+/**
+ * @brief Associative container stored as a vector of pairs sorted by key.
+ * @details It has the subset of the std::map interface used by the models (find, at, insert,
+ * operator[], ordered iteration) and the add, subtract and covers kernels used to update and
+ * check metabolite amounts. The small maps of stoichiometries and messages fit in a few cache
+ * lines and the kernels are linear merges of two sorted sequences.
+ *
+ * Inserting keeps the vector sorted, so it is intended for maps that are built once and then
+ * mostly read or updated in place, as the stoichiometries and the space inventories.
+ */
+template<class KEY, class VALUE>
+class FlatMap {
+public:
+    using key_type = KEY;
+    using mapped_type = VALUE;
+    using value_type = std::pair<KEY, VALUE>;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type = typename container_type::size_type;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<value_type> values) {
+        for (const value_type& value : values) {
+            this->insert(value);
+        }
+    }
+
+    /******** std::map like interface ********/
+
+    iterator begin() { return this->entries.begin(); }
+    iterator end() { return this->entries.end(); }
+    const_iterator begin() const { return this->entries.begin(); }
+    const_iterator end() const { return this->entries.end(); }
+    const_iterator cbegin() const { return this->entries.cbegin(); }
+    const_iterator cend() const { return this->entries.cend(); }
+
+    size_type size() const { return this->entries.size(); }
+    bool empty() const { return this->entries.empty(); }
+    void clear() { this->entries.clear(); }
+    void reserve(size_type n) { this->entries.reserve(n); }
+
+    iterator find(const KEY& key) {
+        iterator it = this->lower_bound(key);
+        return (it != this->entries.end() && it->first == key) ? it : this->entries.end();
+    }
+
+    const_iterator find(const KEY& key) const {
+        const_iterator it = this->lower_bound(key);
+        return (it != this->entries.end() && it->first == key) ? it : this->entries.end();
+    }
+
+    size_type count(const KEY& key) const {
+        return this->find(key) != this->entries.end() ? 1 : 0;
+    }
+
+    VALUE& at(const KEY& key) {
+        iterator it = this->find(key);
+        if (it == this->entries.end()) {
+            throw std::out_of_range("FlatMap::at");
+        }
+        return it->second;
+    }
+
+    const VALUE& at(const KEY& key) const {
+        const_iterator it = this->find(key);
+        if (it == this->entries.end()) {
+            throw std::out_of_range("FlatMap::at");
+        }
+        return it->second;
+    }
+
+    VALUE& operator[](const KEY& key) {
+        iterator it = this->lower_bound(key);
+        if (it == this->entries.end() || it->first != key) {
+            it = this->entries.insert(it, value_type(key, VALUE()));
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Inserts the value if the key is not already in the map, as std::map::insert does.
+     */
+    std::pair<iterator, bool> insert(const value_type& value) {
+        iterator it = this->lower_bound(value.first);
+        if (it != this->entries.end() && it->first == value.first) {
+            return {it, false};
+        }
+        return {this->entries.insert(it, value), true};
+    }
+
+    void erase(const KEY& key) {
+        iterator it = this->find(key);
+        if (it != this->entries.end()) {
+            this->entries.erase(it);
+        }
+    }
+
+    bool operator==(const FlatMap& other) const {
+        return this->entries == other.entries;
+    }
+
+    bool operator!=(const FlatMap& other) const {
+        return this->entries != other.entries;
+    }
+
+    /************** Kernels ******************/
+
+    /**
+     * @brief Adds times * other to this map, the keys not present are inserted.
+     */
+    void add(const FlatMap& other, VALUE times = 1) {
+        if (other.empty()) {
+            return;
+        }
+
+        // Fast path, all the keys are already present and the values are updated in place
+        if (this->add_in_place(other, times)) {
+            return;
+        }
+
+        container_type merged;
+        merged.reserve(this->entries.size() + other.entries.size());
+
+        const_iterator it = this->entries.cbegin();
+        const_iterator jt = other.entries.cbegin();
+        while (it != this->entries.cend() && jt != other.entries.cend()) {
+            if (it->first < jt->first) {
+                merged.push_back(*it++);
+            } else if (jt->first < it->first) {
+                merged.emplace_back(jt->first, jt->second * times);
+                ++jt;
+            } else {
+                merged.emplace_back(it->first, it->second + jt->second * times);
+                ++it;
+                ++jt;
+            }
+        }
+        merged.insert(merged.end(), it, this->entries.cend());
+        for (; jt != other.entries.cend(); ++jt) {
+            merged.emplace_back(jt->first, jt->second * times);
+        }
+
+        this->entries.swap(merged);
+    }
+
+    /**
+     * @brief Subtracts times * other from this map, all the keys of other must be present
+     * with enough amount (see covers).
+     */
+    void subtract(const FlatMap& other, VALUE times = 1) {
+        iterator it = this->entries.begin();
+        for (const value_type& value : other.entries) {
+            it = std::lower_bound(it, this->entries.end(), value.first, key_less());
+            assert(it != this->entries.end() && it->first == value.first);
+            assert(it->second >= value.second * times);
+            it->second -= value.second * times;
+        }
+    }
+
+    /**
+     * @brief Tells if all the keys of other are present with at least times * their amount.
+     */
+    bool covers(const FlatMap& other, VALUE times = 1) const {
+        const_iterator it = this->entries.cbegin();
+        for (const value_type& value : other.entries) {
+            it = std::lower_bound(it, this->entries.cend(), value.first, key_less());
+            if (it == this->entries.cend() || it->first != value.first || it->second < value.second * times) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Maximum number of times that other can be subtracted from this map, the keys
+     * of other that are not present and the zero amounts are ignored.
+     */
+    VALUE multiplicity(const FlatMap& other) const {
+        VALUE result = std::numeric_limits<VALUE>::max();
+        const_iterator it = this->entries.cbegin();
+        for (const value_type& value : other.entries) {
+            it = std::lower_bound(it, this->entries.cend(), value.first, key_less());
+            if (it != this->entries.cend() && it->first == value.first && value.second > 0) {
+                result = std::min(result, VALUE(it->second / value.second));
+            }
+        }
+        return result;
+    }
+
+private:
+    container_type entries;
+
+    struct key_less {
+        bool operator()(const value_type& value, const KEY& key) const {
+            return value.first < key;
+        }
+    };
+
+    iterator lower_bound(const KEY& key) {
+        return std::lower_bound(this->entries.begin(), this->entries.end(), key, key_less());
+    }
+
+    const_iterator lower_bound(const KEY& key) const {
+        return std::lower_bound(this->entries.cbegin(), this->entries.cend(), key, key_less());
+    }
+
+    bool add_in_place(const FlatMap& other, VALUE times) {
+        if (!this->covers_keys(other)) {
+            return false;
+        }
+
+        iterator it = this->entries.begin();
+        for (const value_type& value : other.entries) {
+            it = std::lower_bound(it, this->entries.end(), value.first, key_less());
+            it->second += value.second * times;
+        }
+        return true;
+    }
+
+    bool covers_keys(const FlatMap& other) const {
+        const_iterator it = this->entries.cbegin();
+        for (const value_type& value : other.entries) {
+            it = std::lower_bound(it, this->entries.cend(), value.first, key_less());
+            if (it == this->entries.cend() || it->first != value.first) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif //PMGBP_PDEVS_FLAT_MAP_HPP
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_INDEXEDPRIORITYQUEUE_HPP
+#define PMGBP_PDEVS_INDEXEDPRIORITYQUEUE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <cassert>
+
+/**
+ * @brief Binary min heap of a fixed set of indexes 0..n-1, each one with a key that can be
+ * changed in place.
+ * @details The heap keeps the position of each index, thus update moves an index up or down
+ * in O(log n) without searching it and top is O(1). It is the queue of the next reaction
+ * method (Gibson and Bruck), where each reaction channel keeps its absolute next firing time.
+ * Equal keys are ordered by index, so the order does not depend on the update history.
+ */
+template<class KEY>
+class IndexedPriorityQueue {
+public:
+
+    IndexedPriorityQueue() = default;
+
+    explicit IndexedPriorityQueue(const std::vector<KEY>& keys) : keys(keys), heap(keys.size()), positions(keys.size()) {
+        for (std::size_t index = 0; index < keys.size(); ++index) {
+            this->heap[index] = index;
+            this->positions[index] = index;
+        }
+        for (std::size_t position = this->heap.size() / 2; position-- > 0;) {
+            this->down(position);
+        }
+    }
+
+    std::size_t size() const {
+        return this->heap.size();
+    }
+
+    bool empty() const {
+        return this->heap.empty();
+    }
+
+    /**
+     * @brief Index with the smallest key.
+     */
+    std::size_t top() const {
+        assert(!this->heap.empty());
+        return this->heap.front();
+    }
+
+    const KEY& key(std::size_t index) const {
+        return this->keys[index];
+    }
+
+    void update(std::size_t index, const KEY& key) {
+        this->keys[index] = key;
+        this->up(this->positions[index]);
+        this->down(this->positions[index]);
+    }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->keys & this->heap & this->positions;
+    }
+
+private:
+    std::vector<KEY> keys; // by index
+    std::vector<std::size_t> heap; // position -> index
+    std::vector<std::size_t> positions; // index -> position
+
+    bool less(std::size_t l, std::size_t r) const {
+        return this->keys[l] < this->keys[r] || (!(this->keys[r] < this->keys[l]) && l < r);
+    }
+
+    void swap(std::size_t l, std::size_t r) {
+        std::swap(this->heap[l], this->heap[r]);
+        this->positions[this->heap[l]] = l;
+        this->positions[this->heap[r]] = r;
+    }
+
+    void up(std::size_t position) {
+        while (position > 0) {
+            std::size_t parent = (position - 1) / 2;
+            if (!this->less(this->heap[position], this->heap[parent])) break;
+            this->swap(position, parent);
+            position = parent;
+        }
+    }
+
+    void down(std::size_t position) {
+        while (true) {
+            std::size_t smallest = position;
+            std::size_t left = 2 * position + 1;
+            std::size_t right = left + 1;
+            if (left < this->heap.size() && this->less(this->heap[left], this->heap[smallest])) smallest = left;
+            if (right < this->heap.size() && this->less(this->heap[right], this->heap[smallest])) smallest = right;
+            if (smallest == position) break;
+            this->swap(position, smallest);
+            position = smallest;
+        }
+    }
+};
+
+#endif //PMGBP_PDEVS_INDEXEDPRIORITYQUEUE_HPP
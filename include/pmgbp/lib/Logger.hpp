@@ -35,13 +35,102 @@
 */
 
 #include <string>
+#include <iostream>
+#include <cstdlib>
+
+/**
+ * The logging macros only evaluate the message when the level is compiled in (see the flags
+ * above) and enabled at runtime. Thus, a disabled level costs nothing, not even the message
+ * construction:
+ *
+ *     PMGBP_LOG_DEBUG(this->logger, "Loading enzyme " + enzyme_id);
+ *
+ * The runtime level is read from the PMGBP_LOG_LEVEL environment variable (none, error, log,
+ * info or debug) and it can be changed with Logger::setLevel. By default all the compiled in
+ * levels are enabled.
+ */
+#define PMGBP_LOG_IF(level, logger, method, msg) \
+    do { if (Logger::enabled(level)) { (logger).method(msg); } } while (false)
+
+#define PMGBP_LOG_ERROR(logger, msg) PMGBP_LOG_IF(Logger::Level::ERROR, logger, error, msg)
+#define PMGBP_LOG(logger, msg) PMGBP_LOG_IF(Logger::Level::LOG, logger, log, msg)
+#define PMGBP_LOG_INFO(logger, msg) PMGBP_LOG_IF(Logger::Level::INFO, logger, info, msg)
+#define PMGBP_LOG_DEBUG(logger, msg) PMGBP_LOG_IF(Logger::Level::DEBUG, logger, debug, msg)
 
 // TODO: add option to log to files instead of the standard output
 class Logger {
+public:
+    enum class Level { NONE = 0, ERROR = 1, LOG = 2, INFO = 3, DEBUG = 4 };
+
 private:
     std::string module_name = "";
+
+    static Level& runtime_level() {
+        static Level level = Logger::levelFromEnvironment();
+        return level;
+    }
+
+    static Level levelFromEnvironment() {
+        const char* value = std::getenv("PMGBP_LOG_LEVEL");
+        Level level = Level::DEBUG;
+        if (value != nullptr && !Logger::parseLevel(value, level)) {
+            std::cerr << "[Logger] unknown PMGBP_LOG_LEVEL " << value << ", all levels enabled" << std::endl;
+        }
+        return level;
+    }
+
 public:
 
+    /**
+     * @brief Tells if the level was compiled in with its show_* flag.
+     */
+    static constexpr bool compiled(Level level) {
+        switch (level) {
+#ifdef show_error
+            case Level::ERROR: return true;
+#endif
+#ifdef show_log
+            case Level::LOG: return true;
+#endif
+#ifdef show_info
+            case Level::INFO: return true;
+#endif
+#ifdef show_debug
+            case Level::DEBUG: return true;
+#endif
+            default: return false;
+        }
+    }
+
+    /**
+     * @brief Tells if the messages of the level are printed, it is always false for the levels
+     * that are not compiled in, so the compiler removes the guarded code.
+     */
+    static bool enabled(Level level) {
+        return Logger::compiled(level) && level <= Logger::runtime_level();
+    }
+
+    /**
+     * @brief Sets the most verbose level that is printed at runtime.
+     */
+    static void setLevel(Level level) {
+        Logger::runtime_level() = level;
+    }
+
+    /**
+     * @brief Parses a level name (none, error, log, info or debug).
+     * @return false if the name is not a level, in which case level is not modified.
+     */
+    static bool parseLevel(const std::string& name, Level& level) {
+        if (name == "none") level = Level::NONE;
+        else if (name == "error") level = Level::ERROR;
+        else if (name == "log") level = Level::LOG;
+        else if (name == "info") level = Level::INFO;
+        else if (name == "debug") level = Level::DEBUG;
+        else return false;
+        return true;
+    }
+
     /**
      * @brief Default constructor
      * @details It construct a new instance of Logger without module name.
@@ -83,9 +172,12 @@ public:
      */
     void log(std::string msg) const {
 #ifdef show_log
+        if (!Logger::enabled(Level::LOG)) return;
         std::cout << "[LOG] - ";
 		std::cout << "[" + module_name + "] ";
 		std::cout << msg << std::endl;
+#else
+        (void)msg;
 #endif
     }
 
@@ -99,9 +191,12 @@ public:
      */
     void info(const std::string& msg) const {
 #ifdef show_info
+        if (!Logger::enabled(Level::INFO)) return;
         std::cout << "[INFO] - ";
 		std::cout << "[" + module_name + "] ";
 		std::cout << msg << std::endl;
+#else
+        (void)msg;
 #endif
     }
 
@@ -115,9 +210,12 @@ public:
      */
     void debug(const std::string& msg) const {
 #ifdef show_debug
+        if (!Logger::enabled(Level::DEBUG)) return;
         std::cout << "[DEBUG] - ";
 		std::cout << "[" + module_name + "] ";
 		std::cout << msg << std::endl;
+#else
+        (void)msg;
 #endif
     }
 
@@ -131,9 +229,12 @@ public:
      */
     void error(const std::string& msg) const {
 #ifdef show_error
+        if (!Logger::enabled(Level::ERROR)) return;
         std::cout << "[ERROR] - ";
 		std::cout << "[" + module_name + "] ";
 		std::cout << msg << std::endl;
+#else
+        (void)msg;
 #endif
     }
 };
@@ -0,0 +1,311 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_OPTIONS_HPP
+#define PMGBP_PDEVS_OPTIONS_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+
+#include <pmgbp/lib/TimeText.hpp>
+
+/**
+ * @brief Command line options of the pmgbp simulator.
+ * @details Usage:
+ *
+ *     pmgbp <xml_parameters_path> [simulation_id] [options]
+ *
+ *     --end-time <hh[:mm[:ss[:ms]]]>    simulation horizon (default 3000)
+ *     --seed <integer>                   master seed of the random streams
+ *     --log-level <level>                none, error, log, info or debug
+ *     --output <sink>                    stdout, file, binary, memore or none (default stdout)
+ *     --output-file <path>               destination of the file and binary sinks
+ *     --snapshot-interval <hh[:mm[:ss[:ms]]]> simulated time between the snapshots of the model states
+ *     --snapshot-file <path>             destination of the snapshots, the full states as "time state" lines
+ *     --sample-interval <hh[:mm[:ss[:ms]]]> simulated time between the samples of the space amounts
+ *     --sample-file <path>               csv destination of the samples
+ *     --mode <mode>                      coupled, fused, conservative or optimistic compartments, or ssa
+ *                                        exact stochastic reactions (default coupled)
+ *     --transport <transport>            shared or socket messages between the optimistic compartments (default shared)
+ *     --threads <integer>                threads running the enzyme transitions, 0 for all the cores (default 1),
+ *                                        split among the conservative and optimistic compartments
+ *     --tau-leap <epsilon>               leap condition of the space selections in (0, 1), 0 for the exact
+ *                                        selection (default 0)
+ *     --delta-keyframes <integer>        transitions between the full states of each model, the states in
+ *                                        between only log the changes, 0 logs every state in full (default 0)
+ *     --log-batch <integer>              records of each write of the memore output (default 1000)
+ *     --log-queue <integer>              records waiting to be written before the simulation waits for the
+ *                                        memore output (default 65536)
+ *     --checkpoint-file <path>           destination of the checkpoints of the fused, conservative, optimistic
+ *                                        and ssa modes
+ *     --checkpoint-interval <hh[:mm[:ss[:ms]]]> simulated time between the checkpoints
+ *     --checkpoint-wall <seconds>        minimum wall clock seconds between the checkpoints, checked at
+ *                                        each checkpoint interval (default 0)
+ *     --resume <path>                    continues a checkpoint until the end time, with the same parameters,
+ *                                        the outputs start at the checkpoint with the full model states
+ *                                        and mode
+ *
+ * The times are kept as the strings given in the command line and converted by the caller
+ * to its time type. A wrong option throws std::invalid_argument with the reason.
+ */
+class Options {
+public:
+
+    enum class Output { STDOUT, FILE, BINARY, DATABASE, NONE }; // DATABASE is the memore output, MEMORE is the build macro
+    enum class Mode { COUPLED, FUSED, CONSERVATIVE, OPTIMISTIC, SSA };
+    enum class Transport { SHARED, SOCKET };
+
+    std::string xml_parameters_path;
+    std::string simulation_id;
+    std::string end_time = "3000";
+    bool has_seed = false;
+    uint64_t seed = 0;
+    std::string log_level;
+    Output output = Output::STDOUT;
+    std::string output_file;
+    std::string snapshot_interval;
+    std::string snapshot_file;
+    std::string sample_interval;
+    std::string sample_file;
+    Mode mode = Mode::COUPLED;
+    Transport transport = Transport::SHARED;
+    std::size_t threads = 1; // 0 means all the hardware threads
+    double tau_leap = 0.0; // 0 means the exact selection
+    std::size_t delta_keyframes = 0; // 0 means full states
+    std::size_t log_batch = 1000;
+    std::size_t log_queue = 65536;
+    std::string checkpoint_file;
+    std::string checkpoint_interval;
+    std::size_t checkpoint_wall = 0; // 0 means every interval
+    std::string resume_file;
+
+    Options() = default;
+
+    Options(int argc, const char* const* argv) {
+        std::vector<std::string> positional;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+
+            if (arg.compare(0, 2, "--") != 0) {
+                positional.push_back(arg);
+                continue;
+            }
+
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for option " + arg);
+            }
+            std::string value = argv[++i];
+
+            if (arg == "--end-time") {
+                this->end_time = Options::checkTime(arg, value);
+            } else if (arg == "--seed") {
+                this->seed = Options::parseSeed(value);
+                this->has_seed = true;
+            } else if (arg == "--log-level") {
+                this->log_level = value;
+            } else if (arg == "--output") {
+                this->output = Options::parseOutput(value);
+            } else if (arg == "--output-file") {
+                this->output_file = value;
+            } else if (arg == "--snapshot-interval") {
+                this->snapshot_interval = Options::checkTime(arg, value);
+            } else if (arg == "--snapshot-file") {
+                this->snapshot_file = value;
+            } else if (arg == "--sample-interval") {
+                this->sample_interval = Options::checkTime(arg, value);
+            } else if (arg == "--sample-file") {
+                this->sample_file = value;
+            } else if (arg == "--mode") {
+                this->mode = Options::parseMode(value);
+            } else if (arg == "--transport") {
+                this->transport = Options::parseTransport(value);
+            } else if (arg == "--threads") {
+                this->threads = Options::parseThreads(value);
+            } else if (arg == "--tau-leap") {
+                this->tau_leap = Options::parseEpsilon(value);
+            } else if (arg == "--delta-keyframes") {
+                this->delta_keyframes = Options::parseKeyframes(value);
+            } else if (arg == "--log-batch") {
+                this->log_batch = Options::parseRecords(arg, value);
+            } else if (arg == "--log-queue") {
+                this->log_queue = Options::parseRecords(arg, value);
+            } else if (arg == "--checkpoint-file") {
+                this->checkpoint_file = value;
+            } else if (arg == "--checkpoint-interval") {
+                this->checkpoint_interval = Options::checkTime(arg, value);
+            } else if (arg == "--checkpoint-wall") {
+                this->checkpoint_wall = Options::parseSeconds(arg, value);
+            } else if (arg == "--resume") {
+                this->resume_file = value;
+            } else {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+
+        if (positional.empty() || positional.size() > 2) {
+            throw std::invalid_argument("expected <xml_parameters_path> [simulation_id]");
+        }
+        this->xml_parameters_path = positional[0];
+        if (positional.size() == 2) {
+            this->simulation_id = positional[1];
+        }
+
+        bool writes_file = this->output == Output::FILE || this->output == Output::BINARY;
+        if (writes_file && this->output_file.empty()) {
+            throw std::invalid_argument("--output-file is required for the file and binary outputs");
+        }
+        if (this->snapshot_interval.empty() != this->snapshot_file.empty()) {
+            throw std::invalid_argument("--snapshot-interval and --snapshot-file go together");
+        }
+        if (this->sample_interval.empty() != this->sample_file.empty()) {
+            throw std::invalid_argument("--sample-interval and --sample-file go together");
+        }
+        if (this->checkpoint_interval.empty() != this->checkpoint_file.empty()) {
+            throw std::invalid_argument("--checkpoint-interval and --checkpoint-file go together");
+        }
+        if (this->checkpoint_wall != 0 && this->checkpoint_file.empty()) {
+            throw std::invalid_argument("--checkpoint-wall needs --checkpoint-interval and --checkpoint-file");
+        }
+    }
+
+    static std::string usage(const std::string& program) {
+        return "Usage: " + program + " <xml_parameters_path> [simulation_id]"
+               " [--end-time hh[:mm[:ss[:ms]]]] [--seed integer]"
+               " [--log-level none|error|log|info|debug]"
+               " [--output stdout|file|binary|memore|none] [--output-file path]"
+               " [--snapshot-interval hh[:mm[:ss[:ms]]] --snapshot-file path]"
+               " [--sample-interval hh[:mm[:ss[:ms]]] --sample-file path] [--mode coupled|fused|conservative|optimistic|ssa]"
+               " [--transport shared|socket] [--threads integer] [--tau-leap epsilon]"
+               " [--delta-keyframes integer] [--log-batch integer] [--log-queue integer]"
+               " [--checkpoint-interval hh[:mm[:ss[:ms]]] --checkpoint-file path [--checkpoint-wall seconds]]"
+               " [--resume path]";
+    }
+
+    /**
+     * @brief Name of the mode in the command line, the checkpoints record it.
+     */
+    static std::string modeName(Mode mode) {
+        switch (mode) {
+            case Mode::COUPLED: return "coupled";
+            case Mode::FUSED: return "fused";
+            case Mode::CONSERVATIVE: return "conservative";
+            case Mode::OPTIMISTIC: return "optimistic";
+            case Mode::SSA: return "ssa";
+        }
+        return "";
+    }
+
+private:
+
+    static std::string checkTime(const std::string& option, const std::string& value) {
+        try {
+            pmgbp::time_text::nanoseconds(value, 4);
+        } catch (const std::invalid_argument&) {
+            throw std::invalid_argument("wrong time for option " + option + ": " + value);
+        }
+        return value;
+    }
+
+    static uint64_t parseSeed(const std::string& value) {
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("wrong seed: " + value);
+        }
+        return std::stoull(value);
+    }
+
+    static std::size_t parseThreads(const std::string& value) {
+        if (value.empty() || value.size() > 6 || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("wrong amount of threads: " + value);
+        }
+        return std::stoul(value);
+    }
+
+    static std::size_t parseKeyframes(const std::string& value) {
+        if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("wrong keyframe interval: " + value);
+        }
+        return std::stoul(value);
+    }
+
+    static std::size_t parseRecords(const std::string& option, const std::string& value) {
+        if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos || std::stoul(value) == 0) {
+            throw std::invalid_argument("wrong amount of records for option " + option + ": " + value);
+        }
+        return std::stoul(value);
+    }
+
+    static std::size_t parseSeconds(const std::string& option, const std::string& value) {
+        if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("wrong seconds for option " + option + ": " + value);
+        }
+        return std::stoul(value);
+    }
+
+    static double parseEpsilon(const std::string& value) {
+        std::size_t parsed = 0;
+        double epsilon = -1.0;
+        try {
+            epsilon = std::stod(value, &parsed);
+        } catch (const std::exception&) {
+            parsed = 0;
+        }
+        if (parsed == 0 || parsed != value.size() || !(epsilon >= 0.0 && epsilon < 1.0)) {
+            throw std::invalid_argument("wrong tau leaping epsilon: " + value);
+        }
+        return epsilon;
+    }
+
+    static Output parseOutput(const std::string& value) {
+        if (value == "stdout") return Output::STDOUT;
+        if (value == "file") return Output::FILE;
+        if (value == "binary") return Output::BINARY;
+        if (value == "memore") return Output::DATABASE;
+        if (value == "none") return Output::NONE;
+        throw std::invalid_argument("unknown output " + value);
+    }
+
+    static Mode parseMode(const std::string& value) {
+        if (value == "coupled") return Mode::COUPLED;
+        if (value == "fused") return Mode::FUSED;
+        if (value == "conservative") return Mode::CONSERVATIVE;
+        if (value == "optimistic") return Mode::OPTIMISTIC;
+        if (value == "ssa") return Mode::SSA;
+        throw std::invalid_argument("unknown mode " + value);
+    }
+
+    static Transport parseTransport(const std::string& value) {
+        if (value == "shared") return Transport::SHARED;
+        if (value == "socket") return Transport::SOCKET;
+        throw std::invalid_argument("unknown transport " + value);
+    }
+};
+
+#endif //PMGBP_PDEVS_OPTIONS_HPP
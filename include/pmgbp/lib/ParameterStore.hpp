@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_PARAMETER_STORE_HPP
+#define PMGBP_PDEVS_PARAMETER_STORE_HPP
+
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cassert>
+
+#include <tinyxml2.h>
+
+/**
+ * @brief Process-wide, read only view of a parameters.xml file.
+ * @details The file is opened and parsed once, the first time it is requested, and
+ * the spaces, routers, enzymes and reactions sections are indexed by id in hash maps.
+ * All the atomic model constructors share the same instance instead of re-parsing
+ * the whole file for each model.
+ */
+class ParameterStore {
+public:
+
+    ParameterStore(const ParameterStore&) = delete;
+    ParameterStore& operator=(const ParameterStore&) = delete;
+
+    /**
+     * @brief Returns the store for the xml file, loading and indexing it the first time.
+     *
+     * @param xml_file path where the xml file containing all the parameters is located.
+     */
+    static const ParameterStore& get(const std::string& xml_file) {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+
+        std::unique_ptr<ParameterStore>& store = registry()[xml_file];
+        if (!store) {
+            store.reset(new ParameterStore(xml_file));
+        }
+        return *store;
+    }
+
+    /**
+     * @brief Frees the parsed document of the xml file.
+     * @details Must be called only once all the models using the file are built,
+     * the elements returned by the store are invalid after the release.
+     *
+     * @param xml_file path of a previously loaded xml file.
+     */
+    static void release(const std::string& xml_file) {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        registry().erase(xml_file);
+    }
+
+    const tinyxml2::XMLElement* root() const {
+        return this->document.RootElement();
+    }
+
+    const tinyxml2::XMLElement* space(const std::string& cid) const {
+        return this->spaces.at(cid);
+    }
+
+    const tinyxml2::XMLElement* router(const std::string& id) const {
+        return this->routers.at(id);
+    }
+
+    const tinyxml2::XMLElement* enzyme(const std::string& eid) const {
+        return this->enzymes.at(eid);
+    }
+
+    const tinyxml2::XMLElement* reaction(const std::string& rid) const {
+        return this->reactions.at(rid);
+    }
+
+    /**
+     * @brief Returns the enzyme entry of the space cid that is located in the
+     * enzyme set esn.
+     */
+    const tinyxml2::XMLElement* space_enzyme(const std::string& cid, const std::string& eid, const std::string& esn) const {
+        return this->space_enzymes.at(space_enzyme_key(cid, eid, esn));
+    }
+
+    bool has_space(const std::string& cid) const {
+        return this->spaces.find(cid) != this->spaces.end();
+    }
+
+    bool has_reaction(const std::string& rid) const {
+        return this->reactions.find(rid) != this->reactions.end();
+    }
+
+    /**
+     * @brief Reads a boolean parameter, true when the text of the element is "true" in
+     * any case. A missing element or text is false.
+     */
+    static bool is_true(const tinyxml2::XMLElement* element) {
+        if (element == nullptr || element->GetText() == nullptr) return false;
+
+        std::string text = element->GetText();
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        return text == "true";
+    }
+
+private:
+    using Index = std::unordered_map<std::string, const tinyxml2::XMLElement*>;
+
+    tinyxml2::XMLDocument document;
+    Index spaces;
+    Index routers;
+    Index enzymes;
+    Index reactions;
+    Index space_enzymes;
+
+    explicit ParameterStore(const std::string& xml_file) {
+        tinyxml2::XMLError opened = this->document.LoadFile(xml_file.c_str());
+        assert(opened == tinyxml2::XML_SUCCESS);
+
+        const tinyxml2::XMLElement* root = this->document.RootElement();
+        index_section(root->FirstChildElement("spaces"), this->spaces);
+        index_section(root->FirstChildElement("routers"), this->routers);
+        index_section(root->FirstChildElement("enzymes"), this->enzymes);
+        index_section(root->FirstChildElement("reactions"), this->reactions);
+
+        // The same enzyme can be listed several times in a space, once for each enzyme set
+        for (const auto& space : this->spaces) {
+            const tinyxml2::XMLElement* space_enzymes_section = space.second->FirstChildElement("enzymes");
+            if (space_enzymes_section == nullptr) continue;
+
+            for (const tinyxml2::XMLElement* entry = space_enzymes_section->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+                const tinyxml2::XMLElement* address = entry->FirstChildElement("address");
+                if (address == nullptr) continue;
+
+                std::string key = space_enzyme_key(space.first, entry->Value(), address->Attribute("esn"));
+                this->space_enzymes.emplace(key, entry);
+            }
+        }
+    }
+
+    // Only the first element is kept when an id is repeated, as FirstChildElement(id) does.
+    static void index_section(const tinyxml2::XMLElement* section, Index& index) {
+        if (section == nullptr) return;
+
+        for (const tinyxml2::XMLElement* entry = section->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+            index.emplace(entry->Value(), entry);
+        }
+    }
+
+    // SBML ids can not contain ':', so it is safe to use it as separator
+    static std::string space_enzyme_key(const std::string& cid, const std::string& eid, const std::string& esn) {
+        return cid + ":" + eid + ":" + esn;
+    }
+
+    static std::map<std::string, std::unique_ptr<ParameterStore>>& registry() {
+        static std::map<std::string, std::unique_ptr<ParameterStore>> stores;
+        return stores;
+    }
+
+    static std::mutex& registry_mutex() {
+        static std::mutex m;
+        return m;
+    }
+};
+
+#endif //PMGBP_PDEVS_PARAMETER_STORE_HPP
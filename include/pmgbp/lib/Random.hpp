@@ -2,26 +2,172 @@
 #define BOOST_SIMULATION_PDEVS_RANDOMNUMBERS_H
 
 #include <random>
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
 using namespace std;
 
+/**
+ * @brief splitmix64 step, used to expand the seeds and to mix the stream ids.
+ */
+inline uint64_t splitmix64(uint64_t& x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief xoshiro256++ generator (Blackman and Vigna), it has 32 bytes of state and it
+ * satisfies the UniformRandomBitGenerator requirements, so it can be used with the standard
+ * distributions.
+ */
+class Xoshiro256pp {
+
+public:
+	using result_type = uint64_t;
+
+	Xoshiro256pp() { seed(0); }
+	explicit Xoshiro256pp(uint64_t s) { seed(s); }
+
+	static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		const uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+		const uint64_t t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+
+		return result;
+	}
+
+	void seed(uint64_t s) {
+		for (uint64_t& word : state) {
+			word = splitmix64(s);
+		}
+	}
+
+private:
+	uint64_t state[4];
+
+	static uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+/**
+ * @brief Master seed of the simulation and the independent streams derived from it.
+ * @details Each model seeds its generators with the stream of its unique name, so two runs
+ * with the same master seed are identical regardless of the models construction order.
+ * If the master seed is not set, it is drawn once from std::random_device.
+ */
+class RandomSeed {
+
+public:
+	static uint64_t master() {
+		uint64_t& seed = RandomSeed::master_seed();
+		if (!RandomSeed::is_set()) {
+			std::random_device rd;
+			seed = (uint64_t(rd()) << 32) | rd();
+			RandomSeed::is_set() = true;
+		}
+		return seed;
+	}
+
+	static void setMaster(uint64_t seed) {
+		RandomSeed::master_seed() = seed;
+		RandomSeed::is_set() = true;
+	}
+
+	/**
+	 * @brief Seed of the stream with the given name, a FNV-1a hash of the name is mixed with
+	 * the master seed.
+	 */
+	static uint64_t stream(const std::string& name) {
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (unsigned char c : name) {
+			hash = (hash ^ c) * 0x100000001b3ULL;
+		}
+
+		uint64_t x = RandomSeed::master() ^ hash;
+		return splitmix64(x);
+	}
+
+private:
+	static uint64_t& master_seed() {
+		static uint64_t seed = 0;
+		return seed;
+	}
+
+	static bool& is_set() {
+		static bool set = false;
+		return set;
+	}
+};
+
 template<class NumbType>
 class IntegerRandom {
 
 public:
 
 	IntegerRandom() = default;
-	IntegerRandom(std::mt19937::result_type s) : generator(s) {};
+	IntegerRandom(uint64_t s) : generator(s) {};
 	
 	NumbType drawNumber(NumbType a, NumbType b) {
 		return uniform_int_distribution<NumbType>(a, b)(generator);
 	}
 
-	void seed(std::mt19937::result_type s) {
+	/**
+	 * @brief Number of successes out of n independent trials with success probability p.
+	 */
+	NumbType drawBinomial(NumbType n, double p) {
+		if (n == 0 || p <= 0.0) return 0;
+		if (p >= 1.0) return n;
+		return binomial_distribution<NumbType>(n, p)(generator);
+	}
+
+	/**
+	 * @brief Splits n trials between the categories with probabilities p, the
+	 * probabilities must sum at most 1 and the trials of the remaining probability
+	 * are not assigned to any category.
+	 * @details The counts are drawn as a chain of conditional binomials, so the cost
+	 * depends on the number of categories and not on n.
+	 *
+	 * @param counts output vector, it is resized to the number of categories.
+	 */
+	void drawMultinomial(NumbType n, const vector<double>& p, vector<NumbType>& counts) {
+		counts.assign(p.size(), 0);
+
+		double remaining_p = 1.0;
+		for (size_t i = 0; i < p.size() && n > 0; ++i) {
+			if (p[i] <= 0.0) continue;
+
+			double conditional_p = remaining_p > p[i] ? p[i] / remaining_p : 1.0;
+			counts[i] = drawBinomial(n, conditional_p);
+			n -= counts[i];
+			remaining_p -= p[i];
+		}
+	}
+
+	template<class RandomIt>
+	void shuffle(RandomIt first, RandomIt last) {
+		std::shuffle(first, last, generator);
+	}
+
+	void seed(uint64_t s) {
 		generator.seed(s);
 	}
 
 private:
-	mt19937 generator;
+	Xoshiro256pp generator;
 };
 
 template<class NumbType>
@@ -30,18 +176,25 @@ class RealRandom {
 public:
 
 	RealRandom() = default;
-	RealRandom(std::mt19937::result_type s) : generator(s) {};
+	RealRandom(uint64_t s) : generator(s) {};
 	
 	NumbType drawNumber(NumbType a, NumbType b) {
 		return uniform_real_distribution<NumbType>(a, b)(generator);
 	}
 
-	void seed(std::mt19937::result_type s) {
+	/**
+	 * @brief Waiting time of a Poisson process with the given rate.
+	 */
+	NumbType drawExponential(NumbType rate) {
+		return exponential_distribution<NumbType>(rate)(generator);
+	}
+
+	void seed(uint64_t s) {
 		generator.seed(s);
 	}
 
 private:
-	mt19937 generator;
+	Xoshiro256pp generator;
 };
 
 #endif // BOOST_SIMULATION_PDEVS_RANDOMNUMBERS_H
\ No newline at end of file
@@ -0,0 +1,348 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_SERIALIZATION_HPP
+#define PMGBP_PDEVS_SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <ostream>
+#include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <pmgbp/lib/FlatMap.hpp>
+
+namespace pmgbp {
+namespace serialization {
+
+/**
+ * @brief Detects the types with a template<class ARCHIVE> void serialize(ARCHIVE&) member.
+ */
+template<class T, class ARCHIVE, class = void>
+struct has_serialize : std::false_type {};
+
+template<class T, class ARCHIVE>
+struct has_serialize<T, ARCHIVE, std::void_t<decltype(std::declval<T&>().serialize(std::declval<ARCHIVE&>()))>> : std::true_type {};
+
+/**
+ * @brief Detects the simulation time types, they have a static infinity() and are printed with <<.
+ */
+template<class T, class = void>
+struct is_time : std::false_type {};
+
+template<class T>
+struct is_time<T, std::void_t<decltype(T::infinity()), decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type {};
+
+/**
+ * @brief Detects the cadmium message bags, they are written as their messages.
+ */
+template<class T, class = void>
+struct has_messages : std::false_type {};
+
+template<class T>
+struct has_messages<T, std::void_t<decltype(std::declval<T&>().messages)>> : std::true_type {};
+
+/**
+ * @brief Binary archive that appends the values to a byte string.
+ * @details The values are written with the & operator, the same serialize member is used to
+ * write and to read a type:
+ *
+ *     template<class ARCHIVE>
+ *     void serialize(ARCHIVE& archive) { archive & this->id & this->amounts; }
+ *
+ * Trivially copyable values are copied as they are in memory, thus the bytes are only meant
+ * to be read by the same build in the same machine (the transports between the partitions
+ * of a simulation) and the checkpoints. Strings, vectors, lists, deques, sets, pairs, maps and
+ * flat maps are written as their size followed by their elements, tuples and message bags as
+ * their elements. The times are written as their text, as their internal representation
+ * is not always trivially copyable.
+ *
+ * The serialize members can check the direction with ARCHIVE::loading, to rebuild the
+ * values that are derived from the read ones.
+ */
+class writer {
+public:
+
+    static constexpr bool loading = false;
+
+    template<class T>
+    writer& operator&(const T& value) {
+        this->write(value);
+        return *this;
+    }
+
+    const std::string& bytes() const {
+        return this->buffer;
+    }
+
+    std::string release() {
+        return std::move(this->buffer);
+    }
+
+private:
+    std::string buffer;
+
+    template<class T>
+    void write(const T& value) {
+        if constexpr (has_serialize<T, writer>::value) {
+            // serialize is shared with the reader, it does not modify the value when writing
+            const_cast<T&>(value).serialize(*this);
+        } else if constexpr (is_time<T>::value) {
+            bool infinite = value == T::infinity();
+            std::ostringstream text;
+            if (!infinite) {
+                text << value;
+            }
+            this->write(infinite);
+            this->write(text.str());
+        } else if constexpr (has_messages<T>::value) {
+            this->write(value.messages);
+        } else {
+            static_assert(std::is_trivially_copyable<T>::value, "the type needs a serialize member");
+            this->buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+    void write_size(std::size_t size) {
+        this->write(static_cast<uint64_t>(size));
+    }
+
+    void write(const std::string& value) {
+        this->write_size(value.size());
+        this->buffer.append(value);
+    }
+
+    template<class A, class B>
+    void write(const std::pair<A, B>& value) {
+        this->write(value.first);
+        this->write(value.second);
+    }
+
+    template<class CONTAINER>
+    void write_elements(const CONTAINER& values) {
+        this->write_size(values.size());
+        for (const auto& value : values) {
+            this->write(value);
+        }
+    }
+
+    template<class T>
+    void write(const std::vector<T>& values) { this->write_elements(values); }
+
+    template<class T>
+    void write(const std::list<T>& values) { this->write_elements(values); }
+
+    template<class T>
+    void write(const std::deque<T>& values) { this->write_elements(values); }
+
+    template<class T>
+    void write(const std::set<T>& values) { this->write_elements(values); }
+
+    template<class K, class V>
+    void write(const std::map<K, V>& values) { this->write_elements(values); }
+
+    template<class... T>
+    void write(const std::tuple<T...>& values) {
+        std::apply([this](const T&... value) { (this->write(value), ...); }, values);
+    }
+
+    template<class K, class V>
+    void write(const FlatMap<K, V>& values) { this->write_elements(values); }
+};
+
+/**
+ * @brief Binary archive that reads the values written by the writer from a byte string.
+ * @details Reading past the end of the bytes throws std::runtime_error.
+ */
+class reader {
+public:
+
+    static constexpr bool loading = true;
+
+    explicit reader(const std::string& bytes) : data(bytes.data()), size(bytes.size()), position(0) {}
+
+    template<class T>
+    reader& operator&(T& value) {
+        this->read(value);
+        return *this;
+    }
+
+    bool done() const {
+        return this->position == this->size;
+    }
+
+private:
+    const char* data;
+    std::size_t size;
+    std::size_t position;
+
+    const char* take(std::size_t amount) {
+        if (amount > this->size - this->position) {
+            throw std::runtime_error("serialization: unexpected end of the bytes");
+        }
+        const char* result = this->data + this->position;
+        this->position += amount;
+        return result;
+    }
+
+    template<class T>
+    void read(T& value) {
+        if constexpr (has_serialize<T, reader>::value) {
+            value.serialize(*this);
+        } else if constexpr (is_time<T>::value) {
+            bool infinite;
+            std::string text;
+            this->read(infinite);
+            this->read(text);
+            value = infinite ? T::infinity() : T(text);
+        } else if constexpr (has_messages<T>::value) {
+            this->read(value.messages);
+        } else {
+            static_assert(std::is_trivially_copyable<T>::value, "the type needs a serialize member");
+            std::memcpy(&value, this->take(sizeof(T)), sizeof(T));
+        }
+    }
+
+    std::size_t read_size() {
+        uint64_t size;
+        this->read(size);
+        return static_cast<std::size_t>(size);
+    }
+
+    void read(std::string& value) {
+        std::size_t size = this->read_size();
+        value.assign(this->take(size), size);
+    }
+
+    template<class A, class B>
+    void read(std::pair<A, B>& value) {
+        this->read(value.first);
+        this->read(value.second);
+    }
+
+    template<class T>
+    void read(std::vector<T>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        values.reserve(std::min<std::size_t>(size, this->size - this->position));
+        for (std::size_t i = 0; i < size; ++i) {
+            T value;
+            this->read(value);
+            values.push_back(std::move(value));
+        }
+    }
+
+    template<class T>
+    void read(std::list<T>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            T value;
+            this->read(value);
+            values.push_back(std::move(value));
+        }
+    }
+
+    template<class T>
+    void read(std::deque<T>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            T value;
+            this->read(value);
+            values.push_back(std::move(value));
+        }
+    }
+
+    template<class T>
+    void read(std::set<T>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            T value;
+            this->read(value);
+            values.insert(values.end(), std::move(value));
+        }
+    }
+
+    template<class K, class V>
+    void read(std::map<K, V>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            std::pair<K, V> value;
+            this->read(value);
+            values.insert(values.end(), std::move(value));
+        }
+    }
+
+    template<class K, class V>
+    void read(FlatMap<K, V>& values) {
+        std::size_t size = this->read_size();
+        values.clear();
+        values.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            std::pair<K, V> value;
+            this->read(value);
+            values.insert(value);
+        }
+    }
+
+    template<class... T>
+    void read(std::tuple<T...>& values) {
+        std::apply([this](T&... value) { (this->read(value), ...); }, values);
+    }
+};
+
+/**
+ * @brief Writes a size, or checks that the read one is the same.
+ * @details The serialize members of the models only write their dynamic state and read it
+ * over a model built from the same parameters, the sizes of its parts must match.
+ */
+template<class ARCHIVE>
+void expect_size(ARCHIVE& archive, std::size_t size) {
+    uint64_t written = size;
+    archive & written;
+    if (written != size) {
+        throw std::runtime_error("serialization: the state does not match the model");
+    }
+}
+
+}
+}
+
+#endif //PMGBP_PDEVS_SERIALIZATION_HPP
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_STATEDELTA_HPP
+#define PMGBP_PDEVS_STATEDELTA_HPP
+
+#include <cstddef>
+#include <set>
+
+/**
+ * @brief Settings of the delta state logging of the models.
+ * @details With a keyframe interval of zero (the default) each logged state is the full model
+ * state. Otherwise a model logs its full state (a keyframe) once every keyframe interval
+ * transitions and only the entries changed by the transition in between (a delta), the
+ * trajectory is rebuilt by applying the deltas over the last keyframe.
+ *
+ * The interval is set once at the program start with StateDelta::setKeyframeInterval.
+ */
+class StateDelta {
+public:
+
+    /**
+     * @brief While a Snapshot is alive the states printed by its thread are full states, the
+     * snapshots write the whole model states whatever their last transition changed.
+     */
+    class Snapshot {
+    public:
+        Snapshot() {
+            ++StateDelta::snapshots();
+        }
+
+        ~Snapshot() {
+            --StateDelta::snapshots();
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+    };
+
+    static bool snapshot() {
+        return StateDelta::snapshots() > 0;
+    }
+
+    static bool enabled() {
+        return StateDelta::interval() > 0;
+    }
+
+    static std::size_t keyframeInterval() {
+        return StateDelta::interval();
+    }
+
+    static void setKeyframeInterval(std::size_t transitions) {
+        StateDelta::interval() = transitions;
+    }
+
+    /**
+     * @brief The next transition of every model logs a full state. A resumed run starts a new
+     * output, the deltas of the restored trackers would refer to states of the old one.
+     */
+    static void forceKeyframes() {
+        ++StateDelta::generation();
+    }
+
+    static std::size_t keyframeGeneration() {
+        return StateDelta::generation();
+    }
+
+private:
+    static std::size_t& interval() {
+        static std::size_t transitions = 0;
+        return transitions;
+    }
+
+    static std::size_t& generation() {
+        static std::size_t forced = 0;
+        return forced;
+    }
+
+    static std::size_t& snapshots() {
+        thread_local std::size_t alive = 0;
+        return alive;
+    }
+};
+
+/**
+ * @brief Keys of a model state changed by its last transition.
+ * @details The models call begin at the start of each transition and touch for each entry
+ * they change. The keys are only kept when the state of the transition is a delta.
+ */
+template<class KEY>
+class ChangeTracker {
+public:
+
+    /**
+     * @brief Starts the changes of a new transition.
+     */
+    void begin() {
+        if (this->kept) {
+            this->kept = false;
+            return;
+        }
+
+        // The first transition is a keyframe, the initial state is not always logged. The
+        // generation is not serialized, a restored tracker keeps the one of its new model
+        std::size_t interval = StateDelta::keyframeInterval();
+        bool forced = this->generation != StateDelta::keyframeGeneration();
+        this->generation = StateDelta::keyframeGeneration();
+        this->full = forced || interval == 0 || this->transitions % interval == 0;
+        this->keys.clear();
+        ++this->transitions;
+    }
+
+    /**
+     * @brief Keeps the current changes in the next begin, the confluence transitions log
+     * the changes of their internal and external transitions together.
+     */
+    void keep() {
+        this->kept = true;
+    }
+
+    void touch(const KEY& key) {
+        if (!this->full) {
+            this->keys.insert(key);
+        }
+    }
+
+    /**
+     * @brief True if the state must be logged in full.
+     */
+    bool keyframe() const {
+        return this->full || StateDelta::snapshot();
+    }
+
+    const std::set<KEY>& changed() const {
+        return this->keys;
+    }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->keys & this->transitions & this->full & this->kept;
+    }
+
+private:
+    std::set<KEY> keys;
+    std::size_t transitions = 0;
+    std::size_t generation = StateDelta::keyframeGeneration();
+    bool full = true;
+    bool kept = false;
+};
+
+#endif //PMGBP_PDEVS_STATEDELTA_HPP
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_SYMBOL_TABLE_HPP
+#define PMGBP_PDEVS_SYMBOL_TABLE_HPP
+
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+/**
+ * @brief Bidirectional mapping between names and dense integer ids.
+ * @details The ids are assigned in insertion order starting from 0, so they can be
+ * used to index vectors. The names are only needed to parse the model and to print
+ * the results, the simulation compares and copies the ids.
+ *
+ * The tables are shared by the models built and run on several threads (the compartment
+ * kernels of the parallel engines), so the lookups take a shared lock and intern takes
+ * an exclusive one only when it adds a name.
+ */
+class SymbolTable {
+public:
+    using id_type = uint32_t;
+
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /**
+     * @brief Returns the id of the name, assigning a new one if it was not interned before.
+     */
+    id_type intern(const std::string& name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(this->mutex);
+            auto it = this->ids.find(name);
+            if (it != this->ids.end()) {
+                return it->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(this->mutex);
+        auto inserted = this->ids.insert({name, static_cast<id_type>(this->names.size())});
+        if (inserted.second) {
+            this->names.push_back(name);
+        }
+        return inserted.first->second;
+    }
+
+    /**
+     * @brief Returns the id of an already interned name.
+     * @throw std::out_of_range if the name was not interned.
+     */
+    id_type at(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        auto it = this->ids.find(name);
+        if (it == this->ids.end()) {
+            throw std::out_of_range("SymbolTable: unknown name " + name);
+        }
+        return it->second;
+    }
+
+    bool contains(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        return this->ids.find(name) != this->ids.end();
+    }
+
+    const std::string& name(id_type id) const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        assert(id < this->names.size());
+        return this->names[id];
+    }
+
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        return this->names.size();
+    }
+
+private:
+    // A deque keeps the references returned by name() valid when new names are interned
+    std::deque<std::string> names;
+    std::unordered_map<std::string, id_type> ids;
+    mutable std::shared_mutex mutex;
+};
+
+#endif //PMGBP_PDEVS_SYMBOL_TABLE_HPP
@@ -6,8 +6,13 @@
 #define PMGBP_PDEVS_TASKSCHEDULER_HPP
 
 #include <list>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <type_traits>
 #include <algorithm>
 #include <iostream>
+#include <cassert>
 
 template <class TIME, class ELEMENT>
 struct Tasks {
@@ -20,40 +25,151 @@ struct Tasks {
         this->time_left = time;
         this->task_elements.push_back(task_element);
     }
+
+    Tasks(TIME time, std::list<ELEMENT> elements) {
+        this->time_left = time;
+        this->task_elements = std::move(elements);
+    }
+};
+
+/**
+ * @brief Detects if the scheduled elements have a kind member (as the space Task does)
+ * to index them by kind.
+ */
+template <class ELEMENT, class = void>
+struct has_kind : std::false_type {};
+
+template <class ELEMENT>
+struct has_kind<ELEMENT, std::void_t<decltype(std::declval<const ELEMENT&>().kind)>> : std::true_type {};
+
+/**
+ * @brief Detects if the scheduled elements have a std::hash.
+ */
+template <class ELEMENT, class = void>
+struct is_hashable : std::false_type {};
+
+template <class ELEMENT>
+struct is_hashable<ELEMENT, std::enable_if_t<std::is_default_constructible<std::hash<ELEMENT>>::value>> : std::true_type {};
+
+/**
+ * @brief Hash of the elements in the index, std::hash when they have one and their kind
+ * otherwise (the equal elements have the same kind). The elements of the same kind share the
+ * hash, which suits the space tasks where only a few tasks of each kind are pending.
+ */
+template <class ELEMENT, bool = is_hashable<ELEMENT>::value>
+struct ElementHash {
+    std::size_t operator()(const ELEMENT& element) const {
+        return std::hash<ELEMENT>()(element);
+    }
+};
+
+template <class ELEMENT>
+struct ElementHash<ELEMENT, false> {
+    std::size_t operator()(const ELEMENT& element) const {
+        return std::hash<std::decay_t<decltype(element.kind)>>()(element.kind);
+    }
+};
+
+/**
+ * @brief Times at which each distinct element is scheduled, with the amount of copies at each
+ * time. It is empty for the elements without kind nor std::hash.
+ */
+template <class TIME, class ELEMENT, bool = has_kind<ELEMENT>::value || is_hashable<ELEMENT>::value>
+class ElementIndex {
+public:
+    static constexpr bool indexed = false;
+
+    void insert(const TIME&, const ELEMENT&) {}
+    void erase(const TIME&, const ELEMENT&) {}
+    void clear() {}
+    bool exists(const ELEMENT&) const { return false; }
+    bool first_at(const TIME&, const ELEMENT&) const { return false; }
+};
+
+template <class TIME, class ELEMENT>
+class ElementIndex<TIME, ELEMENT, true> {
+public:
+    static constexpr bool indexed = true;
+
+    void insert(const TIME& time, const ELEMENT& element) {
+        ++this->times[element][time];
+    }
+
+    void erase(const TIME& time, const ELEMENT& element) {
+        typename Index::iterator entry = this->times.find(element);
+        assert(entry != this->times.end());
+
+        typename std::map<TIME, std::size_t>::iterator copies = entry->second.find(time);
+        assert(copies != entry->second.end());
+        if (--copies->second == 0) {
+            entry->second.erase(copies);
+        }
+        if (entry->second.empty()) {
+            this->times.erase(entry);
+        }
+    }
+
+    void clear() {
+        this->times.clear();
+    }
+
+    bool exists(const ELEMENT& element) const {
+        return this->times.find(element) != this->times.end();
+    }
+
+    /**
+     * @brief True if the earliest time of the element is time.
+     */
+    bool first_at(const TIME& time, const ELEMENT& element) const {
+        typename Index::const_iterator entry = this->times.find(element);
+        return entry != this->times.end() && entry->second.begin()->first == time;
+    }
+
+private:
+    using Index = std::unordered_map<ELEMENT, std::map<TIME, std::size_t>, ElementHash<ELEMENT>>;
+
+    Index times;
 };
 
+/**
+ * @brief Scheduler of tasks with a time to be executed.
+ * @details The tasks are stored by absolute time in an ordered map of time buckets, the elapsed
+ * time is only accumulated in the current time. Thus, update is O(1), add is O(log n) and the
+ * next tasks are always the first bucket. The scheduler also keeps the times of each distinct
+ * element, hashed with std::hash or by their kind member: exists is a single hash lookup and
+ * is_in_next compares the earliest time of the element with the first bucket. The elements
+ * without kind nor std::hash (the enzyme and reaction output bags, never checked) are not
+ * indexed, their checks scan the buckets.
+ */
 template <class TIME, class ELEMENT>
 class TaskScheduler {
 public:
     using T = Tasks<TIME, ELEMENT>;
 
-    TaskScheduler() = default;
+    TaskScheduler() : current_time({0}) {}
 
     void add(TIME time_left, ELEMENT element) {
         assert(time_left >= TIME({0}));
 
-        typename std::list<T>::iterator insert_it = this->tasks_queue.begin();
-        while(insert_it != this->tasks_queue.end() && insert_it->time_left < time_left) {
-            ++insert_it;
-        }
-
-        if(insert_it != this->tasks_queue.end() && insert_it->time_left == time_left) {
-            insert_it->task_elements.push_back(element);
-        } else {
-            this->tasks_queue.insert(insert_it, T(time_left, element));
-        }
+        TIME time = this->current_time + time_left;
+        this->index.insert(time, element);
+        this->tasks_queue[time].push_back(std::move(element));
     }
 
     void pop() {
         if(!this->tasks_queue.empty()) {
-            this->tasks_queue.pop_front();
+            typename std::map<TIME, std::list<ELEMENT>>::iterator first = this->tasks_queue.begin();
+            for (const ELEMENT& element : first->second) {
+                this->index.erase(first->first, element);
+            }
+            this->tasks_queue.erase(first);
         }
     }
 
     const std::list<ELEMENT>& next() const {
 
         if (!this->tasks_queue.empty()) {
-            return this->tasks_queue.front().task_elements;
+            return this->tasks_queue.begin()->second;
         }
         return this->empty_task.task_elements;
     }
@@ -62,51 +178,87 @@ public:
         if(this->tasks_queue.empty()) {
             return TIME::infinity();
         }
-        return this->tasks_queue.front().time_left;
+        return this->tasks_queue.begin()->first - this->current_time;
     }
 
     void update(TIME elapsed_time) {
         assert(elapsed_time <= this->time_advance());
-
-        typename std::list<T>::iterator it;
-        for(it = this->tasks_queue.begin(); it != this->tasks_queue.end(); ++it) {
-            it->time_left -= elapsed_time;
-        }
+        this->current_time += elapsed_time;
     }
 
     void advance() {
-        TIME time_to_advance = this->time_advance();
-        this->pop();
-        this->update(time_to_advance);
+        if(!this->tasks_queue.empty()) {
+            this->current_time = this->tasks_queue.begin()->first;
+            this->pop();
+        }
     }
 
     bool is_in_next(const ELEMENT& elem) const {
-
-        std::list<ELEMENT> next_tasks = this->next();
-        return std::find(next_tasks.begin(), next_tasks.end(), elem) != next_tasks.end();
+        if (this->tasks_queue.empty()) {
+            return false;
+        }
+        if (ElementIndex<TIME, ELEMENT>::indexed) {
+            return this->index.first_at(this->tasks_queue.begin()->first, elem);
+        }
+        return this->in_list(this->tasks_queue.begin()->second, elem);
     }
 
     bool exists(const ELEMENT& elem) const {
-
-        typename std::list<T>::const_iterator it;
-
-        for (it = this->tasks_queue.cbegin(); it != this->tasks_queue.cend(); ++it) {
-            if (std::find(it->task_elements.begin(),
-                          it->task_elements.end(),
-                          elem) != it->task_elements.end()) {
+        if (ElementIndex<TIME, ELEMENT>::indexed) {
+            return this->index.exists(elem);
+        }
+        for (const auto& bucket : this->tasks_queue) {
+            if (this->in_list(bucket.second, elem)) {
                 return true;
             }
         }
         return false;
     }
 
-    const typename std::list<T>& queue() const {
-        return this->tasks_queue;
+    /**
+     * @brief Returns a copy of the scheduled tasks with their time left, ordered by time.
+     * @details It is intended for logging, the scheduler does not store the tasks in this form.
+     */
+    std::list<T> queue() const {
+        std::list<T> result;
+        for (const auto& bucket : this->tasks_queue) {
+            result.emplace_back(bucket.first - this->current_time, bucket.second);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the time elapsed since the scheduler creation.
+     */
+    const TIME& now() const {
+        return this->current_time;
+    }
+
+    /**
+     * @brief Writes or reads the scheduled tasks, the element index is rebuilt when reading.
+     */
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->current_time & this->tasks_queue;
+        if (ARCHIVE::loading) {
+            this->index.clear();
+            for (const auto& bucket : this->tasks_queue) {
+                for (const ELEMENT& element : bucket.second) {
+                    this->index.insert(bucket.first, element);
+                }
+            }
+        }
     }
 
 private:
     T empty_task;
-    typename std::list<T> tasks_queue;
+    TIME current_time;
+    std::map<TIME, std::list<ELEMENT>> tasks_queue;
+    ElementIndex<TIME, ELEMENT> index;
+
+    bool in_list(const std::list<ELEMENT>& elements, const ELEMENT& elem) const {
+        return std::find(elements.begin(), elements.end(), elem) != elements.end();
+    }
 };
 
 #endif //PMGBP_PDEVS_TASKSCHEDULER_HPP
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_TAULEAPING_HPP
+#define PMGBP_PDEVS_TAULEAPING_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @brief Settings of the tau leaping selection of the spaces.
+ * @details With epsilon zero (the default) each enzyme species binds with the probabilities of
+ * the metabolites left by the previous one. Otherwise the enzyme species that don't consume a
+ * critical species leap: all of them draw their binomial counts together from the probabilities
+ * at the start of the leap, and the probabilities are only recomputed between the leaps. The
+ * selection interval is split in the fewest leaps that keep the expected consumption of every
+ * species in a leap under epsilon times its amount (the leap condition).
+ *
+ * A species is critical if it has less than CRITICAL_AMOUNT metabolites or if it needs more than
+ * MAX_LEAPS leaps, the enzyme species consuming it keep the exact selection.
+ *
+ * The epsilon is set once at the program start with TauLeaping::setEpsilon.
+ */
+class TauLeaping {
+public:
+
+    static constexpr uint64_t CRITICAL_AMOUNT = 10;
+    static constexpr std::size_t MAX_LEAPS = 64;
+
+    static bool enabled() {
+        return TauLeaping::epsilon_value() > 0.0;
+    }
+
+    static double epsilon() {
+        return TauLeaping::epsilon_value();
+    }
+
+    static void setEpsilon(double epsilon) {
+        TauLeaping::epsilon_value() = epsilon;
+    }
+
+    /**
+     * @brief Leaps needed by a species with the amount and the expected consumption in the
+     * whole interval, each leap can consume epsilon times the amount or at least one metabolite.
+     * @return A value greater than MAX_LEAPS if the species is critical.
+     */
+    static std::size_t leaps(long double expected, long double amount) {
+        long double bound = std::max<long double>(TauLeaping::epsilon() * amount, 1.0);
+        long double needed = std::ceil(expected / bound);
+        if (!(needed <= MAX_LEAPS)) {
+            return MAX_LEAPS + 1;
+        }
+        return std::max<std::size_t>(1, std::size_t(needed));
+    }
+
+    /**
+     * @brief Probability of binding in one of the leaps of the interval, for an enzyme that
+     * binds in the whole interval with the given probability.
+     */
+    static double leapProbability(double interval_probability, std::size_t leaps) {
+        if (interval_probability >= 1.0 || leaps <= 1) {
+            return std::min(interval_probability, 1.0);
+        }
+        return -std::expm1(std::log1p(-interval_probability) / double(leaps));
+    }
+
+private:
+    static double& epsilon_value() {
+        static double epsilon = 0.0;
+        return epsilon;
+    }
+};
+
+#endif //PMGBP_PDEVS_TAULEAPING_HPP
@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_THREADPOOL_HPP
+#define PMGBP_PDEVS_THREADPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+/**
+ * @brief Fixed size pool of threads to run the iterations of a loop in parallel.
+ * @details parallel_for splits the range in chunks of grain iterations and the workers and the
+ * calling thread take the chunks from a shared counter until the range is exhausted, thus a
+ * thread that finishes early keeps taking the chunks of the slow ones. A parallel_for called
+ * from inside another one runs sequentially in the calling thread. The first exception thrown
+ * by an iteration is rethrown in the calling thread once all the chunks are done.
+ *
+ * The pool shared by all the models is reached with ThreadPool::shared() and its size is set
+ * once at the program start with ThreadPool::setThreads (1 by default, no extra threads). The
+ * models run their loops in ThreadPool::current(), which is the shared pool unless the calling
+ * thread set its own pool with a Scope: a pool runs a single loop at a time, thus the threads
+ * that run models concurrently (the logical processes) would take turns in the shared pool.
+ */
+class ThreadPool {
+public:
+
+    explicit ThreadPool(std::size_t threads) {
+        for (std::size_t i = 1; i < std::max<std::size_t>(threads, 1); ++i) {
+            this->workers.emplace_back([this]() { this->work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief While a Scope is alive, ThreadPool::current() returns its pool in the thread
+     * that built it.
+     */
+    class Scope {
+    public:
+        explicit Scope(ThreadPool& pool) : previous(ThreadPool::scoped()) {
+            ThreadPool::scoped() = &pool;
+        }
+
+        ~Scope() {
+            ThreadPool::scoped() = this->previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ThreadPool* previous;
+    };
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Amount of threads running the loops, the calling thread included.
+     */
+    std::size_t size() const {
+        return this->workers.size() + 1;
+    }
+
+    /**
+     * @brief Calls body(i) for each i in [begin, end), the calls run in any order and thread.
+     */
+    template<class BODY>
+    void parallel_for(std::size_t begin, std::size_t end, BODY&& body, std::size_t grain = 1) {
+        grain = std::max<std::size_t>(grain, 1);
+        if (end <= begin) {
+            return;
+        }
+
+        if (this->workers.empty() || end - begin <= grain || ThreadPool::inside_loop()) {
+            for (std::size_t i = begin; i < end; ++i) {
+                body(i);
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> loop_lock(this->loop_mutex);
+
+        Loop loop;
+        loop.next = begin;
+        loop.end = end;
+        loop.grain = grain;
+        loop.body = [&body](std::size_t i) { body(i); };
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->loop = &loop;
+            this->busy = this->workers.size();
+            ++this->generation;
+        }
+        this->wake.notify_all();
+
+        ThreadPool::run(loop);
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->done.wait(lock, [this]() { return this->busy == 0; });
+            this->loop = nullptr;
+        }
+
+        if (loop.error) {
+            std::rethrow_exception(loop.error);
+        }
+    }
+
+    static ThreadPool& shared() {
+        std::unique_ptr<ThreadPool>& pool = ThreadPool::shared_pool();
+        if (!pool) {
+            pool.reset(new ThreadPool(1));
+        }
+        return *pool;
+    }
+
+    /**
+     * @brief Pool of the loops called from this thread, the one of its innermost Scope or the
+     * shared pool.
+     */
+    static ThreadPool& current() {
+        ThreadPool* pool = ThreadPool::scoped();
+        return pool != nullptr ? *pool : ThreadPool::shared();
+    }
+
+    /**
+     * @brief Replaces the shared pool, it must not be called while a loop is running.
+     */
+    static void setThreads(std::size_t threads) {
+        ThreadPool::shared_pool().reset(new ThreadPool(threads));
+    }
+
+    /**
+     * @brief Amount of hardware threads, or 1 when it is unknown.
+     */
+    static std::size_t hardwareThreads() {
+        return std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    }
+
+private:
+
+    struct Loop {
+        std::atomic<std::size_t> next;
+        std::size_t end;
+        std::size_t grain;
+        std::function<void(std::size_t)> body;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex loop_mutex; // a single loop at a time when several threads share the pool
+    std::condition_variable wake;
+    std::condition_variable done;
+    Loop* loop = nullptr;
+    std::size_t busy = 0;
+    std::size_t generation = 0;
+    bool stopping = false;
+
+    void work() {
+        std::size_t seen = 0;
+        while (true) {
+            Loop* current;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->wake.wait(lock, [this, seen]() { return this->stopping || this->generation != seen; });
+                if (this->stopping) {
+                    return;
+                }
+                seen = this->generation;
+                current = this->loop;
+            }
+
+            ThreadPool::run(*current);
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                --this->busy;
+            }
+            this->done.notify_one();
+        }
+    }
+
+    static void run(Loop& loop) {
+        ThreadPool::inside_loop() = true;
+        while (true) {
+            std::size_t first = loop.next.fetch_add(loop.grain);
+            if (first >= loop.end) {
+                break;
+            }
+
+            std::size_t last = std::min(first + loop.grain, loop.end);
+            try {
+                for (std::size_t i = first; i < last; ++i) {
+                    loop.body(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(loop.error_mutex);
+                if (!loop.error) {
+                    loop.error = std::current_exception();
+                }
+            }
+        }
+        ThreadPool::inside_loop() = false;
+    }
+
+    static bool& inside_loop() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    static ThreadPool*& scoped() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static std::unique_ptr<ThreadPool>& shared_pool() {
+        static std::unique_ptr<ThreadPool> pool;
+        return pool;
+    }
+};
+
+#endif //PMGBP_PDEVS_THREADPOOL_HPP
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_TIMETEXT_HPP
+#define PMGBP_PDEVS_TIMETEXT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+namespace pmgbp {
+namespace time_text {
+
+/**
+ * @brief Nanoseconds of a time written as hh[:mm[:ss[:ms[:us[:ns]]]]], as in the parameters
+ * and the printed NDTime.
+ * @details Throws std::invalid_argument if a field is empty or not a natural number, or if
+ * there are more than max_fields fields.
+ */
+inline int64_t nanoseconds(const std::string& text, std::size_t max_fields = 6) {
+    static const int64_t units[] = {3600000000000LL, 60000000000LL, 1000000000LL, 1000000LL, 1000LL, 1LL};
+
+    std::istringstream fields(text);
+    std::string field;
+    std::size_t count = 0;
+    int64_t result = 0;
+    while (std::getline(fields, field, ':')) {
+        if (field.empty() || field.size() > 9 || field.find_first_not_of("0123456789") != std::string::npos || count >= max_fields || count >= 6) {
+            throw std::invalid_argument("wrong time: " + text);
+        }
+        result += std::stoll(field) * units[count++];
+    }
+    if (count == 0) {
+        throw std::invalid_argument("wrong time: " + text);
+    }
+    return result;
+}
+
+/**
+ * @brief Seconds of a time written as hh[:mm[:ss[:ms[:us[:ns]]]]].
+ */
+inline double seconds(const std::string& text) {
+    return double(nanoseconds(text)) * 1e-9;
+}
+
+}
+}
+
+#endif //PMGBP_PDEVS_TIMETEXT_HPP
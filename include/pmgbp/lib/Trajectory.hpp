@@ -0,0 +1,312 @@
+/**
+ * Copyright (c) 2017, Laouen Mayal Louan Belloli
+ * Carleton University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PMGBP_PDEVS_TRAJECTORY_HPP
+#define PMGBP_PDEVS_TRAJECTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <stdexcept>
+
+namespace pmgbp {
+namespace trajectory {
+
+/**
+ * @brief Binary trajectory file of (time, model, species, amount) records.
+ * @details The file is a header followed by chunks that are only appended:
+ *
+ *     header   "PMGBPTRJ" uint32 version
+ *     model    uint8 1, uint32 id, uint32 size, char name[size]
+ *     species  uint8 2, uint32 id, uint32 size, char name[size]
+ *     block    uint8 3, uint32 count, int64 time[count], uint32 model[count],
+ *              uint32 species[count], int64 amount[count]
+ *
+ * The model and species names are dictionary encoded, each one is written once before the
+ * first block using it and the ids are given in order from 0. The blocks store the records by
+ * columns and the times are in nanoseconds. The numbers are little endian as written by the
+ * x86 and ARM hosts.
+ */
+static const char MAGIC[8] = {'P', 'M', 'G', 'B', 'P', 'T', 'R', 'J'};
+static const uint32_t VERSION = 1;
+
+enum class chunk : uint8_t { MODEL = 1, SPECIES = 2, BLOCK = 3 };
+
+/**
+ * @brief Records of a block stored by columns.
+ */
+struct columns {
+    std::vector<int64_t> time;
+    std::vector<uint32_t> model;
+    std::vector<uint32_t> species;
+    std::vector<int64_t> amount;
+
+    std::size_t size() const {
+        return this->time.size();
+    }
+
+    void clear() {
+        this->time.clear();
+        this->model.clear();
+        this->species.clear();
+        this->amount.clear();
+    }
+
+    void push_back(int64_t time, uint32_t model, uint32_t species, int64_t amount) {
+        this->time.push_back(time);
+        this->model.push_back(model);
+        this->species.push_back(species);
+        this->amount.push_back(amount);
+    }
+};
+
+/**
+ * @brief Buffered writer of a trajectory file.
+ * @details The records are kept in a block of block_size records and written when it is full,
+ * on flush and on destruction. The dictionary entries created since the last block are written
+ * just before it, thus a file cut by a crash still has all the names of its complete blocks.
+ */
+class writer {
+public:
+
+    static const std::size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+
+    explicit writer(const std::string& path, std::size_t block_size = DEFAULT_BLOCK_SIZE)
+            : file(path, std::ios::binary | std::ios::trunc), block_size(block_size == 0 ? 1 : block_size) {
+        if (!this->file) {
+            throw std::runtime_error("Unable to open the trajectory file " + path);
+        }
+        this->file.write(MAGIC, sizeof(MAGIC));
+        this->write_raw(VERSION);
+    }
+
+    writer(const writer&) = delete;
+    writer& operator=(const writer&) = delete;
+
+    ~writer() {
+        try {
+            this->flush();
+        } catch (...) {}
+    }
+
+    /**
+     * @brief Dictionary id of the model name.
+     */
+    uint32_t model(const std::string& name) {
+        return this->intern(this->model_ids, chunk::MODEL, name);
+    }
+
+    /**
+     * @brief Dictionary id of the species name.
+     */
+    uint32_t species(const std::string& name) {
+        return this->intern(this->species_ids, chunk::SPECIES, name);
+    }
+
+    void append(int64_t time, uint32_t model, uint32_t species, int64_t amount) {
+        this->block.push_back(time, model, species, amount);
+        ++this->written;
+        if (this->block.size() >= this->block_size) {
+            this->flush();
+        }
+    }
+
+    /**
+     * @brief Writes the pending dictionary entries and records.
+     */
+    void flush() {
+        this->file.write(this->dictionary.data(), this->dictionary.size());
+        this->dictionary.clear();
+
+        if (this->block.size() > 0) {
+            this->write_raw(chunk::BLOCK);
+            this->write_raw(uint32_t(this->block.size()));
+            this->write_column(this->block.time);
+            this->write_column(this->block.model);
+            this->write_column(this->block.species);
+            this->write_column(this->block.amount);
+            this->block.clear();
+        }
+
+        this->file.flush();
+        if (!this->file) {
+            throw std::runtime_error("Unable to write the trajectory file");
+        }
+    }
+
+    std::size_t records() const {
+        return this->written;
+    }
+
+private:
+    std::ofstream file;
+    std::size_t block_size;
+    std::size_t written = 0;
+    columns block;
+    std::string dictionary; // entries not written yet
+    std::unordered_map<std::string, uint32_t> model_ids;
+    std::unordered_map<std::string, uint32_t> species_ids;
+
+    uint32_t intern(std::unordered_map<std::string, uint32_t>& ids, chunk kind, const std::string& name) {
+        auto inserted = ids.insert({name, uint32_t(ids.size())});
+        if (inserted.second) {
+            uint32_t id = inserted.first->second;
+            uint32_t size = uint32_t(name.size());
+            this->dictionary.push_back(char(kind));
+            this->dictionary.append(reinterpret_cast<const char*>(&id), sizeof(id));
+            this->dictionary.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            this->dictionary.append(name);
+        }
+        return inserted.first->second;
+    }
+
+    template<class T>
+    void write_raw(const T& value) {
+        this->file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<class T>
+    void write_column(const std::vector<T>& values) {
+        this->file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+};
+
+/**
+ * @brief Reader of a trajectory file, block by block or all at once.
+ * @details A wrong header or a chunk cut in the middle throws std::runtime_error.
+ */
+class reader {
+public:
+
+    explicit reader(const std::string& path) : file(path, std::ios::binary) {
+        if (!this->file) {
+            throw std::runtime_error("Unable to open the trajectory file " + path);
+        }
+
+        char magic[sizeof(MAGIC)];
+        uint32_t version = 0;
+        if (!this->file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a trajectory file " + path);
+        }
+        this->read_raw(version);
+        if (version != VERSION) {
+            throw std::runtime_error("Unsupported trajectory version " + std::to_string(version));
+        }
+    }
+
+    /**
+     * @brief Reads the next block of records, the dictionary entries before it are added
+     * to the model and species names.
+     * @return False at the end of the file.
+     */
+    bool next(columns& block) {
+        block.clear();
+
+        uint8_t kind;
+        while (this->file.read(reinterpret_cast<char*>(&kind), sizeof(kind))) {
+            if (kind == uint8_t(chunk::MODEL) || kind == uint8_t(chunk::SPECIES)) {
+                this->read_name(kind == uint8_t(chunk::MODEL) ? this->model_names : this->species_names);
+            } else if (kind == uint8_t(chunk::BLOCK)) {
+                uint32_t count;
+                this->read_raw(count);
+                this->read_column(block.time, count);
+                this->read_column(block.model, count);
+                this->read_column(block.species, count);
+                this->read_column(block.amount, count);
+                return true;
+            } else {
+                throw std::runtime_error("Unknown trajectory chunk " + std::to_string(kind));
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reads all the remaining records.
+     */
+    columns read_all() {
+        columns result;
+        columns block;
+        while (this->next(block)) {
+            result.time.insert(result.time.end(), block.time.begin(), block.time.end());
+            result.model.insert(result.model.end(), block.model.begin(), block.model.end());
+            result.species.insert(result.species.end(), block.species.begin(), block.species.end());
+            result.amount.insert(result.amount.end(), block.amount.begin(), block.amount.end());
+        }
+        return result;
+    }
+
+    const std::vector<std::string>& models() const {
+        return this->model_names;
+    }
+
+    const std::vector<std::string>& species() const {
+        return this->species_names;
+    }
+
+private:
+    std::ifstream file;
+    std::vector<std::string> model_names;
+    std::vector<std::string> species_names;
+
+    template<class T>
+    void read_raw(T& value) {
+        if (!this->file.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw std::runtime_error("Truncated trajectory file");
+        }
+    }
+
+    template<class T>
+    void read_column(std::vector<T>& values, uint32_t count) {
+        values.resize(count);
+        if (!this->file.read(reinterpret_cast<char*>(values.data()), std::streamsize(count) * sizeof(T))) {
+            throw std::runtime_error("Truncated trajectory file");
+        }
+    }
+
+    void read_name(std::vector<std::string>& names) {
+        uint32_t id, size;
+        this->read_raw(id);
+        this->read_raw(size);
+        std::string name(size, '\0');
+        if (size > 0 && !this->file.read(&name[0], size)) {
+            throw std::runtime_error("Truncated trajectory file");
+        }
+        if (id != names.size()) {
+            throw std::runtime_error("Unordered trajectory dictionary");
+        }
+        names.push_back(name);
+    }
+};
+
+}
+}
+
+#endif //PMGBP_PDEVS_TRAJECTORY_HPP
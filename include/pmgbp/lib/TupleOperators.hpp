@@ -6,6 +6,7 @@
 #define PMGBP_PDEVS_TUPLE_OPERATORS_HPP
 
 #include <tuple>
+#include <utility>
 #include <cadmium/modeling/message_bag.hpp>
 #include <cassert>
 #include <iostream>
@@ -81,42 +82,41 @@ std::ostream& print(std::ostream& os, const std::tuple<Ts...> &t) {
 /**************** GET ********************/
 /*****************************************/
 
-template<int index, typename T, typename... Ts>
-struct get_tuple {
-    cadmium::bag<T>& operator()(std::tuple<Ts...> &t, int position) {
-
-        if (position == index) {
-            return std::get<index>(t).messages;
-        }
+/**
+ * The bag of each position is reached through a table of accessors generated at compile time,
+ * thus get and cget cost the same for any position, even in tuples with hundreds of ports.
+ */
 
-        if (position < index) {
-            return get_tuple<index - 1, T, Ts...>{}(t, position);
-        }
+template<std::size_t index, typename T, typename... Ts>
+cadmium::bag<T>& get_bag(std::tuple<Ts...> &t) {
+    return std::get<index>(t).messages;
+}
 
-        throw Exception("Index value out of range (position > index): "
-                        + std::to_string(position)
-                        + " > "
-                        + std::to_string(index));
-    }
-};
+template<std::size_t index, typename T, typename... Ts>
+const cadmium::bag<T>& cget_bag(const std::tuple<Ts...> &t) {
+    return std::get<index>(t).messages;
+}
 
-template<typename T, typename... Ts>
-struct get_tuple<0, T, Ts...> {
-    cadmium::bag<T>& operator()(std::tuple<Ts...> &t, int position) {
-        if (position == 0) {
-            return std::get<0>(t).messages;
-        }
+template<typename T, typename... Ts, std::size_t... Is>
+cadmium::bag<T>& get_tuple(std::tuple<Ts...> &t, int position, std::index_sequence<Is...>) {
+    using accessor = cadmium::bag<T>& (*)(std::tuple<Ts...> &);
+    static constexpr accessor accessors[] = { &get_bag<Is, T, Ts...>... };
+    return accessors[position](t);
+}
 
-        throw Exception("Index value out of range (position > index): " + std::to_string(position) + " > 0");
-    }
-};
+template<typename T, typename... Ts, std::size_t... Is>
+const cadmium::bag<T>& cget_tuple(const std::tuple<Ts...> &t, int position, std::index_sequence<Is...>) {
+    using accessor = const cadmium::bag<T>& (*)(const std::tuple<Ts...> &);
+    static constexpr accessor accessors[] = { &cget_bag<Is, T, Ts...>... };
+    return accessors[position](t);
+}
 
 template<typename T, typename... Ts>
 cadmium::bag<T>& get(std::tuple<Ts...> &t, int position) {
 
-    const auto size = std::tuple_size<std::tuple<Ts...>>::value;
-    if (position < size) {
-        return get_tuple<size - 1, T, Ts...>{}(t, position);
+    const int size = std::tuple_size<std::tuple<Ts...>>::value;
+    if (position >= 0 && position < size) {
+        return get_tuple<T>(t, position, std::index_sequence_for<Ts...>{});
     }
 
     throw Exception("Index value out of range (position > bag_size: "
@@ -125,42 +125,12 @@ cadmium::bag<T>& get(std::tuple<Ts...> &t, int position) {
                                  + std::to_string(size - 1));
 }
 
-template<int index, typename T, typename... Ts>
-struct cget_tuple {
-    const cadmium::bag<T>& operator()(const std::tuple<Ts...> &t, int position) {
-
-        if (position == index) {
-            return std::get<index>(t).messages;
-        }
-
-        if (position < index) {
-            return cget_tuple<index - 1, T, Ts...>{}(t, position);
-        }
-
-        throw Exception("Index value out of range (position > index): "
-                        + std::to_string(position)
-                        + " > "
-                        + std::to_string(index));
-    }
-};
-
-template<typename T, typename... Ts>
-struct cget_tuple<0, T, Ts...> {
-    const cadmium::bag<T>& operator()(const std::tuple<Ts...> &t, int position) {
-        if (position == 0) {
-            return std::get<0>(t).messages;
-        }
-
-        throw Exception("Index value out of range (position > index): " + std::to_string(position) + " > 0");
-    }
-};
-
 template<typename T, typename... Ts>
 const cadmium::bag<T>& cget(const std::tuple<Ts...> &t, int position) {
 
-    const auto size = std::tuple_size<std::tuple<Ts...>>::value;
-    if (position < size) {
-        return cget_tuple<size - 1, T, Ts...>{}(t, position);
+    const int size = std::tuple_size<std::tuple<Ts...>>::value;
+    if (position >= 0 && position < size) {
+        return cget_tuple<T>(t, position, std::index_sequence_for<Ts...>{});
     }
 
     throw Exception("Index value out of range: "
@@ -0,0 +1,61 @@
+#ifndef PMGBP_GENERIC_SPACE_HPP
+#define PMGBP_GENERIC_SPACE_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <utility> // index_sequence
+
+#include <cadmium/modeling/ports.hpp>
+
+#include <pmgbp/structures/types.hpp>
+#include <pmgbp/atomics/space.hpp>
+
+/* The maximum amount of enzyme sets a space can send reactants to, it can be changed with
+ * the compile -D flag. The spaces of the generated models have exactly the ports they use.
+ */
+#ifndef PMGBP_MAX_SPACE_PORTS
+#define PMGBP_MAX_SPACE_PORTS 32
+#endif
+
+namespace pmgbp {
+namespace structs {
+namespace generic_space {
+
+template<std::size_t INDEX>
+struct out: public cadmium::out_port<pmgbp::types::Reactant>{};
+
+template<class INDEXES>
+struct make_output_ports;
+
+template<std::size_t... INDEXES>
+struct make_output_ports<std::index_sequence<INDEXES...>> {
+    using type=std::tuple<out<INDEXES>...>;
+};
+
+/**
+ * @brief Ports of a space that is built at runtime, the same port types are shared by all
+ * the spaces and the output port number is the one of the space routing table.
+ */
+struct generic_space_ports {
+
+    struct in_0_product: public cadmium::in_port<pmgbp::types::Product>{};
+    struct in_0_information: public cadmium::in_port<pmgbp::types::Information>{};
+
+    using reactant_type=pmgbp::types::Reactant;
+    using product_type=pmgbp::types::Product;
+    using information_type=pmgbp::types::Information;
+
+    static constexpr std::size_t output_port_amount = PMGBP_MAX_SPACE_PORTS;
+
+    using input_ports=std::tuple<in_0_product, in_0_information>;
+    using output_ports=typename make_output_ports<std::make_index_sequence<output_port_amount>>::type;
+};
+
+}
+}
+}
+
+template<typename TIME>
+using generic_space = pmgbp::models::space<pmgbp::structs::generic_space::generic_space_ports, TIME>;
+
+#endif //PMGBP_GENERIC_SPACE_HPP
@@ -0,0 +1,252 @@
+#ifndef PMGBP_MODEL_HPP
+#define PMGBP_MODEL_HPP
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+
+#include <pmgbp/structures/layout.hpp>
+
+#include <pmgbp/atomics/enzyme.hpp>
+#include <pmgbp/atomics/compartment.hpp>
+#include <pmgbp/model_generator/generic_space.hpp>
+#include <pmgbp/model_generator/enzyme_set.hpp>
+
+#include <NDTime.hpp>
+
+/******************** Links *********************/
+
+template<std::size_t PORT>
+cadmium::dynamic::modeling::IC make_space_enzyme_set_ic(const std::string& space_id, const std::string& enzyme_set_id) {
+    return cadmium::dynamic::translate::make_IC<pmgbp::structs::generic_space::out<PORT>, pmgbp::models::enzyme_ports::in_0>(space_id, enzyme_set_id);
+}
+
+template<std::size_t... PORTS>
+cadmium::dynamic::modeling::IC make_space_enzyme_set_ic(int port, const std::string& space_id, const std::string& enzyme_set_id, std::index_sequence<PORTS...>) {
+    using maker = cadmium::dynamic::modeling::IC (*)(const std::string&, const std::string&);
+    static constexpr maker makers[] = { &make_space_enzyme_set_ic<PORTS>... };
+
+    if (port < 0 || port >= int(sizeof...(PORTS))) {
+        throw std::invalid_argument("The space " + space_id + " uses the port " + std::to_string(port)
+                                    + ", compile with a greater PMGBP_MAX_SPACE_PORTS");
+    }
+    return makers[port](space_id, enzyme_set_id);
+}
+
+cadmium::dynamic::modeling::ICs make_enzyme_set_space_ics(int port, const std::string& enzyme_set_id, const std::string& space_id) {
+    using namespace pmgbp::models;
+    using generic_space_ports = pmgbp::structs::generic_space::generic_space_ports;
+
+    switch(port) {
+    case 0: return {
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_0_product, generic_space_ports::in_0_product>(enzyme_set_id, space_id),
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_0_information, generic_space_ports::in_0_information>(enzyme_set_id, space_id)
+    };
+    case 1: return {
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_1_product, generic_space_ports::in_0_product>(enzyme_set_id, space_id),
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_1_information, generic_space_ports::in_0_information>(enzyme_set_id, space_id)
+    };
+    case 2: return {
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_2_product, generic_space_ports::in_0_product>(enzyme_set_id, space_id),
+        cadmium::dynamic::translate::make_IC<enzyme_ports::out_2_information, generic_space_ports::in_0_information>(enzyme_set_id, space_id)
+    };
+    default:
+        throw std::invalid_argument("The enzyme set " + enzyme_set_id + " uses the output port " + std::to_string(port)
+                                    + ", enzymes have only 3 output ports");
+    }
+}
+
+/**
+ * @brief Links the compartment kernel from to the kernel to, the kernel to receives all the
+ * routed messages of from and keeps only its own.
+ */
+cadmium::dynamic::modeling::ICs make_compartment_ics(const std::string& from, const std::string& to) {
+    using ports = pmgbp::models::compartment_ports;
+    return {
+        cadmium::dynamic::translate::make_IC<ports::out_reactant, ports::in_reactant>(from, to),
+        cadmium::dynamic::translate::make_IC<ports::out_product, ports::in_product>(from, to),
+        cadmium::dynamic::translate::make_IC<ports::out_information, ports::in_information>(from, to)
+    };
+}
+
+/******************** Model *********************/
+
+/**
+ * @brief Builds the whole cell model from the parameters xml file at runtime.
+ * @details All the spaces and enzyme sets are direct sub models of the top model, the
+ * compartment coupled models of the generated top.hpp are only a grouping and the messages
+ * follow the same paths without the extra coupled model hops. Thus, a single pmgbp binary
+ * runs any model generated by pmgbp_generate_model without compiling its top.hpp.
+ */
+std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> generate_model(std::string xml_parameter_path) {
+
+    const ParameterStore& parameters = ParameterStore::get(xml_parameter_path);
+    pmgbp::structs::layout::model_layout layout(parameters);
+
+    cadmium::dynamic::modeling::Models models;
+    cadmium::dynamic::modeling::ICs ics;
+
+    for (const std::string& space_id : layout.spaces) {
+        models.push_back(
+            cadmium::dynamic::translate::make_dynamic_atomic_model<generic_space, NDTime, const char*, const char*>(
+                space_id,
+                xml_parameter_path.c_str(),
+                space_id.c_str()
+            )
+        );
+    }
+
+    for (const auto& enzyme_set : layout.enzyme_sets) {
+        const std::string& cid = enzyme_set.first.first;
+        const std::string& esn = enzyme_set.first.second;
+        std::string enzyme_set_id = cid + '_' + esn;
+
+        models.push_back(make_enzyme_set(cid, esn, enzyme_set.second, xml_parameter_path));
+
+        for (const auto& link : layout.enzyme_set_links[enzyme_set.first]) {
+            if (!parameters.has_space(link.second)) continue;
+
+            for (cadmium::dynamic::modeling::IC& ic : make_enzyme_set_space_ics(link.first, enzyme_set_id, link.second)) {
+                ics.push_back(std::move(ic));
+            }
+        }
+    }
+
+    using output_ports = pmgbp::structs::generic_space::generic_space_ports::output_ports;
+    for (const auto& link : layout.space_links) {
+        std::string enzyme_set_id = std::get<2>(link).first + '_' + std::get<2>(link).second;
+        ics.push_back(make_space_enzyme_set_ic(std::get<1>(link), std::get<0>(link), enzyme_set_id,
+                                               std::make_index_sequence<std::tuple_size<output_ports>::value>{}));
+    }
+
+    return std::make_shared<cadmium::dynamic::modeling::coupled<NDTime>>(
+        "cell",
+        models,
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::EICs{},
+        cadmium::dynamic::modeling::EOCs{},
+        ics
+    );
+}
+
+/**
+ * @brief Builds the cell model with one compartment kernel atomic model for each space.
+ * @details Each kernel runs a space and the enzyme sets of its compartment, thus only the
+ * messages between compartments go through the coupled model. The spaces and enzyme sets
+ * have the same trajectories they have in the model built by generate_model.
+ */
+std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> generate_fused_model(std::string xml_parameter_path) {
+    const ParameterStore& parameters = ParameterStore::get(xml_parameter_path);
+    pmgbp::structs::layout::model_layout layout(parameters);
+
+    cadmium::dynamic::modeling::Models models;
+    cadmium::dynamic::modeling::ICs ics;
+
+    for (const std::string& cid : layout.spaces) {
+        models.push_back(
+            cadmium::dynamic::translate::make_dynamic_atomic_model<pmgbp::models::compartment, NDTime, const char*, const char*>(
+                cid,
+                xml_parameter_path.c_str(),
+                cid.c_str()
+            )
+        );
+    }
+
+    // The compartments pairs that exchange messages: the reactants for the enzyme sets of other
+    // compartments and the products and information for the spaces of other compartments
+    std::set<std::pair<std::string, std::string>> linked;
+    for (const auto& link : layout.space_links) {
+        const std::string& cid = std::get<2>(link).first;
+        if (std::get<0>(link) == cid || !parameters.has_space(cid)) continue;
+
+        linked.insert({std::get<0>(link), cid});
+    }
+    for (const auto& enzyme_set : layout.enzyme_set_links) {
+        const std::string& cid = enzyme_set.first.first;
+        if (!parameters.has_space(cid)) continue;
+
+        for (const auto& link : enzyme_set.second) {
+            if (link.second == cid || !parameters.has_space(link.second)) continue;
+
+            linked.insert({cid, link.second});
+        }
+    }
+
+    for (const auto& link : linked) {
+        for (cadmium::dynamic::modeling::IC& ic : make_compartment_ics(link.first, link.second)) {
+            ics.push_back(std::move(ic));
+        }
+    }
+
+    return std::make_shared<cadmium::dynamic::modeling::coupled<NDTime>>(
+        "cell",
+        models,
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::EICs{},
+        cadmium::dynamic::modeling::EOCs{},
+        ics
+    );
+}
+
+/**
+ * @brief Writes or reads the state of the compartments of a model built by generate_fused_model,
+ * between the runner run_until calls. It is read over a model built from the same parameters.
+ * @details The runner does not expose the times of its atomic models: a resumed runner starts
+ * at the checkpoint time and measures the elapsed times from there, thus the clocks of the
+ * read compartments are moved to that time. Their schedules hold absolute times and are kept.
+ */
+template<class ARCHIVE>
+void serialize_fused(const std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>>& top_model, ARCHIVE& archive, const NDTime& time) {
+    using compartment_atomic = cadmium::dynamic::modeling::atomic<pmgbp::models::compartment, NDTime>;
+
+    std::vector<std::shared_ptr<compartment_atomic>> compartments;
+    for (const auto& sub_model : top_model->_models) {
+        if (auto compartment = std::dynamic_pointer_cast<compartment_atomic>(sub_model)) {
+            compartments.push_back(compartment);
+        }
+    }
+
+    pmgbp::serialization::expect_size(archive, compartments.size());
+    for (const std::shared_ptr<compartment_atomic>& compartment : compartments) {
+        compartment->serialize(archive);
+        if (ARCHIVE::loading) {
+            compartment->state.current_time = time;
+        }
+    }
+}
+
+/**
+ * @brief Calls f with the state of each space of a model built by generate_model or
+ * generate_fused_model, between the runner run_until calls.
+ */
+template<class F>
+void for_each_space(const std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>>& top_model, F f) {
+    using space_atomic = cadmium::dynamic::modeling::atomic<generic_space, NDTime>;
+    using compartment_atomic = cadmium::dynamic::modeling::atomic<pmgbp::models::compartment, NDTime>;
+
+    for (const auto& sub_model : top_model->_models) {
+        if (auto space = std::dynamic_pointer_cast<space_atomic>(sub_model)) {
+            f(space->state);
+        } else if (auto compartment = std::dynamic_pointer_cast<compartment_atomic>(sub_model)) {
+            f(compartment->state.space.state);
+        }
+    }
+}
+
+#endif //PMGBP_MODEL_HPP
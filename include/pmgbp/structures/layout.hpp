@@ -0,0 +1,148 @@
+//
+// Structure of the cell described by a parameters xml file.
+//
+
+#ifndef PMGBP_PDEVS_LAYOUT_STRUCTURES_HPP
+#define PMGBP_PDEVS_LAYOUT_STRUCTURES_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <tinyxml2.h>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+
+namespace pmgbp {
+namespace structs {
+namespace layout {
+
+/**
+ * @brief Structure of the model described by a parameters xml file.
+ * @details The spaces are the compartments of the spaces section. The enzyme sets and their
+ * enzymes are the addresses of the enzymes listed in the space of their own compartment. The
+ * links are taken from the routing tables: the space routing table gives the output port to
+ * each enzyme set and the routing table of the enzyme set reactions gives the compartment
+ * of each enzyme output port.
+ */
+struct model_layout {
+    using enzyme_set_key=std::pair<std::string, std::string>; // (cid, esn)
+
+    std::vector<std::string> spaces;
+    std::map<enzyme_set_key, std::vector<std::string>> enzyme_sets;
+    std::vector<std::tuple<std::string, int, enzyme_set_key>> space_links; // space, port, enzyme set
+    std::map<enzyme_set_key, std::map<int, std::string>> enzyme_set_links; // enzyme set, port -> space
+
+    explicit model_layout(const ParameterStore& parameters) {
+        const tinyxml2::XMLElement* spaces_section = parameters.root()->FirstChildElement("spaces");
+        if (spaces_section == nullptr) {
+            throw std::invalid_argument("The parameters have no spaces section");
+        }
+
+        for (const tinyxml2::XMLElement* space = spaces_section->FirstChildElement(); space != nullptr; space = space->NextSiblingElement()) {
+            this->spaces.push_back(space->Value());
+            this->load_enzyme_sets(parameters, space);
+        }
+
+        for (const tinyxml2::XMLElement* space = spaces_section->FirstChildElement(); space != nullptr; space = space->NextSiblingElement()) {
+            const tinyxml2::XMLElement* routing_table = space->FirstChildElement("routingTable");
+            if (routing_table == nullptr) continue;
+
+            for (const tinyxml2::XMLElement* entry = routing_table->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+                enzyme_set_key enzyme_set(entry->Attribute("cid"), entry->Attribute("esn"));
+                if (this->enzyme_sets.find(enzyme_set) == this->enzyme_sets.end()) continue; // no enzymes to react
+
+                this->space_links.emplace_back(space->Value(), std::stoi(entry->Attribute("port")), enzyme_set);
+            }
+        }
+    }
+
+    /**
+     * @brief Index of the compartment in the spaces section or -1 if there is no such space.
+     */
+    int compartment_index(const std::string& cid) const {
+        auto found = std::find(this->spaces.begin(), this->spaces.end(), cid);
+        return found == this->spaces.end() ? -1 : int(found - this->spaces.begin());
+    }
+
+    /**
+     * @brief The enzyme sets located in the compartment cid, ordered by their esn.
+     */
+    std::vector<enzyme_set_key> compartment_enzyme_sets(const std::string& cid) const {
+        std::vector<enzyme_set_key> result;
+        for (auto it = this->enzyme_sets.lower_bound({cid, ""}); it != this->enzyme_sets.end() && it->first.first == cid; ++it) {
+            result.push_back(it->first);
+        }
+        return result;
+    }
+
+private:
+
+    void load_enzyme_sets(const ParameterStore& parameters, const tinyxml2::XMLElement* space) {
+        std::string cid = space->Value();
+
+        const tinyxml2::XMLElement* enzymes = space->FirstChildElement("enzymes");
+        if (enzymes == nullptr) return;
+
+        for (const tinyxml2::XMLElement* enzyme = enzymes->FirstChildElement(); enzyme != nullptr; enzyme = enzyme->NextSiblingElement()) {
+            const tinyxml2::XMLElement* address = enzyme->FirstChildElement("address");
+
+            // Each enzyme is loaded from the space of its own compartment
+            if (address == nullptr || cid != address->Attribute("cid")) continue;
+
+            enzyme_set_key enzyme_set(cid, address->Attribute("esn"));
+            std::vector<std::string>& enzyme_ids = this->enzyme_sets[enzyme_set];
+            if (std::find(enzyme_ids.begin(), enzyme_ids.end(), enzyme->Value()) == enzyme_ids.end()) {
+                enzyme_ids.push_back(enzyme->Value());
+            }
+
+            const tinyxml2::XMLElement* reactions = enzyme->FirstChildElement("reactions");
+            if (reactions == nullptr) continue;
+
+            for (const tinyxml2::XMLElement* reaction = reactions->FirstChildElement(); reaction != nullptr; reaction = reaction->NextSiblingElement()) {
+                std::string rid = reaction->Attribute("id");
+                if (parameters.has_reaction(rid)) {
+                    this->load_enzyme_set_links(enzyme_set, parameters.reaction(rid));
+                }
+            }
+        }
+    }
+
+    void load_enzyme_set_links(const enzyme_set_key& enzyme_set, const tinyxml2::XMLElement* reaction) {
+
+        // species -> compartment
+        std::map<std::string, std::string> species_compartment;
+        const tinyxml2::XMLElement* stoichiometries = reaction->FirstChildElement("stoichiometryByCompartments");
+        for (const tinyxml2::XMLElement* compartment = stoichiometries->FirstChildElement(); compartment != nullptr; compartment = compartment->NextSiblingElement()) {
+            for (const tinyxml2::XMLElement* side = compartment->FirstChildElement(); side != nullptr; side = side->NextSiblingElement()) {
+                for (const tinyxml2::XMLElement* specie = side->FirstChildElement(); specie != nullptr; specie = specie->NextSiblingElement()) {
+                    species_compartment[specie->Attribute("id")] = compartment->Attribute("cid");
+                }
+            }
+        }
+
+        std::map<int, std::string>& links = this->enzyme_set_links[enzyme_set];
+        const tinyxml2::XMLElement* routing_table = reaction->FirstChildElement("routingTable");
+        for (const tinyxml2::XMLElement* entry = routing_table->FirstChildElement(); entry != nullptr; entry = entry->NextSiblingElement()) {
+            auto compartment = species_compartment.find(entry->Attribute("metaboliteId"));
+            if (compartment == species_compartment.end()) continue;
+
+            int port = std::stoi(entry->Attribute("port"));
+            auto link = links.insert({port, compartment->second});
+            if (link.first->second != compartment->second) {
+                throw std::invalid_argument("The enzyme set " + enzyme_set.first + "_" + enzyme_set.second
+                                            + " sends the port " + std::to_string(port) + " to two compartments");
+            }
+        }
+    }
+};
+
+}
+}
+}
+
+#endif //PMGBP_PDEVS_LAYOUT_STRUCTURES_HPP
@@ -13,6 +13,8 @@
 
 #include <pmgbp/lib/TupleOperators.hpp>
 
+#include <pmgbp/structures/symbols.hpp>
+
 namespace pmgbp {
 namespace structs {
 namespace space {
@@ -24,24 +26,35 @@ enum class Status {
 };
 
 struct EnzymeAddress {
-    std::string compartment;
-    std::string reaction_set;
+    pmgbp::symbols::cid compartment;
+    pmgbp::symbols::esn reaction_set;
 
     EnzymeAddress() {
-        this->compartment = "";
-        this->reaction_set = "";
+        this->compartment = 0;
+        this->reaction_set = 0;
     };
 
-    EnzymeAddress(const std::string& other_compartment, const std::string& other_reaction_set) {
+    EnzymeAddress(pmgbp::symbols::cid other_compartment, pmgbp::symbols::esn other_reaction_set) {
         this->compartment = other_compartment;
         this->reaction_set = other_reaction_set;
     }
 
+    /**
+     * @brief Constructs the address from the compartment and enzyme set names, the
+     * names are interned in the symbol tables.
+     */
+    EnzymeAddress(const std::string& other_compartment, const std::string& other_reaction_set) {
+        this->compartment = pmgbp::symbols::compartments().intern(other_compartment);
+        this->reaction_set = pmgbp::symbols::enzyme_sets().intern(other_reaction_set);
+    }
+
     EnzymeAddress(const EnzymeAddress& other) {
         this->compartment = other.compartment;
         this->reaction_set = other.reaction_set;
     }
 
+    EnzymeAddress& operator=(const EnzymeAddress& other) = default;
+
     inline bool operator==(const EnzymeAddress& o) const {
         return this->compartment == o.compartment && this->reaction_set == o.reaction_set;
     }
@@ -51,17 +64,26 @@ struct EnzymeAddress {
                 ((this->compartment == o.compartment) && (this->reaction_set < o.reaction_set));
     }
 
-    std::string str() const {
-        return this->compartment + "_" + this->reaction_set;
+    const std::string& compartment_name() const {
+        return pmgbp::symbols::compartments().name(this->compartment);
     }
 
-    bool empty() const {
-        return this->compartment.empty() && this->reaction_set.empty();
+    const std::string& reaction_set_name() const {
+        return pmgbp::symbols::enzyme_sets().name(this->reaction_set);
+    }
+
+    std::string str() const {
+        return this->compartment_name() + "_" + this->reaction_set_name();
     }
 
     void clear() {
-        this->compartment = "";
-        this->reaction_set = "";
+        this->compartment = 0;
+        this->reaction_set = 0;
+    }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & this->compartment & this->reaction_set;
     }
 };
 
@@ -95,6 +117,11 @@ struct Task {
 
         return result;
     }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & kind & message_bags;
+    }
 };
 
 /*******************************************/
@@ -0,0 +1,53 @@
+#ifndef PMGBP_PDEVS_SYMBOLS_STRUCTURES_HPP
+#define PMGBP_PDEVS_SYMBOLS_STRUCTURES_HPP
+
+#include <string>
+
+#include <pmgbp/lib/SymbolTable.hpp>
+
+namespace pmgbp {
+namespace symbols {
+
+/**
+ * Process-wide symbol tables, they are filled while the models are loaded from the
+ * parameters file. The ids are then used in all the messages and states instead of
+ * the names, see the README for the standard names.
+ */
+
+using id_type = SymbolTable::id_type;
+
+using sid = id_type; // species
+using rid = id_type; // reaction
+using cid = id_type; // compartment
+using eid = id_type; // enzyme
+using esn = id_type; // enzyme set name
+
+inline SymbolTable& species() {
+    static SymbolTable table;
+    return table;
+}
+
+inline SymbolTable& reactions() {
+    static SymbolTable table;
+    return table;
+}
+
+inline SymbolTable& compartments() {
+    static SymbolTable table;
+    return table;
+}
+
+inline SymbolTable& enzymes() {
+    static SymbolTable table;
+    return table;
+}
+
+inline SymbolTable& enzyme_sets() {
+    static SymbolTable table;
+    return table;
+}
+
+}
+}
+
+#endif //PMGBP_PDEVS_SYMBOLS_STRUCTURES_HPP
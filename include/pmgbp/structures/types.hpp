@@ -8,6 +8,8 @@
 #include <map>
 
 #include "space.hpp"
+#include "symbols.hpp"
+#include "../lib/FlatMap.hpp"
 
 namespace pmgbp {
 namespace types {
@@ -32,6 +34,33 @@ struct RoutingTable {
     }
 };
 
+/**
+ * @brief Routing table for entries that are dense integer ids (see symbols.hpp), the port is
+ * stored in a vector indexed by the id. It has the same interface than RoutingTable.
+ */
+template <class ENTRY>
+struct DenseRoutingTable {
+    std::vector<int> entries;
+
+    int at(const ENTRY& entry) const {
+
+        if (entry < entries.size()) {
+            return entries[entry];
+        } else {
+            return -1;
+        }
+    }
+
+    void insert(const ENTRY& entry, int port) {
+        if (entry >= entries.size()) {
+            entries.resize(entry + 1, -1);
+        }
+        if (entries[entry] < 0) {
+            entries[entry] = port;
+        }
+    }
+};
+
 /******************************************/
 /********** Enums and renames *************/
 /******************************************/
@@ -40,7 +69,7 @@ enum class BState_t { ENOUGH = 0, NOT_ENOUGH = 1, IDLE = 2, WAITING = 3 };
 enum class Way { STP, PTS };
 
 using Integer = unsigned long long;
-using MetaboliteAmounts = map<string, Integer>;
+using MetaboliteAmounts = FlatMap<pmgbp::symbols::sid, Integer>;
 
 /******************************************/
 /******** End enums and renames ***********/
@@ -67,19 +96,23 @@ struct Product {
     MetaboliteAmounts metabolites;
 
     bool operator==(const Product& other) const {
-        return metabolites.size() == other.metabolites.size() &&
-                std::equal(metabolites.begin(), metabolites.end(), other.metabolites.begin());
+        return metabolites == other.metabolites;
     }
 
     void clear() {
         metabolites.clear();
     }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & metabolites;
+    }
 };
 
 struct Reactant {
-    string rid;
-    string enzyme_id;
-    string from;
+    pmgbp::symbols::rid rid;
+    pmgbp::symbols::eid enzyme_id;
+    pmgbp::symbols::cid from;
     Way reaction_direction;
     Integer reaction_amount;
 
@@ -91,20 +124,26 @@ struct Reactant {
     }
 
     void clear() {
-        rid = "";
-        from = "";
+        rid = 0;
+        enzyme_id = 0;
+        from = 0;
         reaction_amount = 0;
     }
 };
 
 struct Information {
-    string enzyme_id;
+    pmgbp::symbols::eid enzyme_id;
     Integer released_enzymes;
     pmgbp::structs::space::EnzymeAddress location;
 
     bool operator==(const Information& other) const {
         return enzyme_id == other.enzyme_id && released_enzymes == other.released_enzymes && location == other.location;
     }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & enzyme_id & released_enzymes & location.compartment & location.reaction_set;
+    }
 };
 
 /*******************************************/
@@ -118,7 +157,7 @@ struct Information {
 
 struct ReactionInfo {
 
-  string id;
+  pmgbp::symbols::rid id;
   MetaboliteAmounts  substrate_sctry;
   MetaboliteAmounts  products_sctry;
   double konSTP = 1;
@@ -130,7 +169,7 @@ struct ReactionInfo {
   ReactionInfo() = default;
 
   ReactionInfo(
-    string other_id,
+    pmgbp::symbols::rid other_id,
     const MetaboliteAmounts& other_substrate_sctry,
     const MetaboliteAmounts& other_products_sctry,
     double other_konSTP,
@@ -158,7 +197,7 @@ struct ReactionInfo {
     reversible(other.reversible) {}
 
   void clear() {
-    id = "";
+    id = 0;
     substrate_sctry.clear();
     products_sctry.clear();
     konSTP = 0;
@@ -167,7 +206,7 @@ struct ReactionInfo {
   }
 
   bool empty() {
-    return (id == "") && substrate_sctry.empty() && products_sctry.empty();
+    return substrate_sctry.empty() && products_sctry.empty();
   }
 };
 
@@ -182,19 +221,19 @@ struct ReactionInfo {
 
 // TODO: Change name to EnzymeInformation
 struct Enzyme {
-    string id;
+    pmgbp::symbols::eid id;
     pmgbp::structs::space::EnzymeAddress location;
     Integer amount;
-    map<string, ReactionInfo> handled_reactions;
+    map<pmgbp::symbols::rid, ReactionInfo> handled_reactions;
 
     Enzyme()
-            : id(""), location(), amount(0), handled_reactions() {};
+            : id(0), location(), amount(0), handled_reactions() {};
 
     Enzyme(
-            const string& other_id,
+            pmgbp::symbols::eid other_id,
             const pmgbp::structs::space::EnzymeAddress& other_location,
             const Integer& other_amount,
-            const map<string, ReactionInfo>& other_handled_reactions
+            const map<pmgbp::symbols::rid, ReactionInfo>& other_handled_reactions
     )
             : id(other_id), location(other_location), amount(other_amount), handled_reactions(other_handled_reactions) {}
 
@@ -202,7 +241,7 @@ struct Enzyme {
             : id(other.id), location(other.location), amount(other.amount), handled_reactions(other.handled_reactions) {}
 
     void clear() {
-        id = "";
+        id = 0;
         location.clear();
         amount = 0;
         handled_reactions.clear();
@@ -228,4 +267,42 @@ std::ostream& operator<<(std::ostream& os, const pmgbp::types::Reactant& s);
 std::ostream& operator<<(std::ostream& os, const pmgbp::types::Information& s);
 std::ostream& operator<<(std::ostream& os, const pmgbp::types::Enzyme& e);
 
+namespace pmgbp {
+namespace types {
+
+/**
+ * @brief Message with a destination given at runtime, for the models that route the messages
+ * themselves instead of sending them through one typed port per destination (the compartment
+ * kernels). A space sends to the port to of its routing table, a kernel to the compartment to,
+ * its enzyme set at the position enzyme_set or its space if enzyme_set is -1. It is defined
+ * after the message printers, which print the routed message.
+ */
+template<class MESSAGE>
+struct Routed {
+    int to;
+    int enzyme_set;
+    MESSAGE message;
+
+    bool operator==(const Routed<MESSAGE>& other) const {
+        return to == other.to && enzyme_set == other.enzyme_set && message == other.message;
+    }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & to & enzyme_set & message;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Routed<MESSAGE>& r) {
+        os << "{";
+        os << "\"To\":" << r.to << ",";
+        os << "\"Enzyme_set\":" << r.enzyme_set << ",";
+        os << "\"Message\":" << r.message;
+        os << "}";
+        return os;
+    }
+};
+
+}
+}
+
 #endif // PMGBP_TYPES_HPP
\ No newline at end of file
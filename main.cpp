@@ -25,7 +25,11 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include <chrono>
+#include <algorithm>
+#include <memory>
+#include <functional>
 
 #include <cadmium/engine/pdevs_dynamic_runner.hpp>
 
@@ -34,7 +38,28 @@
 
 #include <memore/logger.hpp>
 
+#include <pmgbp/lib/AsyncSink.hpp>
+#include <pmgbp/lib/Checkpoint.hpp>
+#include <pmgbp/lib/ParameterStore.hpp>
+#include <pmgbp/lib/Random.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+#include <pmgbp/lib/Logger.hpp>
+#include <pmgbp/lib/Options.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
+#include <pmgbp/lib/ThreadPool.hpp>
+#include <pmgbp/lib/TauLeaping.hpp>
+#include <pmgbp/lib/Trajectory.hpp>
+
+// The generated top.hpp is only compiled with -DGENERATED_MODEL, otherwise the model is built from the xml
+#ifdef GENERATED_MODEL
 #include "top.hpp"
+#else
+#include <pmgbp/model_generator/model.hpp>
+#include <pmgbp/engines/conservative.hpp>
+#include <pmgbp/engines/next_reaction.hpp>
+#include <pmgbp/engines/time_warp.hpp>
+#include <pmgbp/engines/observer.hpp>
+#endif
 
 
 /*************** Loggers *******************/
@@ -52,21 +77,28 @@ mongocxx::instance instance{};
 namespace {  
 
     memore::sink memore_sink("pmgbp", "pmgbp", "simulation_results");
-    
+
+    // The loggers only queue the records, a background thread writes them to MongoDB in batches.
+    // It is created once the options are parsed and destroyed before memore_sink, flushing the queue.
+    std::unique_ptr<AsyncSink<memore::sink>> async_sink;
+
     struct sink_provider {
-        static memore::sink& sink() {
-            return memore_sink;
+        static AsyncSink<memore::sink>& sink() {
+            return *async_sink;
         }
     };
 }
 
 #else
 
-/************** cout sink ******************/
+/************** ostream sink ******************/
 namespace {
+    // std::cout unless the --output file option sets another stream
+    std::ostream* output_stream = &std::cout;
+
     struct sink_provider {
         static std::ostream& sink() {
-            return std::cout;
+            return *output_stream;
         }
     };
 }
@@ -84,13 +116,107 @@ using namespace std;
 using namespace pmgbp;
 using hclock=chrono::high_resolution_clock;
 
+/**
+ * @brief Calls f with the state of each atomic model of the coupled model, and of its coupled sub models.
+ */
+template<class F>
+void for_each_state(const std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>>& model, F f) {
+    for (const auto& sub_model : model->_models) {
+        if (auto atomic = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<NDTime>>(sub_model)) {
+            f(atomic->model_state_as_string());
+        } else if (auto coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<NDTime>>(sub_model)) {
+            for_each_state(coupled, f);
+        }
+    }
+}
+
+#ifndef GENERATED_MODEL
+/**
+ * @brief The compartments of a fused model, written and read by the checkpoints as an engine.
+ */
+struct fused_compartments {
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> top_model;
+    NDTime start_time; // time of the resumed checkpoint, the runner starts there
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        serialize_fused(this->top_model, archive, this->start_time);
+    }
+};
+#endif
+
+/**
+ * @brief First multiple of interval after time, infinity if the interval is infinity.
+ */
+NDTime next_stop(const NDTime& time, const NDTime& interval) {
+    NDTime result = interval;
+    while (result <= time) {
+        result += interval;
+    }
+    return result;
+}
+
+/**
+ * @brief Runs the simulation from start_time until end_time, stopping at each snapshot interval
+ * to write the model states, at each sample interval to sample the spaces and at each checkpoint
+ * interval to save the state, when they are set. The stops are the multiples of the intervals.
+ * The runner is the cadmium runner or one of the engines, snapshot, sample and checkpoint take
+ * the time of the stop. The sample is also taken at the start and at end_time and the checkpoint
+ * at end_time, where checkpoint also takes true.
+ */
+template<class RUNNER, class SNAPSHOT, class SAMPLE, class CHECKPOINT>
+void run(RUNNER& r, const NDTime& start_time, const NDTime& end_time, const Options& options, SNAPSHOT snapshot_states, SAMPLE sample, CHECKPOINT checkpoint) {
+    bool sampling = !options.sample_interval.empty();
+    bool checkpointing = !options.checkpoint_interval.empty();
+    NDTime snapshot_interval = options.snapshot_interval.empty() ? NDTime::infinity() : NDTime(options.snapshot_interval);
+    NDTime sample_interval = sampling ? NDTime(options.sample_interval) : NDTime::infinity();
+    NDTime checkpoint_interval = checkpointing ? NDTime(options.checkpoint_interval) : NDTime::infinity();
+    if (snapshot_interval <= NDTime::zero() || sample_interval <= NDTime::zero() || checkpoint_interval <= NDTime::zero()) {
+        std::cout << "The snapshot, sample and checkpoint intervals must be greater than zero" << std::endl;
+        exit(1);
+    }
+
+    if (sampling) {
+        sample(start_time);
+    }
+
+    NDTime snapshot = next_stop(start_time, snapshot_interval);
+    NDTime next_sample = next_stop(start_time, sample_interval);
+    NDTime next_checkpoint = next_stop(start_time, checkpoint_interval);
+    auto next_time = [&]() { return std::min(snapshot, std::min(next_sample, next_checkpoint)); };
+    for (NDTime next = next_time(); next < end_time; next = next_time()) {
+        r.run_until(next);
+        if (next == snapshot) {
+            snapshot_states(snapshot);
+            std::cout << "snapshot " << snapshot << std::endl;
+            snapshot += snapshot_interval;
+        }
+        if (next == next_sample) {
+            sample(next_sample);
+            next_sample += sample_interval;
+        }
+        if (next == next_checkpoint) {
+            checkpoint(next_checkpoint, false);
+            next_checkpoint += checkpoint_interval;
+        }
+    }
+    r.run_until(end_time);
+
+    if (sampling) {
+        sample(end_time);
+    }
+    if (checkpointing) {
+        checkpoint(end_time, true);
+    }
+}
+
 int main(int argc, char ** argv) {
 
     #ifdef DIAGRAM
 
         if (argc != 3) {
             std::cout << "Usage: " + std::string(argv[0]) + "<xml_parameters_path> <diagram_output_file>" << std::endl;
-            exit(0);
+            exit(1);
         }
 
         std::string xml_parameters_path = std::string(argv[1]);
@@ -99,45 +225,359 @@ int main(int argc, char ** argv) {
         std::ofstream file;
         file.open(json_file);
         std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> top_model = generate_model(xml_parameters_path);
+        ParameterStore::release(xml_parameters_path);
         dynamic_export_model_to_json<NDTime>(file, top_model);
         file.close();
 
     #else
 
-        if (argc != 3) {
-            std::cout << "Usage: " + std::string(argv[0]) + " <xml_parameters_path> <simulation_db_identifier>" << std::endl;
-            exit(0);
+        Options options;
+        try {
+            options = Options(argc, argv);
+        } catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+            std::cout << Options::usage(argv[0]) << std::endl;
+            exit(1);
+        }
+
+        std::string xml_parameters_path = options.xml_parameters_path;
+
+        // The cadmium runner does not expose the times of the atomic models of the coupled mode, the
+        // fused compartments and the engines hold the whole state of the simulation
+        std::string checkpoint_mode = Options::modeName(options.mode);
+        if ((!options.checkpoint_file.empty() || !options.resume_file.empty()) && options.mode == Options::Mode::COUPLED) {
+            std::cout << "The checkpoints are written and resumed by the fused, conservative, optimistic and ssa modes" << std::endl;
+            exit(1);
+        }
+
+        checkpoint::file resumed;
+        if (!options.resume_file.empty()) {
+            try {
+                resumed = checkpoint::file::read(options.resume_file);
+            } catch (const std::exception& e) {
+                std::cout << e.what() << std::endl;
+                exit(1);
+            }
+            if (resumed.mode != checkpoint_mode) {
+                std::cout << "The checkpoint " << options.resume_file << " was written by the " << resumed.mode << " mode" << std::endl;
+                exit(1);
+            }
+        }
+
+        // All the model random streams are derived from the master seed, the same seed reproduces the run.
+        // A resumed run restores the streams of the checkpoint, the seed is only kept for the next checkpoints.
+        if (!options.resume_file.empty()) {
+            RandomSeed::setMaster(resumed.seed);
+        } else if (options.has_seed) {
+            RandomSeed::setMaster(options.seed);
+        }
+        std::cout << "seed " << RandomSeed::master() << std::endl;
+
+        if (!options.log_level.empty()) {
+            Logger::Level level;
+            if (!Logger::parseLevel(options.log_level, level)) {
+                std::cout << "unknown log level " << options.log_level << std::endl;
+                exit(1);
+            }
+            Logger::setLevel(level);
+        }
+
+        // The enzyme transitions of each step run in parallel in the shared pool
+        ThreadPool::setThreads(options.threads == 0 ? ThreadPool::hardwareThreads() : options.threads);
+        std::cout << "threads " << ThreadPool::shared().size() << std::endl;
+
+        // The spaces leap over the binding probabilities of the species with many metabolites
+        TauLeaping::setEpsilon(options.tau_leap);
+        if (TauLeaping::enabled()) {
+            std::cout << "tau leaping epsilon " << TauLeaping::epsilon() << std::endl;
+        }
+
+        // Between the keyframes the models only log the entries changed by each transition
+        StateDelta::setKeyframeInterval(options.delta_keyframes);
+        if (StateDelta::enabled()) {
+            std::cout << "delta keyframes " << StateDelta::keyframeInterval() << std::endl;
         }
-        
-        std::string xml_parameters_path = std::string(argv[1]);
-        const char * simulation_db_identifier = argv[2];
 
         #ifdef MEMORE
-        // New custom collection used so Django or other platform can set the desired collection name to retrieve results
-        sink_provider::sink().new_collection(simulation_db_identifier);
+        if (options.output == Options::Output::DATABASE && !options.simulation_id.empty()) {
+            // New custom collection used so Django or other platform can set the desired collection name to retrieve results
+            memore_sink.new_collection(options.simulation_id);
+            async_sink.reset(new AsyncSink<memore::sink>(memore_sink, options.log_queue, options.log_batch));
+        } else if (options.output != Options::Output::NONE) {
+            std::cout << "This build logs to MeMoRe, use --output memore and a simulation_id" << std::endl;
+            exit(1);
+        }
+        #else
+        bool engine_mode = options.mode == Options::Mode::CONSERVATIVE || options.mode == Options::Mode::OPTIMISTIC || options.mode == Options::Mode::SSA;
+        std::ofstream output_file;
+        std::unique_ptr<trajectory::writer> trajectory_file;
+        if (options.output == Options::Output::FILE) {
+            output_file.open(options.output_file);
+            if (!output_file) {
+                std::cout << "Unable to open the output file " << options.output_file << std::endl;
+                exit(1);
+            }
+            output_stream = &output_file;
+        } else if (options.output == Options::Output::BINARY) {
+            // The cadmium runner logs the states as json, only the engines write the trajectory records
+            if (!engine_mode) {
+                std::cout << "The binary output is written by the conservative, optimistic and ssa modes" << std::endl;
+                exit(1);
+            }
+            try {
+                trajectory_file.reset(new trajectory::writer(options.output_file));
+            } catch (const std::exception& e) {
+                std::cout << e.what() << std::endl;
+                exit(1);
+            }
+        } else if (options.output == Options::Output::DATABASE) {
+            std::cout << "This build only logs to stdout, file or binary, compile with -D MEMORE for the memore output" << std::endl;
+            exit(1);
+        }
         #endif
         
+        // The samples of the spaces don't need the state loggers, they can be disabled with --output none
+        #ifdef GENERATED_MODEL
+        if (!options.sample_file.empty()) {
+            std::cout << "The samples need the model built from the xml, compile without -D GENERATED_MODEL" << std::endl;
+            exit(1);
+        }
+        #else
+        std::unique_ptr<engines::observer<NDTime>> samples;
+        if (!options.sample_file.empty()) {
+            try {
+                samples.reset(new engines::observer<NDTime>(options.sample_file));
+            } catch (const std::exception& e) {
+                std::cout << e.what() << std::endl;
+                exit(1);
+            }
+        }
+
+        // Sample function of a runner, for_each_space visits the space states of the runner
+        auto sampler = [&samples](auto for_each_space) {
+            return [&samples, for_each_space](const NDTime& time) {
+                for_each_space([&samples](const auto& space) { samples->add(space); });
+                samples->write(time);
+            };
+        };
+        #endif
+
+        // The snapshots are the full states of all the models, whatever the output and the delta logging
+        std::ofstream snapshot_file;
+        if (!options.snapshot_file.empty()) {
+            snapshot_file.open(options.snapshot_file);
+            if (!snapshot_file) {
+                std::cout << "Unable to open the snapshot file " << options.snapshot_file << std::endl;
+                exit(1);
+            }
+        }
+
+        // Snapshot function of a runner, for_each_state visits the model states of the runner
+        auto snapshotter = [&snapshot_file](auto for_each_state) {
+            return [&snapshot_file, for_each_state](const NDTime& time) {
+                StateDelta::Snapshot full;
+                for_each_state([&snapshot_file, &time](const auto& state) {
+                    std::ostringstream text;
+                    text << state;
+                    snapshot_file << time << " " << text.str() << "\n";
+                });
+                snapshot_file.flush();
+            };
+        };
+
         // Initialize model
         auto start = hclock::now();
-        
+        NDTime end_time(options.end_time);
+        NDTime start_time = options.resume_file.empty() ? NDTime::zero() : NDTime(resumed.time);
+        if (!(start_time < end_time)) {
+            std::cout << "The checkpoint at " << start_time << " is not before the end time " << end_time << std::endl;
+            exit(1);
+        }
+
+        // Reports the initialization time and runs the simulation with the runner of the mode
+        auto simulate = [&](auto& r, auto snapshot, auto sample, auto checkpoint) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1> > >(hclock::now() - start).count();
+            cout << "Model initialization took:" << elapsed << "sec" << endl;
+
+            start = hclock::now();
+            if (!options.resume_file.empty()) {
+                std::cout << "resume from " << start_time << std::endl;
+            }
+            std::cout << "run until " << end_time << std::endl;
+            try {
+                run(r, start_time, end_time, options, snapshot, sample, checkpoint);
+            } catch (const std::exception& e) {
+                // The engines write the states older than the failure before rethrowing it
+                #ifdef MEMORE
+                if (async_sink) async_sink->flush();
+                #else
+                output_stream->flush();
+                if (trajectory_file) trajectory_file->flush();
+                #endif
+                std::cout << "The simulation failed: " << e.what() << std::endl;
+                exit(1);
+            }
+            std::cout << "simulation finished" << std::endl;
+
+            elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1> > >(hclock::now() - start).count();
+            cout << "Simulation took:" << elapsed << "sec" << endl;
+        };
+
+        // Restores the checkpoint over the engine or the fused compartments, built from the same parameters
+        auto resume = [&options, &resumed](auto& engine) {
+            if (options.resume_file.empty()) {
+                return;
+            }
+            try {
+                pmgbp::serialization::reader state(resumed.state);
+                engine.serialize(state);
+            } catch (const std::exception& e) {
+                std::cout << "Unable to resume from " << options.resume_file << ": " << e.what() << std::endl;
+                exit(1);
+            }
+
+            // The output starts again at the checkpoint, the first state of each model is a keyframe
+            StateDelta::forceKeyframes();
+        };
+
+        // Saves the state of the engine at the checkpoint stops and at the end, --checkpoint-wall
+        // skips the stops until that many wall clock seconds passed since the last checkpoint
+        std::size_t checkpoints = 0;
+        auto checkpointer = [&options, &checkpoint_mode, &checkpoints](auto& engine) {
+            return [&options, &checkpoint_mode, &checkpoints, &engine, last = hclock::now()](const NDTime& time, bool end) mutable {
+                double wall = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1> > >(hclock::now() - last).count();
+                if (!end && wall < options.checkpoint_wall) {
+                    return;
+                }
+                pmgbp::serialization::writer state;
+                engine.serialize(state);
+
+                checkpoint::file saved;
+                saved.mode = checkpoint_mode;
+                saved.seed = RandomSeed::master();
+                std::ostringstream text;
+                text << time;
+                saved.time = text.str();
+                saved.state = state.release();
+                saved.write(options.checkpoint_file);
+
+                std::cout << "checkpoint " << time << std::endl;
+                ++checkpoints;
+                last = hclock::now();
+            };
+        };
+
         std::cout << "generate_model" << std::endl;
-        std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> top_model = generate_model(xml_parameters_path);
-        std::cout << "create runner" << std::endl;
-        cadmium::dynamic::engine::runner<NDTime, logger_top> r(top_model, NDTime({0}));        
-        
-        auto elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1> > >(hclock::now() - start).count();
-        cout << "Model initialization took:" << elapsed << "sec" << endl;        
+        if (options.mode == Options::Mode::CONSERVATIVE || options.mode == Options::Mode::OPTIMISTIC || options.mode == Options::Mode::SSA) {
+            #if defined(GENERATED_MODEL) || defined(MEMORE)
+            std::cout << "The conservative, optimistic and ssa modes build the model from the xml and log to stdout, file or binary,"
+                         " compile without -D GENERATED_MODEL and -D MEMORE" << std::endl;
+            exit(1);
+            #else
+            engines::state_sink<NDTime> sink;
+            if (trajectory_file) {
+                sink = engines::state_sink<NDTime>(*trajectory_file);
+            } else if (options.output != Options::Output::NONE) {
+                sink = engines::state_sink<NDTime>(sink_provider::sink());
+            }
+            if (options.mode == Options::Mode::CONSERVATIVE) {
+                // One thread per compartment, the logical processes synchronize with null messages
+                std::cout << "create conservative engine" << std::endl;
+                engines::conservative<NDTime> engine(xml_parameters_path, sink);
+                ParameterStore::release(xml_parameters_path);
+                std::cout << "compartments " << engine.size() << std::endl;
+                resume(engine);
+                simulate(engine, snapshotter([&engine](auto f) { engine.for_each_state(f); }),
+                         sampler([&engine](auto f) { engine.for_each_space(f); }), checkpointer(engine));
+            } else if (options.mode == Options::Mode::SSA) {
+                // Exact stochastic simulation of the reactions, without the enzyme and space models
+                std::cout << "create next reaction engine" << std::endl;
+                engines::next_reaction<NDTime> engine(xml_parameters_path, sink);
+                ParameterStore::release(xml_parameters_path);
+                std::cout << "reaction channels " << engine.channel_amount() << std::endl;
+                resume(engine);
+                simulate(engine, snapshotter([&engine](auto f) { engine.for_each_state(f); }),
+                         sampler([&engine](auto f) { engine.for_each_space(f); }), checkpointer(engine));
+                std::cout << "fired reactions " << engine.fired() << std::endl;
+            } else {
+                // One thread per compartment, the logical processes roll back on the stragglers
+                std::cout << "create optimistic engine" << std::endl;
+                engines::transport::kind transport = options.transport == Options::Transport::SOCKET ? engines::transport::kind::SOCKET : engines::transport::kind::SHARED_MEMORY;
+                engines::time_warp<NDTime> engine(xml_parameters_path, sink, transport);
+                ParameterStore::release(xml_parameters_path);
+                std::cout << "compartments " << engine.size() << std::endl;
+                resume(engine);
+                simulate(engine, snapshotter([&engine](auto f) { engine.for_each_state(f); }),
+                         sampler([&engine](auto f) { engine.for_each_space(f); }), checkpointer(engine));
+                std::cout << "rollbacks " << engine.rollbacks() << std::endl;
+            }
+            if (trajectory_file) {
+                trajectory_file->flush();
+                std::cout << "trajectory records " << trajectory_file->records() << std::endl;
+            }
+            #endif
+        } else {
+            std::shared_ptr<cadmium::dynamic::modeling::coupled<NDTime>> top_model;
+            if (options.mode == Options::Mode::FUSED) {
+                #ifdef GENERATED_MODEL
+                std::cout << "The fused mode builds the model from the xml, compile without -D GENERATED_MODEL" << std::endl;
+                exit(1);
+                #else
+                top_model = generate_fused_model(xml_parameters_path);
+                #endif
+            } else {
+                top_model = generate_model(xml_parameters_path);
+            }
+            // All the atomic models are built, the parsed parameters are not needed anymore
+            ParameterStore::release(xml_parameters_path);
+            std::cout << "create runner" << std::endl;
+            #ifdef GENERATED_MODEL
+            auto sample = [](const NDTime&) {};
+            #else
+            auto sample = sampler([&top_model](auto f) { for_each_space(top_model, f); });
+            #endif
+            auto snapshot = snapshotter([&top_model](auto f) { for_each_state(top_model, f); });
 
-        // Run simulation
-        start = hclock::now();
+            // Only the fused compartments are restored and saved, the runner starts at the checkpoint
+            std::function<void(const NDTime&, bool)> checkpoint = [](const NDTime&, bool) {};
+            #ifndef GENERATED_MODEL
+            fused_compartments compartments{top_model, start_time};
+            if (options.mode == Options::Mode::FUSED) {
+                resume(compartments);
+                checkpoint = checkpointer(compartments);
+            }
+            #endif
+            if (options.output == Options::Output::NONE) {
+                cadmium::dynamic::engine::runner<NDTime, cadmium::logger::not_logger> r(top_model, start_time);
+                simulate(r, snapshot, sample, checkpoint);
+            } else {
+                cadmium::dynamic::engine::runner<NDTime, logger_top> r(top_model, start_time);
+                simulate(r, snapshot, sample, checkpoint);
+            }
+        }
+
+        if (!options.checkpoint_file.empty()) {
+            std::cout << "checkpoints " << checkpoints << std::endl;
+        }
 
-        std::cout << "run until 3000:00:00" << std::endl;
-        r.run_until({3000});
-        std::cout << "simulation finished" << std::endl;
+        #ifdef MEMORE
+        if (async_sink) {
+            try {
+                async_sink->flush();
+            } catch (const std::exception& e) {
+                std::cout << "The memore output failed: " << e.what() << std::endl;
+                exit(1);
+            }
+            std::cout << "memore records " << async_sink->records() << " in " << async_sink->batches() << " batches" << std::endl;
+        }
+        #endif
+
+        #ifndef GENERATED_MODEL
+        if (samples) {
+            std::cout << "samples " << samples->size() << std::endl;
+        }
+        #endif
 
-        elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::ratio<1> > >(hclock::now() - start).count();
-        cout << "Simulation took:" << elapsed << "sec" << endl;
-    
     #endif
 
     return 0;
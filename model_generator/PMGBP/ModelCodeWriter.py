@@ -163,7 +163,7 @@ class ModelCodeWriter:
         )
 
     def write_enzyme_set(self, cid, esn, enzyme_ids):
-        enzyme_ids = '{ {"' + '"}, {"'.join(['", "'.join(ids) for ids in enzyme_ids]) + '"} }'
+        enzyme_ids = '{ "' + '", "'.join(enzyme_ids) + '" }'
 
         self.write(
             self.enzyme_set_template.format(
@@ -5,13 +5,6 @@ from .SBMLParser import SBMLParser
 from .ModelCodeWriter import ModelCodeWriter
 from .XMLParametersWriter import XMLParametersWriter
 from .constants import *
-from itertools import islice
-
-
-def chunks(data, SIZE=150):
-    it = iter(data)
-    for i in range(0, len(data), SIZE):
-        yield {k: data[k] for k in islice(it, SIZE)}
 
 
 class ModelStructure:
@@ -97,7 +90,6 @@ class ModelGenerator:
                  cytoplasm_id,
                  model_dir='..',
                  json_model=None,
-                 groups_size=150,
                  kon=0.8,
                  koff=0.8,
                  rates='0:0:0:1',
@@ -116,10 +108,8 @@ class ModelGenerator:
         the sbml file
         :param model_dir: Path to the directory where the generated model will be stored
         :param json_model: The parser exported as json. Optional, used to avoid re parsing
-        :param groups_size: The size of the reaction set groups
         """
 
-        self.groups_size = groups_size
         self.parameter_writer = XMLParametersWriter(model_dir=model_dir)
         self.coder = ModelCodeWriter(model_dir=model_dir)
         self.parser = SBMLParser(sbml_file,
@@ -169,32 +159,9 @@ class ModelGenerator:
                 for esn, enzyme_set in compartment.enzyme_sets.items()}
 
     def generate_enzyme_set(self, cid, esn, enzyme_set):
-        enzyme_set_id = '_'.join([cid, esn])
-
-        # Enzyme sets are separated in groups, this is because the C++ problem compiling large tuples
-        # Currently the maximum group amount is 150 and each group can hold 150 enzymes, thus, each compartment
-        # can have a maximum of 150 * 150 = 22500 enzymes.
-        groups = chunks(enzyme_set, SIZE=self.groups_size)
-        groups_enzyme_ids = []
-        routing_table = {}
-        
-        # Routers xml parameters
-        port = 0
-        for group in groups:
-            enzyme_ids = list(group.keys())
-            groups_enzyme_ids.append(enzyme_ids)
-
-            group_id = '_'.join([cid, esn, str(port)])
-            routing_table.update({eid: port for eid in enzyme_ids})
-            port += 1
-
-            port_numbers = range(len(enzyme_ids))
-            group_routing_table = {eid: port_number for eid, port_number in zip(enzyme_ids, port_numbers)}
-            self.parameter_writer.add_router(group_id, group_routing_table)
-
-        self.parameter_writer.add_router(enzyme_set_id, routing_table)
-
-        return self.coder.write_enzyme_set(cid, esn, groups_enzyme_ids)
+        # The enzyme set atomic model routes the reactants to its enzymes, thus, the enzymes are
+        # not split in groups and there is no router parameters to write.
+        return self.coder.write_enzyme_set(cid, esn, list(enzyme_set.keys()))
 
     def generate_organelle_compartment(self, compartment):
 
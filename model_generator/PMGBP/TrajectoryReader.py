@@ -0,0 +1,74 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+
+import struct
+
+import numpy as np
+import pandas as pd
+
+MAGIC = b'PMGBPTRJ'
+VERSION = 1
+
+MODEL = 1
+SPECIES = 2
+BLOCK = 3
+
+
+class TrajectoryReader:
+    """
+    Loads the binary trajectory files written by the simulator with --output binary.
+    The layout is the one of include/pmgbp/lib/Trajectory.hpp. With --delta-keyframes only the
+    changed amounts are recorded between the keyframes, the last amount of each model and
+    species holds until its next record.
+    """
+
+    def __init__(self, path):
+
+        self.path = path
+        self.models = []
+        self.species = []
+
+    def read(self):
+        """
+        Returns a DataFrame with the time (nanoseconds), model, species and amount columns.
+        """
+
+        with open(self.path, 'rb') as trajectory_file:
+            data = trajectory_file.read()
+
+        if data[:len(MAGIC)] != MAGIC:
+            raise ValueError('Not a trajectory file ' + self.path)
+        offset = len(MAGIC)
+        version, = struct.unpack_from('<I', data, offset)
+        if version != VERSION:
+            raise ValueError('Unsupported trajectory version ' + str(version))
+        offset += 4
+
+        times, models, species, amounts = [], [], [], []
+        while offset < len(data):
+            kind = data[offset]
+            offset += 1
+            if kind in (MODEL, SPECIES):
+                _, size = struct.unpack_from('<II', data, offset)
+                offset += 8
+                name = data[offset:offset + size].decode('utf-8')
+                offset += size
+                (self.models if kind == MODEL else self.species).append(name)
+            elif kind == BLOCK:
+                count, = struct.unpack_from('<I', data, offset)
+                offset += 4
+                for column, dtype in ((times, '<i8'), (models, '<u4'), (species, '<u4'), (amounts, '<i8')):
+                    column.append(np.frombuffer(data, dtype=dtype, count=count, offset=offset))
+                    offset += count * np.dtype(dtype).itemsize
+            else:
+                raise ValueError('Unknown trajectory chunk ' + str(kind))
+
+        def join(columns, dtype):
+            return np.concatenate(columns) if columns else np.array([], dtype=dtype)
+
+        return pd.DataFrame({
+            'time': join(times, '<i8'),
+            'model': pd.Categorical.from_codes(join(models, '<u4').astype(np.int64), categories=self.models),
+            'species': pd.Categorical.from_codes(join(species, '<u4').astype(np.int64), categories=self.species),
+            'amount': join(amounts, '<i8')
+        })
@@ -1,6 +1,6 @@
-/*************************** coupled model {{cid}} {{esn}} *******************************************/
+/*************************** enzyme set {{cid}} {{esn}} **********************************************/
 
-std::shared_ptr<cadmium::dynamic::modeling::coupled<{TIME}>> {{cid}}_{{esn}} = make_enzyme_set(
+std::shared_ptr<cadmium::dynamic::modeling::model> {{cid}}_{{esn}} = make_enzyme_set(
 	"{{cid}}",
 	"{{esn}}",
 	{{enzyme_ids}},
@@ -18,8 +18,8 @@ std::ostream& operator<<(std::ostream& os, const pmgbp::structs::space::Status&
 }
 
 std::ostream& operator<<(std::ostream& os, const pmgbp::structs::space::EnzymeAddress& s) {
-    os << "(cid: " << s.compartment;
-    os << ", esn: " << s.reaction_set << ")";
+    os << "(cid: " << s.compartment_name();
+    os << ", esn: " << s.reaction_set_name() << ")";
 
     return os;
 }
\ No newline at end of file
@@ -34,7 +34,7 @@ ostream& operator<<(ostream& os, const MetaboliteAmounts& m) {
     os << "[";
     auto i = m.cbegin();
     while(i != m.cend()){
-        os << i->second << "-" << i->first;
+        os << i->second << "-" << pmgbp::symbols::species().name(i->first);
         ++i;
         if (i != m.cend()) os << ", ";
     }
@@ -70,7 +70,7 @@ ostream& operator<<(ostream& os, const Way& s) {
 
 ostream& operator<<(ostream& os, const ReactionInfo& r) {
 
-    os << "id: " << r.id << endl;
+    os << "id: " << pmgbp::symbols::reactions().name(r.id) << endl;
     os << "substrates: " << r.substrate_sctry << endl;
     os << "products: " << r.products_sctry << endl;
     os << "KonSTP: " << r.konSTP << endl;
@@ -91,7 +91,7 @@ ostream& operator<<(ostream& os, const Product& p) {
         }
 
         os << "{";
-        os << "\"Id\":\"" << metabolite.first << "\",";
+        os << "\"Id\":\"" << pmgbp::symbols::species().name(metabolite.first) << "\",";
         os << "\"Amount\":" << metabolite.second;
         os << "}";
     }
@@ -105,8 +105,8 @@ ostream& operator<<(ostream& os, const Reactant& r) {
     os << "{";
     os << "\"Message_type\":\"reactant\",";
     os << "\"Reaction_amount\":" << r.reaction_amount;
-    os << "\"From\":\"" << r.from << "\",";
-    os << "\"For_reaction\":\"" << r.rid << "\",";
+    os << "\"From\":\"" << pmgbp::symbols::compartments().name(r.from) << "\",";
+    os << "\"For_reaction\":\"" << pmgbp::symbols::reactions().name(r.rid) << "\",";
     os << "\"Way\":\"" << r.reaction_direction << "\",";
     os << "}";
     return os;
@@ -115,7 +115,7 @@ ostream& operator<<(ostream& os, const Reactant& r) {
 ostream& operator<<(ostream& os, const Information& i) {
     os << "{";
     os << "\"Message_type\":\"information\",";
-    os << "\"Enzyme ID\":\"" << i.enzyme_id << "\",";
+    os << "\"Enzyme ID\":\"" << pmgbp::symbols::enzymes().name(i.enzyme_id) << "\",";
     os << "\"Released amount\":\"" << i.released_enzymes << "\",";
     os << "\"Location\":\"" << i.location << "\",";
     os << "}";
@@ -124,7 +124,7 @@ ostream& operator<<(ostream& os, const Information& i) {
 
 ostream& operator<<(ostream& os, const Enzyme& e) {
 
-    os << "id: " << e.id << endl;
+    os << "id: " << pmgbp::symbols::enzymes().name(e.id) << endl;
     os << "location: " << e.location << endl;
     os << "amount: " << e.amount << endl;
     os << "handled reactions: " << endl << endl;
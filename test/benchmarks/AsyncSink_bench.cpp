@@ -0,0 +1,75 @@
+//
+// Time the simulation thread spends logging to a slow sink, written inline or behind an AsyncSink.
+// Usage: AsyncSink_bench [records] [write_latency_us] [batch_size]
+//
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <iostream>
+
+#include <pmgbp/lib/AsyncSink.hpp>
+
+using hclock=std::chrono::high_resolution_clock;
+
+/**
+ * @brief Stand-in for the database, each write (a record or a batch) pays a round trip.
+ */
+struct LatencySink {
+    std::chrono::microseconds latency;
+    std::size_t records = 0;
+
+    explicit LatencySink(std::size_t latency_us) : latency(latency_us) {}
+
+    LatencySink& operator<<(const std::string&) {
+        std::this_thread::sleep_for(this->latency);
+        ++this->records;
+        return *this;
+    }
+
+    void write_batch(const std::vector<std::string>& batch) {
+        std::this_thread::sleep_for(this->latency);
+        this->records += batch.size();
+    }
+};
+
+double elapsed_ms(hclock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(hclock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+
+    std::size_t records = argc > 1 ? std::stoul(argv[1]) : 20000;
+    std::size_t latency = argc > 2 ? std::stoul(argv[2]) : 20;
+    std::size_t batch_size = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    std::string record(200, 'x');
+
+    LatencySink inline_sink(latency);
+    auto start = hclock::now();
+    for (std::size_t i = 0; i < records; ++i) {
+        inline_sink << record;
+    }
+    double inline_ms = elapsed_ms(start);
+
+    LatencySink downstream(latency);
+    double logging_ms, total_ms;
+    {
+        start = hclock::now();
+        AsyncSink<LatencySink> sink(downstream, 65536, batch_size);
+        for (std::size_t i = 0; i < records; ++i) {
+            sink << record;
+        }
+        logging_ms = elapsed_ms(start);
+        sink.flush();
+        total_ms = elapsed_ms(start);
+        std::cout << "batches " << sink.batches() << " full_waits " << sink.full_waits() << std::endl;
+    }
+
+    std::cout << "sink,logging_ms,total_ms,records" << std::endl;
+    std::cout << "inline," << inline_ms << "," << inline_ms << "," << inline_sink.records << std::endl;
+    std::cout << "async," << logging_ms << "," << total_ms << "," << downstream.records << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+//
+// Microbenchmark of the TaskScheduler against the former linked list implementation.
+// Usage: TaskScheduler_bench [max_pending_tasks]
+//
+
+#include <list>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <functional>
+#include <cassert>
+
+#include <NDTime.hpp>
+#include <pmgbp/lib/TaskScheduler.hpp>
+
+using hclock=std::chrono::high_resolution_clock;
+
+enum class Kind { SENDING, SELECTING };
+
+/**
+ * @brief Scheduled element similar to the space Task, hashed for the scheduler index.
+ */
+struct BenchTask {
+    Kind kind;
+    int value;
+
+    bool operator==(const BenchTask& o) const {
+        return kind == o.kind && value == o.value;
+    }
+};
+
+namespace std {
+    template<>
+    struct hash<BenchTask> {
+        std::size_t operator()(const BenchTask& task) const {
+            return std::hash<int>()(task.value) * 2 + std::size_t(task.kind);
+        }
+    };
+}
+
+/**
+ * @brief The list based TaskScheduler, the time left of every task is decreased on each update.
+ */
+template <class TIME, class ELEMENT>
+class ListTaskScheduler {
+public:
+    using T = Tasks<TIME, ELEMENT>;
+
+    void add(TIME time_left, ELEMENT element) {
+        typename std::list<T>::iterator insert_it = this->tasks_queue.begin();
+        while(insert_it != this->tasks_queue.end() && insert_it->time_left < time_left) {
+            ++insert_it;
+        }
+
+        if(insert_it != this->tasks_queue.end() && insert_it->time_left == time_left) {
+            insert_it->task_elements.push_back(element);
+        } else {
+            this->tasks_queue.insert(insert_it, T(time_left, element));
+        }
+    }
+
+    void pop() {
+        if(!this->tasks_queue.empty()) {
+            this->tasks_queue.pop_front();
+        }
+    }
+
+    TIME time_advance() const {
+        if(this->tasks_queue.empty()) {
+            return TIME::infinity();
+        }
+        return this->tasks_queue.front().time_left;
+    }
+
+    void update(TIME elapsed_time) {
+        for(T& task : this->tasks_queue) {
+            task.time_left -= elapsed_time;
+        }
+    }
+
+    void advance() {
+        TIME time_to_advance = this->time_advance();
+        this->pop();
+        this->update(time_to_advance);
+    }
+
+    bool exists(const ELEMENT& elem) const {
+        for (const T& task : this->tasks_queue) {
+            if (std::find(task.task_elements.begin(), task.task_elements.end(), elem) != task.task_elements.end()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::list<T> tasks_queue;
+};
+
+/**
+ * @brief Fills the scheduler with pending tasks and then runs the same mix of operations an
+ * atomic model does: an external transition (update + add) followed by an internal one (advance).
+ * Each operation queries a task of a kind that is present: the selecting task, rescheduled when
+ * it is not pending as the space does, or one of the sending tasks.
+ * Returns the microseconds per operation and the fraction of queries that found the task.
+ */
+template <class SCHEDULER>
+std::pair<double, double> run(const std::vector<NDTime>& times, std::size_t operations, Kind query) {
+    // Added from the latest time, the list inserts them at its front
+    std::vector<std::size_t> order(times.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&times](std::size_t l, std::size_t r) { return times[r] < times[l]; });
+
+    SCHEDULER scheduler;
+    for (std::size_t i : order) {
+        scheduler.add(times[i], BenchTask{Kind::SENDING, int(i % 1000)});
+    }
+    scheduler.add(times.back(), BenchTask{Kind::SELECTING, 0});
+
+    auto start = hclock::now();
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < operations; ++i) {
+        NDTime elapsed = std::min(scheduler.time_advance(), NDTime({0, 0, 0, 1}));
+        scheduler.update(elapsed);
+        scheduler.add(times[i % times.size()], BenchTask{Kind::SENDING, int(i % 1000)});
+        if (query == Kind::SELECTING) {
+            if (scheduler.exists(BenchTask{Kind::SELECTING, 0})) {
+                ++found;
+            } else {
+                scheduler.add(times[(i * 7) % times.size()], BenchTask{Kind::SELECTING, 0});
+            }
+        } else {
+            found += scheduler.exists(BenchTask{Kind::SENDING, int((i * 7) % std::min<std::size_t>(times.size(), 1000))});
+        }
+        scheduler.advance();
+    }
+
+    double us_per_op = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(hclock::now() - start).count() / operations;
+    return {us_per_op, double(found) / operations};
+}
+
+int main(int argc, char** argv) {
+
+    std::size_t max_pending = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> seconds(1, 3600);
+    std::uniform_int_distribution<int> milliseconds(0, 999);
+
+    std::cout << "pending_tasks,query,list_us_per_op,map_us_per_op,found" << std::endl;
+    for (std::size_t pending = 100; pending <= max_pending; pending *= 10) {
+
+        std::vector<NDTime> times;
+        times.reserve(pending);
+        for (std::size_t i = 0; i < pending; ++i) {
+            times.push_back(NDTime({0, 0, seconds(generator), milliseconds(generator)}));
+        }
+
+        // The list scheduler is linear in the pending tasks, fewer operations keep the run short
+        std::size_t operations = std::max<std::size_t>(10, 1000000 / pending);
+        for (Kind query : {Kind::SELECTING, Kind::SENDING}) {
+            auto list = run<ListTaskScheduler<NDTime, BenchTask>>(times, operations, query);
+            auto map = run<TaskScheduler<NDTime, BenchTask>>(times, operations, query);
+            assert(list.second == map.second);
+            std::cout << pending << "," << (query == Kind::SELECTING ? "selecting" : "sending") << ","
+                      << list.first << "," << map.first << "," << map.second << std::endl;
+        }
+    }
+
+    return 0;
+}
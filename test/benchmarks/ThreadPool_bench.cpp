@@ -0,0 +1,83 @@
+//
+// Scaling of the ThreadPool parallel_for over independent model transitions.
+// Usage: ThreadPool_bench [max_threads] [models] [draws_per_transition]
+//
+
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include <pmgbp/lib/Random.hpp>
+#include <pmgbp/lib/ThreadPool.hpp>
+
+using hclock=std::chrono::high_resolution_clock;
+
+/**
+ * @brief Stand-in for an enzyme transition, it only touches its own random stream and state.
+ */
+struct BenchModel {
+    Xoshiro256pp generator;
+    uint64_t state = 0;
+
+    explicit BenchModel(uint64_t seed) : generator(seed) {}
+
+    void transition(std::size_t draws) {
+        for (std::size_t i = 0; i < draws; ++i) {
+            this->state += this->generator() >> 60;
+        }
+    }
+};
+
+double run(std::size_t threads, std::size_t models, std::size_t draws, uint64_t& checksum) {
+    ThreadPool pool(threads);
+
+    std::vector<BenchModel> bench_models;
+    bench_models.reserve(models);
+    for (std::size_t i = 0; i < models; ++i) {
+        bench_models.emplace_back(RandomSeed::stream("Bench_" + std::to_string(i)));
+    }
+
+    const std::size_t steps = 100;
+    auto start = hclock::now();
+    for (std::size_t step = 0; step < steps; ++step) {
+        pool.parallel_for(0, models, [&bench_models, draws](std::size_t i) {
+            bench_models[i].transition(draws);
+        }, 8);
+    }
+    double elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(hclock::now() - start).count() / steps;
+
+    checksum = 0;
+    for (const BenchModel& model : bench_models) {
+        checksum += model.state;
+    }
+    return elapsed;
+}
+
+int main(int argc, char** argv) {
+
+    std::size_t max_threads = argc > 1 ? std::stoul(argv[1]) : 32;
+    std::size_t models = argc > 2 ? std::stoul(argv[2]) : 10000;
+    std::size_t draws = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    RandomSeed::setMaster(0);
+
+    std::cout << "hardware_threads " << ThreadPool::hardwareThreads() << std::endl;
+    std::cout << "threads,ms_per_step,speedup,checksum" << std::endl;
+
+    double sequential = 0;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        uint64_t checksum;
+        double elapsed = run(threads, models, draws, checksum);
+        if (threads == 1) {
+            sequential = elapsed;
+        }
+
+        // The checksum is the same for any amount of threads, the models are independent
+        std::cout << threads << "," << elapsed << "," << sequential / elapsed << "," << checksum << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <cstdio>
+
+#include <pmgbp/lib/AsyncSink.hpp>
+
+struct RecordSink {
+    std::vector<std::string> records;
+
+    RecordSink& operator<<(const std::string& record) {
+        this->records.push_back(record);
+        return *this;
+    }
+};
+
+struct BatchSink {
+    std::vector<std::string> records;
+    std::vector<std::size_t> batch_sizes;
+    int delay_us = 0;
+    bool flushed = false;
+
+    void write_batch(const std::vector<std::string>& batch) {
+        if (this->delay_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(this->delay_us));
+        }
+        this->records.insert(this->records.end(), batch.begin(), batch.end());
+        this->batch_sizes.push_back(batch.size());
+    }
+
+    void flush() {
+        this->flushed = true;
+    }
+};
+
+struct FailingSink {
+    void write_batch(const std::vector<std::string>&) {
+        throw std::runtime_error("downstream failed");
+    }
+};
+
+BOOST_AUTO_TEST_SUITE( libs_async_sink )
+
+    BOOST_AUTO_TEST_CASE( records_arrive_in_order ) {
+        RecordSink downstream;
+        {
+            AsyncSink<RecordSink> sink(downstream, 16, 4);
+            BOOST_CHECK_EQUAL(sink.capacity(), 16);
+            for (int i = 0; i < 1000; ++i) {
+                sink << std::to_string(i);
+            }
+            sink.flush();
+            BOOST_CHECK_EQUAL(sink.pushed(), 1000);
+            BOOST_CHECK_EQUAL(sink.records(), 1000);
+        }
+
+        BOOST_REQUIRE_EQUAL(downstream.records.size(), 1000);
+        for (int i = 0; i < 1000; ++i) {
+            BOOST_CHECK_EQUAL(downstream.records[i], std::to_string(i));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( batches_are_bounded_and_backpressure_waits ) {
+        BatchSink downstream;
+        downstream.delay_us = 200;
+        AsyncSink<BatchSink> sink(downstream, 5, 3);
+        BOOST_CHECK_EQUAL(sink.capacity(), 8);
+
+        for (int i = 0; i < 200; ++i) {
+            sink << "record " + std::to_string(i);
+            BOOST_CHECK(sink.pushed() - sink.records() <= sink.capacity() + 3);
+        }
+        sink.flush();
+
+        BOOST_CHECK(downstream.flushed);
+        BOOST_CHECK_EQUAL(downstream.records.size(), 200);
+        BOOST_CHECK_EQUAL(downstream.records.back(), "record 199");
+        BOOST_CHECK_EQUAL(downstream.batch_sizes.size(), sink.batches());
+        for (std::size_t size : downstream.batch_sizes) {
+            BOOST_CHECK(size >= 1 && size <= 3);
+        }
+        BOOST_CHECK(sink.full_waits() > 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( file_stand_in_has_everything_after_destruction ) {
+        std::string path = "async_sink_test.log";
+        {
+            std::ofstream file(path);
+            AsyncSink<std::ofstream> sink(file, 64, 10);
+            for (int i = 0; i < 500; ++i) {
+                sink << "line " + std::to_string(i) + "\n";
+            }
+        }
+
+        std::ifstream file(path);
+        std::string line;
+        int lines = 0;
+        while (std::getline(file, line)) {
+            BOOST_CHECK_EQUAL(line, "line " + std::to_string(lines));
+            ++lines;
+        }
+        BOOST_CHECK_EQUAL(lines, 500);
+        std::remove(path.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE( downstream_errors_reach_the_writer ) {
+        FailingSink downstream;
+        AsyncSink<FailingSink> sink(downstream, 8, 2);
+
+        sink << std::string("lost");
+        BOOST_CHECK_THROW(sink.flush(), std::runtime_error);
+        BOOST_CHECK_EQUAL(sink.records(), 1);
+        BOOST_CHECK_EQUAL(sink.batches(), 0);
+
+        // The sink stays failed, the next records are not silently dropped
+        BOOST_CHECK_THROW(sink.flush(), std::runtime_error);
+        BOOST_CHECK_THROW(sink << std::string("after"), std::runtime_error);
+        BOOST_CHECK_EQUAL(sink.pushed(), 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <pmgbp/lib/Checkpoint.hpp>
+
+using pmgbp::checkpoint::file;
+
+BOOST_AUTO_TEST_SUITE( libs_checkpoint )
+
+    BOOST_AUTO_TEST_CASE( checkpoint_is_read_as_written ) {
+        std::string path = "checkpoint_test.ckp";
+        file written;
+        written.mode = "ssa";
+        written.seed = 42;
+        written.time = "0:0:10:0:0:0";
+        written.state = std::string("\0binary\xff", 8);
+        written.write(path);
+
+        file replaced = written;
+        replaced.time = "0:0:20:0:0:0";
+        replaced.write(path);
+
+        file read = file::read(path);
+        BOOST_CHECK_EQUAL(read.mode, "ssa");
+        BOOST_CHECK_EQUAL(read.seed, 42);
+        BOOST_CHECK_EQUAL(read.time, "0:0:20:0:0:0");
+        BOOST_CHECK(read.state == written.state);
+
+        std::ifstream aside(path + ".tmp");
+        BOOST_CHECK(!aside);
+        std::remove(path.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE( wrong_files_throw ) {
+        std::string path = "checkpoint_test.ckp";
+        BOOST_CHECK_THROW(file::read("missing_checkpoint.ckp"), std::runtime_error);
+
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << "PMGBPTRJ not a checkpoint";
+        }
+        BOOST_CHECK_THROW(file::read(path), std::runtime_error);
+
+        file written;
+        written.state = "state";
+        written.write(path);
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), std::streamsize(bytes.size() - 2));
+        }
+        BOOST_CHECK_THROW(file::read(path), std::runtime_error);
+        std::remove(path.c_str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,53 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/FlatMap.hpp>
+
+using Amounts = FlatMap<unsigned int, unsigned long long>;
+
+BOOST_AUTO_TEST_SUITE( libs_flat_map )
+
+    BOOST_AUTO_TEST_CASE( insert_keeps_keys_sorted_and_unique ) {
+        Amounts m;
+
+        BOOST_CHECK(m.insert({3, 30}).second);
+        BOOST_CHECK(m.insert({1, 10}).second);
+        BOOST_CHECK(m.insert({2, 20}).second);
+        BOOST_CHECK(!m.insert({1, 99}).second);
+
+        BOOST_CHECK_EQUAL(m.size(), 3);
+        unsigned int expected_key = 1;
+        for (const auto& entry : m) {
+            BOOST_CHECK_EQUAL(entry.first, expected_key);
+            BOOST_CHECK_EQUAL(entry.second, expected_key * 10);
+            ++expected_key;
+        }
+        BOOST_CHECK(m.find(4) == m.end());
+        BOOST_CHECK_THROW(m.at(4), std::out_of_range);
+    }
+
+    BOOST_AUTO_TEST_CASE( add_merges_new_and_existing_keys ) {
+        Amounts m = {{1, 10}, {3, 30}};
+
+        m.add({{1, 1}, {3, 3}});
+        BOOST_CHECK(m == Amounts({{1, 11}, {3, 33}}));
+
+        m.add({{0, 5}, {2, 2}, {4, 4}}, 2);
+        BOOST_CHECK(m == Amounts({{0, 10}, {1, 11}, {2, 4}, {3, 33}, {4, 8}}));
+    }
+
+    BOOST_AUTO_TEST_CASE( covers_subtract_and_multiplicity ) {
+        Amounts inventory = {{1, 10}, {2, 7}, {5, 3}};
+        Amounts stoichiometry = {{1, 2}, {2, 1}};
+
+        BOOST_CHECK(inventory.covers(stoichiometry));
+        BOOST_CHECK(inventory.covers(stoichiometry, 5));
+        BOOST_CHECK(!inventory.covers(stoichiometry, 6));
+        BOOST_CHECK(!inventory.covers({{3, 1}}));
+        BOOST_CHECK_EQUAL(inventory.multiplicity(stoichiometry), 5);
+
+        inventory.subtract(stoichiometry, 3);
+        BOOST_CHECK(inventory == Amounts({{1, 4}, {2, 4}, {5, 3}}));
+        BOOST_CHECK_EQUAL(inventory.multiplicity(stoichiometry), 2);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,57 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/IndexedPriorityQueue.hpp>
+
+#include <limits>
+#include <random>
+#include <algorithm>
+
+BOOST_AUTO_TEST_SUITE( libs_indexed_priority_queue )
+
+    BOOST_AUTO_TEST_CASE( top_is_the_smallest_key ) {
+        IndexedPriorityQueue<double> queue({5.0, 1.0, 3.0, 1.0});
+
+        BOOST_CHECK_EQUAL(queue.size(), 4);
+        BOOST_CHECK_EQUAL(queue.top(), 1);
+
+        queue.update(1, 4.0);
+        BOOST_CHECK_EQUAL(queue.top(), 3);
+
+        queue.update(0, 0.5);
+        BOOST_CHECK_EQUAL(queue.top(), 0);
+        BOOST_CHECK_EQUAL(queue.key(0), 0.5);
+
+        queue.update(0, std::numeric_limits<double>::infinity());
+        queue.update(3, std::numeric_limits<double>::infinity());
+        BOOST_CHECK_EQUAL(queue.top(), 2);
+    }
+
+    BOOST_AUTO_TEST_CASE( equal_keys_are_ordered_by_index ) {
+        IndexedPriorityQueue<int> queue({2, 2, 2});
+        BOOST_CHECK_EQUAL(queue.top(), 0);
+
+        queue.update(0, 3);
+        BOOST_CHECK_EQUAL(queue.top(), 1);
+
+        queue.update(0, 2);
+        BOOST_CHECK_EQUAL(queue.top(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( random_updates_keep_the_minimum ) {
+        std::mt19937 generator(3);
+        std::uniform_int_distribution<int> values(0, 1000);
+        std::vector<int> keys(100);
+        for (int& key : keys) key = values(generator);
+
+        IndexedPriorityQueue<int> queue(keys);
+        for (int i = 0; i < 1000; ++i) {
+            std::size_t index = std::size_t(values(generator)) % keys.size();
+            keys[index] = values(generator);
+            queue.update(index, keys[index]);
+
+            std::size_t expected = std::min_element(keys.begin(), keys.end()) - keys.begin();
+            BOOST_CHECK_EQUAL(queue.top(), expected);
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
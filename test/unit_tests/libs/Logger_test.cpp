@@ -0,0 +1,33 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/Logger.hpp>
+
+BOOST_AUTO_TEST_SUITE( libs_logger )
+
+    BOOST_AUTO_TEST_CASE( parse_level_names ) {
+        Logger::Level level = Logger::Level::NONE;
+
+        BOOST_CHECK(Logger::parseLevel("debug", level));
+        BOOST_CHECK(level == Logger::Level::DEBUG);
+        BOOST_CHECK(Logger::parseLevel("error", level));
+        BOOST_CHECK(level == Logger::Level::ERROR);
+        BOOST_CHECK(!Logger::parseLevel("verbose", level));
+        BOOST_CHECK(level == Logger::Level::ERROR);
+    }
+
+    BOOST_AUTO_TEST_CASE( disabled_levels_do_not_build_the_message ) {
+        Logger logger("test");
+        int built = 0;
+        auto message = [&built]() { ++built; return std::string("message"); };
+
+        Logger::setLevel(Logger::Level::NONE);
+        PMGBP_LOG_ERROR(logger, message());
+        PMGBP_LOG_DEBUG(logger, message());
+        BOOST_CHECK_EQUAL(built, 0);
+
+        Logger::setLevel(Logger::Level::DEBUG);
+        PMGBP_LOG_DEBUG(logger, message());
+        BOOST_CHECK_EQUAL(built, Logger::compiled(Logger::Level::DEBUG) ? 1 : 0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/Options.hpp>
+
+BOOST_AUTO_TEST_SUITE( libs_options )
+
+    BOOST_AUTO_TEST_CASE( defaults_with_only_positional_arguments ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "run_1"};
+        Options options(3, argv);
+
+        BOOST_CHECK_EQUAL(options.xml_parameters_path, "parameters.xml");
+        BOOST_CHECK_EQUAL(options.simulation_id, "run_1");
+        BOOST_CHECK_EQUAL(options.end_time, "3000");
+        BOOST_CHECK(!options.has_seed);
+        BOOST_CHECK(options.output == Options::Output::STDOUT);
+        BOOST_CHECK(options.snapshot_interval.empty());
+        BOOST_CHECK(options.sample_interval.empty());
+        BOOST_CHECK(options.mode == Options::Mode::COUPLED);
+        BOOST_CHECK_EQUAL(options.threads, 1);
+        BOOST_CHECK_EQUAL(options.tau_leap, 0.0);
+        BOOST_CHECK_EQUAL(options.delta_keyframes, 0);
+        BOOST_CHECK_EQUAL(options.log_batch, 1000);
+        BOOST_CHECK_EQUAL(options.log_queue, 65536);
+        BOOST_CHECK(options.checkpoint_file.empty());
+        BOOST_CHECK(options.resume_file.empty());
+    }
+
+    BOOST_AUTO_TEST_CASE( all_options ) {
+        const char* argv[] = {"pmgbp", "parameters.xml",
+                              "--end-time", "10:30", "--seed", "42", "--log-level", "error",
+                              "--output", "file", "--output-file", "states.log",
+                              "--snapshot-interval", "1", "--snapshot-file", "snapshots.log",
+                              "--mode", "fused", "--threads", "8"};
+        Options options(20, argv);
+
+        BOOST_CHECK_EQUAL(options.end_time, "10:30");
+        BOOST_CHECK(options.has_seed);
+        BOOST_CHECK_EQUAL(options.seed, 42);
+        BOOST_CHECK_EQUAL(options.log_level, "error");
+        BOOST_CHECK(options.output == Options::Output::FILE);
+        BOOST_CHECK_EQUAL(options.output_file, "states.log");
+        BOOST_CHECK_EQUAL(options.snapshot_interval, "1");
+        BOOST_CHECK_EQUAL(options.snapshot_file, "snapshots.log");
+        BOOST_CHECK(options.mode == Options::Mode::FUSED);
+        BOOST_CHECK_EQUAL(options.threads, 8);
+    }
+
+    BOOST_AUTO_TEST_CASE( conservative_mode ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--mode", "conservative"};
+        Options options(4, argv);
+
+        BOOST_CHECK(options.mode == Options::Mode::CONSERVATIVE);
+        BOOST_CHECK(options.transport == Options::Transport::SHARED);
+    }
+
+    BOOST_AUTO_TEST_CASE( optimistic_mode_and_transport ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--mode", "optimistic", "--transport", "socket"};
+        const char* wrong_transport[] = {"pmgbp", "parameters.xml", "--transport", "pipe"};
+        Options options(6, argv);
+
+        BOOST_CHECK(options.mode == Options::Mode::OPTIMISTIC);
+        BOOST_CHECK(options.transport == Options::Transport::SOCKET);
+        BOOST_CHECK_THROW(Options(4, wrong_transport), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( ssa_mode ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--mode", "ssa"};
+        Options options(4, argv);
+
+        BOOST_CHECK(options.mode == Options::Mode::SSA);
+    }
+
+    BOOST_AUTO_TEST_CASE( mode_names ) {
+        for (const char* name : {"coupled", "fused", "conservative", "optimistic", "ssa"}) {
+            const char* argv[] = {"pmgbp", "parameters.xml", "--mode", name};
+            BOOST_CHECK_EQUAL(Options::modeName(Options(4, argv).mode), name);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( tau_leap_epsilon ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--tau-leap", "0.03"};
+        const char* negative[] = {"pmgbp", "parameters.xml", "--tau-leap", "-0.1"};
+        const char* too_big[] = {"pmgbp", "parameters.xml", "--tau-leap", "1"};
+        const char* not_a_number[] = {"pmgbp", "parameters.xml", "--tau-leap", "0.1x"};
+        Options options(4, argv);
+
+        BOOST_CHECK_CLOSE(options.tau_leap, 0.03, 1e-9);
+        BOOST_CHECK_THROW(Options(4, negative), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, too_big), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, not_a_number), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( delta_keyframes ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--delta-keyframes", "100"};
+        const char* negative[] = {"pmgbp", "parameters.xml", "--delta-keyframes", "-1"};
+        Options options(4, argv);
+
+        BOOST_CHECK_EQUAL(options.delta_keyframes, 100);
+        BOOST_CHECK_THROW(Options(4, negative), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( log_batches ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "sim", "--output", "memore",
+                              "--log-batch", "500", "--log-queue", "4096"};
+        const char* empty_batch[] = {"pmgbp", "parameters.xml", "--log-batch", "0"};
+        const char* negative_queue[] = {"pmgbp", "parameters.xml", "--log-queue", "-8"};
+        Options options(9, argv);
+
+        BOOST_CHECK_EQUAL(options.log_batch, 500);
+        BOOST_CHECK_EQUAL(options.log_queue, 4096);
+        BOOST_CHECK_THROW(Options(4, empty_batch), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, negative_queue), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( checkpoints ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--mode", "ssa",
+                              "--checkpoint-interval", "1:0", "--checkpoint-file", "run.ckp",
+                              "--checkpoint-wall", "600", "--resume", "previous.ckp"};
+        const char* missing_file[] = {"pmgbp", "parameters.xml", "--checkpoint-interval", "1"};
+        const char* only_wall[] = {"pmgbp", "parameters.xml", "--checkpoint-wall", "60"};
+        const char* wrong_wall[] = {"pmgbp", "parameters.xml", "--checkpoint-wall", "1.5"};
+        Options options(12, argv);
+
+        BOOST_CHECK_EQUAL(options.checkpoint_interval, "1:0");
+        BOOST_CHECK_EQUAL(options.checkpoint_file, "run.ckp");
+        BOOST_CHECK_EQUAL(options.checkpoint_wall, 600);
+        BOOST_CHECK_EQUAL(options.resume_file, "previous.ckp");
+        BOOST_CHECK_THROW(Options(4, missing_file), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, only_wall), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, wrong_wall), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( sampled_observables ) {
+        const char* argv[] = {"pmgbp", "parameters.xml", "--output", "none",
+                              "--sample-interval", "0:0:1", "--sample-file", "samples.csv"};
+        const char* missing_file[] = {"pmgbp", "parameters.xml", "--sample-interval", "1"};
+        const char* missing_interval[] = {"pmgbp", "parameters.xml", "--sample-file", "samples.csv"};
+        Options options(8, argv);
+
+        BOOST_CHECK(options.output == Options::Output::NONE);
+        BOOST_CHECK_EQUAL(options.sample_interval, "0:0:1");
+        BOOST_CHECK_EQUAL(options.sample_file, "samples.csv");
+        BOOST_CHECK_THROW(Options(4, missing_file), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, missing_interval), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE( wrong_arguments_throw ) {
+        const char* unknown[] = {"pmgbp", "parameters.xml", "--speed", "1"};
+        const char* missing_value[] = {"pmgbp", "parameters.xml", "--seed"};
+        const char* wrong_time[] = {"pmgbp", "parameters.xml", "--end-time", "1:x"};
+        const char* missing_file[] = {"pmgbp", "parameters.xml", "--output", "binary"};
+        const char* wrong_mode[] = {"pmgbp", "parameters.xml", "--mode", "flat"};
+        const char* wrong_threads[] = {"pmgbp", "parameters.xml", "--threads", "-2"};
+        const char* missing_snapshot_file[] = {"pmgbp", "parameters.xml", "--snapshot-interval", "1"};
+        const char* no_parameters[] = {"pmgbp"};
+
+        BOOST_CHECK_THROW(Options(4, unknown), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(3, missing_value), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, wrong_time), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, missing_file), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, wrong_mode), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, wrong_threads), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(4, missing_snapshot_file), std::invalid_argument);
+        BOOST_CHECK_THROW(Options(1, no_parameters), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
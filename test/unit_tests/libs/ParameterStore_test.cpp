@@ -0,0 +1,36 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+
+#include <pmgbp/lib/ParameterStore.hpp>
+
+BOOST_AUTO_TEST_SUITE( libs_parameter_store )
+
+    BOOST_AUTO_TEST_CASE( reversible_flags_are_read_in_any_case ) {
+        std::string path = "parameter_store_test.xml";
+        {
+            std::ofstream out(path);
+            out << "<parameters><spaces/><routers/><enzymes/><reactions>"
+                << "<r1><reversible>True</reversible></r1>"
+                << "<r2><reversible>true</reversible></r2>"
+                << "<r3><reversible>False</reversible></r3>"
+                << "<r4><reversible>false</reversible></r4>"
+                << "<r5></r5>"
+                << "</reactions></parameters>";
+        }
+
+        const ParameterStore& store = ParameterStore::get(path);
+        BOOST_CHECK(ParameterStore::is_true(store.reaction("r1")->FirstChildElement("reversible")));
+        BOOST_CHECK(ParameterStore::is_true(store.reaction("r2")->FirstChildElement("reversible")));
+        BOOST_CHECK(!ParameterStore::is_true(store.reaction("r3")->FirstChildElement("reversible")));
+        BOOST_CHECK(!ParameterStore::is_true(store.reaction("r4")->FirstChildElement("reversible")));
+        BOOST_CHECK(!ParameterStore::is_true(store.reaction("r5")->FirstChildElement("reversible")));
+
+        ParameterStore::release(path);
+        std::remove(path.c_str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/Random.hpp>
+
+BOOST_AUTO_TEST_SUITE( libs_random )
+
+    BOOST_AUTO_TEST_CASE( same_seed_same_sequence ) {
+        Xoshiro256pp a(7), b(7), c(8);
+
+        bool all_equal = true, any_different = false;
+        for (int i = 0; i < 100; ++i) {
+            uint64_t x = a();
+            all_equal = all_equal && (x == b());
+            any_different = any_different || (x != c());
+        }
+        BOOST_CHECK(all_equal);
+        BOOST_CHECK(any_different);
+    }
+
+    BOOST_AUTO_TEST_CASE( streams_depend_on_master_seed_and_name ) {
+        RandomSeed::setMaster(42);
+        uint64_t space = RandomSeed::stream("Space_c");
+        uint64_t enzyme = RandomSeed::stream("Enzyme_b0000:(cid: c, esn: bulk)");
+
+        BOOST_CHECK_EQUAL(RandomSeed::stream("Space_c"), space);
+        BOOST_CHECK_NE(space, enzyme);
+
+        RandomSeed::setMaster(43);
+        BOOST_CHECK_NE(RandomSeed::stream("Space_c"), space);
+    }
+
+    BOOST_AUTO_TEST_CASE( multinomial_never_assigns_more_than_n ) {
+        IntegerRandom<unsigned long long> random(1);
+        std::vector<double> p = {0.2, 0.3, 0.1};
+        std::vector<unsigned long long> counts;
+
+        for (int i = 0; i < 100; ++i) {
+            random.drawMultinomial(1000, p, counts);
+            BOOST_CHECK_EQUAL(counts.size(), p.size());
+            BOOST_CHECK_LE(counts[0] + counts[1] + counts[2], 1000);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( exponential_mean_is_the_inverse_rate ) {
+        RealRandom<double> random(5);
+
+        double total = 0.0;
+        for (int i = 0; i < 10000; ++i) {
+            double waiting = random.drawExponential(4.0);
+            BOOST_CHECK_GE(waiting, 0.0);
+            total += waiting;
+        }
+        BOOST_CHECK_CLOSE(total / 10000, 0.25, 5.0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
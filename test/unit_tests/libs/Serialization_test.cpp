@@ -0,0 +1,150 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+
+using pmgbp::serialization::writer;
+using pmgbp::serialization::reader;
+
+struct Message {
+    uint32_t id = 0;
+    std::string name;
+    FlatMap<uint32_t, unsigned long long> amounts;
+
+    bool operator==(const Message& other) const {
+        return id == other.id && name == other.name && amounts == other.amounts;
+    }
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE& archive) {
+        archive & id & name & amounts;
+    }
+};
+
+// Time written as text, its value is not trivially copyable
+struct Time {
+    std::vector<int> fields;
+    bool infinite = false;
+
+    Time() = default;
+    explicit Time(const std::string& text) : fields{std::stoi(text)} {}
+
+    static Time infinity() {
+        Time result;
+        result.infinite = true;
+        return result;
+    }
+
+    bool operator==(const Time& other) const {
+        return infinite == other.infinite && fields == other.fields;
+    }
+
+    bool operator<(const Time& other) const {
+        return !infinite && (other.infinite || fields < other.fields);
+    }
+};
+
+std::ostream& operator<<(std::ostream& os, const Time& time) {
+    return os << (time.fields.empty() ? 0 : time.fields.front());
+}
+
+struct Bag {
+    std::vector<Message> messages;
+};
+
+BOOST_AUTO_TEST_SUITE( libs_serialization )
+
+    BOOST_AUTO_TEST_CASE( values_are_read_as_written ) {
+        int number = -7;
+        double real = 0.25;
+        std::string text = "periplasm";
+        std::vector<uint32_t> ids = {3, 1, 2};
+        std::list<std::string> names = {"a", "", "bc"};
+        std::map<std::string, int> counts = {{"x", 1}, {"y", 2}};
+
+        writer out;
+        out & number & real & text & ids & names & counts;
+
+        int read_number;
+        double read_real;
+        std::string read_text;
+        std::vector<uint32_t> read_ids;
+        std::list<std::string> read_names;
+        std::map<std::string, int> read_counts;
+
+        reader in(out.bytes());
+        in & read_number & read_real & read_text & read_ids & read_names & read_counts;
+
+        BOOST_CHECK(in.done());
+        BOOST_CHECK_EQUAL(read_number, number);
+        BOOST_CHECK_EQUAL(read_real, real);
+        BOOST_CHECK_EQUAL(read_text, text);
+        BOOST_CHECK(read_ids == ids);
+        BOOST_CHECK(read_names == names);
+        BOOST_CHECK(read_counts == counts);
+    }
+
+    BOOST_AUTO_TEST_CASE( serialize_member_is_used_for_both_directions ) {
+        std::vector<Message> messages(2);
+        messages[0].id = 1;
+        messages[0].name = "glucose";
+        messages[0].amounts = {{4, 40}, {2, 20}};
+        messages[1].id = 2;
+
+        writer out;
+        out & messages;
+
+        std::vector<Message> read_messages;
+        reader in(out.bytes());
+        in & read_messages;
+
+        BOOST_CHECK(in.done());
+        BOOST_CHECK(read_messages == messages);
+    }
+
+    BOOST_AUTO_TEST_CASE( times_sets_deques_and_tuples ) {
+        std::set<std::pair<Time, std::size_t>> schedule = {{Time("5"), 1}, {Time("2"), 0}, {Time::infinity(), 2}};
+        std::deque<std::pair<Time, std::string>> queue = {{Time("3"), "a"}, {Time("4"), "b"}};
+        std::tuple<Bag, Bag> bags;
+        std::get<1>(bags).messages.resize(1);
+        std::get<1>(bags).messages[0].name = "atp";
+
+        writer out;
+        out & schedule & queue & bags;
+        BOOST_CHECK(!writer::loading);
+
+        std::set<std::pair<Time, std::size_t>> read_schedule;
+        std::deque<std::pair<Time, std::string>> read_queue;
+        std::tuple<Bag, Bag> read_bags;
+        reader in(out.bytes());
+        in & read_schedule & read_queue & read_bags;
+
+        BOOST_CHECK(reader::loading);
+        BOOST_CHECK(in.done());
+        BOOST_CHECK(read_schedule == schedule);
+        BOOST_CHECK(read_queue == queue);
+        BOOST_CHECK(std::get<0>(read_bags).messages.empty());
+        BOOST_CHECK(std::get<1>(read_bags).messages == std::get<1>(bags).messages);
+    }
+
+    BOOST_AUTO_TEST_CASE( sizes_must_match_the_model ) {
+        writer out;
+        pmgbp::serialization::expect_size(out, 3);
+
+        reader same(out.bytes());
+        BOOST_CHECK_NO_THROW(pmgbp::serialization::expect_size(same, 3));
+        reader other(out.bytes());
+        BOOST_CHECK_THROW(pmgbp::serialization::expect_size(other, 4), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE( truncated_bytes_throw ) {
+        writer out;
+        out & std::string("cytoplasm");
+        std::string bytes = out.bytes();
+        bytes.pop_back();
+
+        std::string text;
+        reader in(bytes);
+        BOOST_CHECK_THROW(in & text, std::runtime_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
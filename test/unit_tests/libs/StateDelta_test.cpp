@@ -0,0 +1,99 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/StateDelta.hpp>
+
+#include <set>
+
+BOOST_AUTO_TEST_SUITE( libs_state_delta )
+
+    BOOST_AUTO_TEST_CASE( full_states_by_default ) {
+        StateDelta::setKeyframeInterval(0);
+        ChangeTracker<int> tracker;
+
+        BOOST_CHECK(!StateDelta::enabled());
+        BOOST_CHECK(tracker.keyframe());
+        for (int i = 0; i < 3; ++i) {
+            tracker.begin();
+            tracker.touch(i);
+            BOOST_CHECK(tracker.keyframe());
+            BOOST_CHECK(tracker.changed().empty());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( deltas_between_keyframes ) {
+        StateDelta::setKeyframeInterval(3);
+        ChangeTracker<int> tracker;
+
+        BOOST_CHECK(tracker.keyframe());
+
+        tracker.begin();
+        tracker.touch(3);
+        BOOST_CHECK(tracker.keyframe());
+        BOOST_CHECK(tracker.changed().empty());
+
+        tracker.begin();
+        tracker.touch(4);
+        tracker.touch(2);
+        tracker.touch(4);
+        BOOST_CHECK(!tracker.keyframe());
+        BOOST_CHECK(tracker.changed() == std::set<int>({2, 4}));
+
+        tracker.begin();
+        tracker.touch(1);
+        BOOST_CHECK(tracker.changed() == std::set<int>({1}));
+
+        tracker.begin();
+        tracker.touch(5);
+        BOOST_CHECK(tracker.keyframe());
+        BOOST_CHECK(tracker.changed().empty());
+
+        tracker.begin();
+        BOOST_CHECK(!tracker.keyframe());
+        BOOST_CHECK(tracker.changed().empty());
+
+        StateDelta::setKeyframeInterval(0);
+    }
+
+    BOOST_AUTO_TEST_CASE( kept_changes_join_the_next_transition ) {
+        StateDelta::setKeyframeInterval(10);
+        ChangeTracker<int> tracker;
+        tracker.begin();
+
+        tracker.begin();
+        tracker.touch(1);
+        tracker.keep();
+        tracker.begin();
+        tracker.touch(2);
+        BOOST_CHECK(tracker.changed() == std::set<int>({1, 2}));
+
+        tracker.begin();
+        BOOST_CHECK(tracker.changed().empty());
+
+        StateDelta::setKeyframeInterval(0);
+    }
+
+    BOOST_AUTO_TEST_CASE( forced_keyframe_after_restoring ) {
+        StateDelta::setKeyframeInterval(4);
+        ChangeTracker<int> tracker;
+        tracker.begin();
+        tracker.begin();
+        tracker.touch(1);
+        BOOST_CHECK(!tracker.keyframe());
+
+        StateDelta::forceKeyframes();
+        tracker.begin();
+        tracker.touch(2);
+        BOOST_CHECK(tracker.keyframe());
+
+        // The keyframes continue every 4 transitions
+        tracker.begin();
+        tracker.touch(3);
+        BOOST_CHECK(!tracker.keyframe());
+        BOOST_CHECK(tracker.changed() == std::set<int>({3}));
+        tracker.begin();
+        BOOST_CHECK(tracker.keyframe());
+
+        StateDelta::setKeyframeInterval(0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/SymbolTable.hpp>
+
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( libs_symbol_table )
+
+    BOOST_AUTO_TEST_CASE( intern_assigns_dense_ids_in_insertion_order ) {
+        SymbolTable table;
+
+        BOOST_CHECK_EQUAL(table.size(), 0);
+        BOOST_CHECK_EQUAL(table.intern("A_c"), 0);
+        BOOST_CHECK_EQUAL(table.intern("B_c"), 1);
+        BOOST_CHECK_EQUAL(table.intern("A_c"), 0);
+        BOOST_CHECK_EQUAL(table.intern("C_e"), 2);
+        BOOST_CHECK_EQUAL(table.size(), 3);
+    }
+
+    BOOST_AUTO_TEST_CASE( name_and_at_are_inverse ) {
+        SymbolTable table;
+        table.intern("A_c");
+        table.intern("B_c");
+
+        BOOST_CHECK_EQUAL(table.name(table.at("A_c")), "A_c");
+        BOOST_CHECK_EQUAL(table.name(table.at("B_c")), "B_c");
+        BOOST_CHECK(table.contains("A_c"));
+        BOOST_CHECK(!table.contains("C_e"));
+        BOOST_CHECK_THROW(table.at("C_e"), std::out_of_range);
+    }
+
+    BOOST_AUTO_TEST_CASE( name_references_survive_new_symbols ) {
+        SymbolTable table;
+        const std::string& first = table.name(table.intern("A_c"));
+
+        for (int i = 0; i < 1000; ++i) {
+            table.intern("species_" + std::to_string(i));
+        }
+
+        BOOST_CHECK_EQUAL(first, "A_c");
+    }
+
+    BOOST_AUTO_TEST_CASE( concurrent_interns_agree_on_the_ids ) {
+        SymbolTable table;
+        std::vector<std::vector<SymbolTable::id_type>> ids(4);
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < ids.size(); ++t) {
+            threads.emplace_back([&table, &ids, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    ids[t].push_back(table.intern("species_" + std::to_string(i)));
+                    table.name(ids[t].back());
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        BOOST_CHECK_EQUAL(table.size(), 1000);
+        for (std::size_t t = 0; t < ids.size(); ++t) {
+            for (int i = 0; i < 1000; ++i) {
+                BOOST_CHECK_EQUAL(table.name(ids[t][i]), "species_" + std::to_string(i));
+            }
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
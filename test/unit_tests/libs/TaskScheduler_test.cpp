@@ -5,7 +5,18 @@
 #define BOOST_TEST_DYN_LINK
 #include <NDTime.hpp>
 #include <boost/test/unit_test.hpp>
+#include <vector>
 #include <pmgbp/lib/TaskScheduler.hpp>
+#include <pmgbp/lib/Serialization.hpp>
+
+struct KindTask {
+    int kind;
+    int value;
+
+    bool operator==(const KindTask& o) const {
+        return kind == o.kind && value == o.value;
+    }
+};
 
 BOOST_AUTO_TEST_SUITE( libs_task_cheduler )
 
@@ -121,4 +132,136 @@ BOOST_AUTO_TEST_SUITE( libs_task_cheduler )
         BOOST_CHECK_EQUAL(scheduler.time_advance(), NDTime::infinity());
     }
 
+    BOOST_AUTO_TEST_CASE( update_advance_keep_the_current_time__tests ) {
+        TaskScheduler<NDTime, int> scheduler;
+
+        BOOST_CHECK_EQUAL(scheduler.now(), NDTime({0}));
+        scheduler.add(NDTime({2}), 2);
+        scheduler.update(NDTime({1}));
+        BOOST_CHECK_EQUAL(scheduler.now(), NDTime({1}));
+
+        // The new task time is relative to the current time
+        scheduler.add(NDTime({2}), 3);
+        BOOST_CHECK_EQUAL(scheduler.time_advance(), NDTime({1}));
+        scheduler.advance();
+        BOOST_CHECK_EQUAL(scheduler.now(), NDTime({2}));
+        BOOST_CHECK(scheduler.next() == std::list<int>({3}));
+        BOOST_CHECK_EQUAL(scheduler.time_advance(), NDTime({1}));
+    }
+
+    BOOST_AUTO_TEST_CASE( queue_returns_time_left__tests ) {
+        TaskScheduler<NDTime, int> scheduler;
+
+        scheduler.add(NDTime({3}), 4);
+        scheduler.add(NDTime({1}), 2);
+        scheduler.add(NDTime({1}), 3);
+        scheduler.update(NDTime({0,30}));
+
+        std::list<Tasks<NDTime, int>> queue = scheduler.queue();
+        BOOST_CHECK_EQUAL(queue.size(), 2);
+        BOOST_CHECK_EQUAL(queue.front().time_left, NDTime({0,30}));
+        BOOST_CHECK(queue.front().task_elements == std::list<int>({2,3}));
+        BOOST_CHECK_EQUAL(queue.back().time_left, NDTime({2,30}));
+        BOOST_CHECK(queue.back().task_elements == std::list<int>({4}));
+    }
+
+    BOOST_AUTO_TEST_CASE( exists_is_in_next__tests ) {
+        TaskScheduler<NDTime, int> scheduler;
+
+        BOOST_CHECK(!scheduler.exists(2));
+        BOOST_CHECK(!scheduler.is_in_next(2));
+        scheduler.add(NDTime({1}), 2);
+        scheduler.add(NDTime({2}), 3);
+        BOOST_CHECK(scheduler.exists(2));
+        BOOST_CHECK(scheduler.exists(3));
+        BOOST_CHECK(scheduler.is_in_next(2));
+        BOOST_CHECK(!scheduler.is_in_next(3));
+        scheduler.advance();
+        BOOST_CHECK(!scheduler.exists(2));
+        BOOST_CHECK(scheduler.is_in_next(3));
+    }
+
+    BOOST_AUTO_TEST_CASE( exists_is_in_next_with_kind_index__tests ) {
+        TaskScheduler<NDTime, KindTask> scheduler;
+
+        scheduler.add(NDTime({1}), {0, 1});
+        scheduler.add(NDTime({2}), {1, 1});
+        scheduler.add(NDTime({2}), {1, 2});
+        scheduler.add(NDTime({3}), {1, 2});
+
+        BOOST_CHECK(scheduler.exists({0, 1}));
+        BOOST_CHECK(!scheduler.exists({0, 2}));
+        BOOST_CHECK(scheduler.exists({1, 2}));
+        BOOST_CHECK(!scheduler.exists({2, 1}));
+        BOOST_CHECK(scheduler.is_in_next({0, 1}));
+        BOOST_CHECK(!scheduler.is_in_next({1, 1}));
+
+        scheduler.advance();
+        BOOST_CHECK(!scheduler.exists({0, 1}));
+        BOOST_CHECK(scheduler.is_in_next({1, 1}));
+        BOOST_CHECK(scheduler.is_in_next({1, 2}));
+
+        scheduler.advance();
+        BOOST_CHECK(!scheduler.exists({1, 1}));
+        BOOST_CHECK(scheduler.exists({1, 2}));
+        BOOST_CHECK(!scheduler.is_in_next({1, 1}));
+
+        scheduler.pop();
+        BOOST_CHECK(!scheduler.exists({1, 2}));
+    }
+
+    BOOST_AUTO_TEST_CASE( exists_is_in_next_count_the_copies__tests ) {
+        TaskScheduler<NDTime, int> scheduler;
+        scheduler.add(NDTime({1}), 2);
+        scheduler.add(NDTime({1}), 2);
+        scheduler.add(NDTime({2}), 3);
+        scheduler.add(NDTime({3}), 2);
+
+        BOOST_CHECK(scheduler.is_in_next(2));
+        scheduler.advance();
+        BOOST_CHECK(scheduler.exists(2));
+        BOOST_CHECK(!scheduler.is_in_next(2));
+        scheduler.advance();
+        BOOST_CHECK(scheduler.is_in_next(2));
+        scheduler.advance();
+        BOOST_CHECK(!scheduler.exists(2));
+    }
+
+    BOOST_AUTO_TEST_CASE( exists_is_in_next_without_index__tests ) {
+        TaskScheduler<NDTime, std::vector<int>> scheduler;
+        scheduler.add(NDTime({1}), {1});
+        scheduler.add(NDTime({2}), {1, 2});
+
+        BOOST_CHECK(scheduler.exists({1, 2}));
+        BOOST_CHECK(!scheduler.exists({2}));
+        BOOST_CHECK(scheduler.is_in_next({1}));
+        BOOST_CHECK(!scheduler.is_in_next({1, 2}));
+        scheduler.advance();
+        BOOST_CHECK(!scheduler.exists({1}));
+        BOOST_CHECK(scheduler.is_in_next({1, 2}));
+    }
+
+    BOOST_AUTO_TEST_CASE( serialize_restores_the_tasks_and_the_kind_index__tests ) {
+        TaskScheduler<NDTime, KindTask> scheduler;
+        scheduler.add(NDTime({1}), {0, 1});
+        scheduler.add(NDTime({2}), {1, 1});
+        scheduler.add(NDTime({3}), {1, 2});
+        scheduler.advance();
+
+        pmgbp::serialization::writer out;
+        out & scheduler;
+
+        TaskScheduler<NDTime, KindTask> restored;
+        restored.add(NDTime({5}), {0, 1});
+        pmgbp::serialization::reader in(out.bytes());
+        in & restored;
+
+        BOOST_CHECK(in.done());
+        BOOST_CHECK_EQUAL(restored.now(), NDTime({1}));
+        BOOST_CHECK_EQUAL(restored.time_advance(), NDTime({1}));
+        BOOST_CHECK(!restored.exists({0, 1}));
+        BOOST_CHECK(restored.is_in_next({1, 1}));
+        BOOST_CHECK(restored.exists({1, 2}));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,39 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/TauLeaping.hpp>
+
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( libs_tau_leaping )
+
+    BOOST_AUTO_TEST_CASE( leaps_keep_the_leap_condition ) {
+        TauLeaping::setEpsilon(0.1);
+
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(50.0, 1000.0), 1);
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(100.0, 1000.0), 1);
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(101.0, 1000.0), 2);
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(1000.0, 1000.0), 10);
+
+        // A small species can always lose one metabolite per leap
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(3.0, 5.0), 3);
+        BOOST_CHECK_EQUAL(TauLeaping::leaps(0.0, 5.0), 1);
+
+        // Too many leaps make the species critical
+        BOOST_CHECK_GT(TauLeaping::leaps(1e9, 1000.0), TauLeaping::MAX_LEAPS);
+
+        TauLeaping::setEpsilon(0.0);
+    }
+
+    BOOST_AUTO_TEST_CASE( leap_probabilities_compose_the_interval_one ) {
+        BOOST_CHECK_CLOSE(TauLeaping::leapProbability(0.3, 1), 0.3, 1e-9);
+        BOOST_CHECK_EQUAL(TauLeaping::leapProbability(1.0, 8), 1.0);
+        BOOST_CHECK_EQUAL(TauLeaping::leapProbability(0.0, 8), 0.0);
+
+        for (std::size_t leaps : {2, 5, 64}) {
+            double p = TauLeaping::leapProbability(0.3, leaps);
+            BOOST_CHECK_CLOSE(1.0 - std::pow(1.0 - p, double(leaps)), 0.3, 1e-9);
+        }
+        BOOST_CHECK_CLOSE(TauLeaping::leapProbability(1e-12, 4), 0.25e-12, 1e-6);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include <pmgbp/lib/ThreadPool.hpp>
+
+BOOST_AUTO_TEST_SUITE( libs_thread_pool )
+
+    BOOST_AUTO_TEST_CASE( each_index_runs_once ) {
+        ThreadPool pool(4);
+        BOOST_CHECK_EQUAL(pool.size(), 4);
+
+        for (std::size_t grain : {1, 3, 64}) {
+            std::vector<int> calls(1000, 0);
+            pool.parallel_for(10, calls.size(), [&calls](std::size_t i) { ++calls[i]; }, grain);
+
+            for (std::size_t i = 0; i < calls.size(); ++i) {
+                BOOST_CHECK_EQUAL(calls[i], i < 10 ? 0 : 1);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( nested_loops_run_sequentially ) {
+        ThreadPool pool(3);
+        std::atomic<int> total(0);
+
+        pool.parallel_for(0, 20, [&pool, &total](std::size_t) {
+            pool.parallel_for(0, 10, [&total](std::size_t) { ++total; });
+        });
+
+        BOOST_CHECK_EQUAL(total.load(), 200);
+    }
+
+    BOOST_AUTO_TEST_CASE( exceptions_reach_the_caller ) {
+        ThreadPool pool(2);
+
+        BOOST_CHECK_THROW(pool.parallel_for(0, 100, [](std::size_t i) {
+            if (i == 42) throw std::runtime_error("failed iteration");
+        }), std::runtime_error);
+
+        // The pool is still usable after a failed loop
+        std::atomic<int> total(0);
+        pool.parallel_for(0, 100, [&total](std::size_t) { ++total; });
+        BOOST_CHECK_EQUAL(total.load(), 100);
+    }
+
+    BOOST_AUTO_TEST_CASE( shared_pool_size ) {
+        BOOST_CHECK_EQUAL(ThreadPool::shared().size(), 1);
+        ThreadPool::setThreads(2);
+        BOOST_CHECK_EQUAL(ThreadPool::shared().size(), 2);
+        ThreadPool::setThreads(1);
+    }
+
+    BOOST_AUTO_TEST_CASE( scoped_pools_run_concurrent_loops ) {
+        BOOST_CHECK_EQUAL(&ThreadPool::current(), &ThreadPool::shared());
+
+        // Two threads with their own pools run their loops at the same time
+        std::atomic<int> inside(0);
+        std::atomic<int> overlapped(0);
+        std::atomic<int> scoped(0);
+        auto process = [&inside, &overlapped, &scoped]() {
+            ThreadPool pool(2);
+            ThreadPool::Scope scope(pool);
+            if (&ThreadPool::current() == &pool) ++scoped;
+            ThreadPool::current().parallel_for(0, 2, [&inside, &overlapped](std::size_t) {
+                ++inside;
+                for (int i = 0; i < 1000 && inside.load() < 4; ++i) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                if (inside.load() == 4) ++overlapped;
+            });
+        };
+        std::thread first(process);
+        std::thread second(process);
+        first.join();
+        second.join();
+
+        BOOST_CHECK_EQUAL(scoped.load(), 2);
+        BOOST_CHECK_EQUAL(overlapped.load(), 4);
+        BOOST_CHECK_EQUAL(&ThreadPool::current(), &ThreadPool::shared());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,26 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/TimeText.hpp>
+
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( libs_time_text )
+
+    BOOST_AUTO_TEST_CASE( fields_start_from_the_hours ) {
+        BOOST_CHECK_EQUAL(pmgbp::time_text::nanoseconds("2"), 7200000000000LL);
+        BOOST_CHECK_EQUAL(pmgbp::time_text::nanoseconds("0:1:30"), 90000000000LL);
+        BOOST_CHECK_EQUAL(pmgbp::time_text::nanoseconds("0:0:0:28:0:5"), 28000005LL);
+        BOOST_CHECK_CLOSE(pmgbp::time_text::seconds("0:0:0:1"), 0.001, 1e-9);
+    }
+
+    BOOST_AUTO_TEST_CASE( wrong_times_throw ) {
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds(""), std::invalid_argument);
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds("1::2"), std::invalid_argument);
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds("1:a"), std::invalid_argument);
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds("-1"), std::invalid_argument);
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds("1:2:3:4:5:6:7"), std::invalid_argument);
+        BOOST_CHECK_THROW(pmgbp::time_text::nanoseconds("1:2:3:4:5", 4), std::invalid_argument);
+        BOOST_CHECK_NO_THROW(pmgbp::time_text::nanoseconds("1:2:3:4", 4));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
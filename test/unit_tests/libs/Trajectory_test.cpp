@@ -0,0 +1,108 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <pmgbp/lib/Trajectory.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using pmgbp::trajectory::writer;
+using pmgbp::trajectory::reader;
+using pmgbp::trajectory::columns;
+
+namespace {
+    std::string temporary_path(const std::string& name) {
+        return std::string("/tmp/pmgbp_trajectory_test_") + name + ".bin";
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( libs_trajectory )
+
+    BOOST_AUTO_TEST_CASE( records_are_read_as_written ) {
+        std::string path = temporary_path("records");
+        {
+            writer out(path, 2);
+            uint32_t c = out.model("c");
+            uint32_t e = out.model("e");
+            uint32_t a = out.species("A_c");
+            uint32_t b = out.species("B_e");
+
+            BOOST_CHECK_EQUAL(out.model("c"), c);
+            BOOST_CHECK_EQUAL(out.species("B_e"), b);
+
+            out.append(0, c, a, 600000);
+            out.append(1000, e, b, 3);
+            out.append(2000, c, a, 599999);
+            BOOST_CHECK_EQUAL(out.records(), 3);
+        }
+
+        reader in(path);
+        columns block;
+        BOOST_CHECK(in.next(block));
+        BOOST_CHECK_EQUAL(block.size(), 2);
+        BOOST_CHECK(in.next(block));
+        BOOST_CHECK_EQUAL(block.size(), 1);
+        BOOST_CHECK_EQUAL(block.time[0], 2000);
+        BOOST_CHECK_EQUAL(block.amount[0], 599999);
+        BOOST_CHECK(!in.next(block));
+
+        BOOST_REQUIRE_EQUAL(in.models().size(), 2);
+        BOOST_CHECK_EQUAL(in.models()[1], "e");
+        BOOST_REQUIRE_EQUAL(in.species().size(), 2);
+        BOOST_CHECK_EQUAL(in.species()[0], "A_c");
+
+        std::remove(path.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE( read_all_joins_the_blocks ) {
+        std::string path = temporary_path("all");
+        {
+            writer out(path, 3);
+            for (int i = 0; i < 10; ++i) {
+                out.append(i, out.model("m" + std::to_string(i % 2)), out.species("s" + std::to_string(i % 3)), i * 10);
+            }
+        }
+
+        reader in(path);
+        columns all = in.read_all();
+        BOOST_REQUIRE_EQUAL(all.size(), 10);
+        for (int i = 0; i < 10; ++i) {
+            BOOST_CHECK_EQUAL(all.time[i], i);
+            BOOST_CHECK_EQUAL(in.models()[all.model[i]], "m" + std::to_string(i % 2));
+            BOOST_CHECK_EQUAL(in.species()[all.species[i]], "s" + std::to_string(i % 3));
+            BOOST_CHECK_EQUAL(all.amount[i], i * 10);
+        }
+
+        std::remove(path.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE( wrong_files_throw ) {
+        std::string path = temporary_path("wrong");
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << "not a trajectory";
+        }
+        BOOST_CHECK_THROW(reader{path}, std::runtime_error);
+
+        {
+            writer out(path);
+            out.append(5, out.model("c"), out.species("A_c"), 1);
+        }
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), bytes.size() - 4);
+        }
+
+        reader in(path);
+        columns block;
+        BOOST_CHECK_THROW(in.next(block), std::runtime_error);
+
+        std::remove(path.c_str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
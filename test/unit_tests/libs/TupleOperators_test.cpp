@@ -55,6 +55,23 @@ BOOST_AUTO_TEST_SUITE( get_operator )
         }
     }
 
+    BOOST_AUTO_TEST_CASE( get_and_cget_reach_the_same_bag ) {
+
+        typename make_message_bags<output_ports>::type bags;
+        const auto& const_bags = bags;
+
+        for (int j = 0; j < 4; j++) {
+            pmgbp::tuple::get<int>(bags, j).emplace_back(j);
+        }
+
+        for (int j = 0; j < 4; j++) {
+            BOOST_CHECK_EQUAL(&pmgbp::tuple::cget<int>(const_bags, j), &pmgbp::tuple::get<int>(bags, j));
+            BOOST_CHECK_EQUAL(pmgbp::tuple::cget<int>(const_bags, j).front(), j);
+        }
+        BOOST_CHECK_THROW(pmgbp::tuple::cget<int>(const_bags, -1), pmgbp::tuple::Exception);
+        BOOST_CHECK_THROW(pmgbp::tuple::get<int>(bags, -1), pmgbp::tuple::Exception);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE( empty_tuple_tests )